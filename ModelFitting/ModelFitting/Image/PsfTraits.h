@@ -31,12 +31,15 @@ namespace ModelFitting {
  * This way they do not have to be modified.
  *
  * PSF types that have this concept should specialize the trait with has_context = true
- * and the appropiate context_t
+ * and the appropiate context_t.
+ * If, on top, they can prepare a context for several images of the same size (prepare(image, batch))
+ * and convolve them at once (convolveBatch(images, context)), they should set has_batch = true
  */
 template <typename PsfType>
 struct PsfTraits {
   using context_t = std::false_type;
   static constexpr bool has_context = false;
+  static constexpr bool has_batch = false;
 };
 
 } // end namespace ModelFitting
@@ -25,6 +25,10 @@
 
 #include <vector>
 #include <cmath>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "ModelFitting/Models/ConstantModel.h"
 #include "ModelFitting/Models/PointModel.h"
 #include "ModelFitting/Models/ExtendedModel.h"
@@ -70,6 +74,16 @@ public:
   void convolve(size_t, ImageType& image) {
     PsfType::convolve(image);
   }
+
+  /**
+   * Convolve, one by one, the images of the models selected by indexes
+   */
+  template <typename ImageType>
+  void convolve(const std::vector<size_t>&, std::vector<ImageType>& images) {
+    for (auto& image : images) {
+      PsfType::convolve(image);
+    }
+  }
 };
 
 /**
@@ -109,16 +123,61 @@ public:
    */
   template <typename ImageType>
   void convolve(size_t i, ImageType& image) {
-    auto& context = m_psf_contexts[i];
-    if (!context) {
-      context = PsfType::prepare(image);
-      m_psf_contexts[i] = std::move(context);
+    auto& prepared = m_psf_contexts[i];
+    if (!prepared.done) {
+      prepared.context = PsfType::prepare(image);
+      prepared.done = true;
     }
-    PsfType::convolve(image, m_psf_contexts[i]);
+    PsfType::convolve(image, prepared.context);
+  }
+
+  /**
+   * Convolve the images of the models selected by indexes, which must have the same size. If the PSF type
+   * supports it (see PsfTraits), they are convolved at once, with a context kept for that size and number
+   * of images.
+   * @param indexes
+   *    The indexes of the models
+   * @param images
+   *    Their images, in the same order
+   */
+  template <typename ImageType>
+  void convolve(const std::vector<size_t>& indexes, std::vector<ImageType>& images) {
+    convolveBatch(indexes, images, std::integral_constant<bool, PsfTraits<PsfType>::has_batch>{});
   }
 
 private:
-  std::vector<typename PsfTraits<PsfType>::context_t> m_psf_contexts;
+  // prepare may leave the context empty (i.e. ImagePsf convolving directly), so whether it ran is kept aside
+  struct PreparedContext {
+    bool done = false;
+    typename PsfTraits<PsfType>::context_t context;
+  };
+
+  std::vector<PreparedContext> m_psf_contexts;
+  // Contexts for the batches, by width, height and number of images
+  std::map<std::tuple<std::size_t, std::size_t, std::size_t>, PreparedContext> m_batch_contexts;
+
+  template <typename ImageType>
+  void convolveBatch(const std::vector<size_t>& indexes, std::vector<ImageType>& images, std::false_type) {
+    for (size_t k = 0; k < indexes.size(); ++k) {
+      convolve(indexes[k], images[k]);
+    }
+  }
+
+  template <typename ImageType>
+  void convolveBatch(const std::vector<size_t>& indexes, std::vector<ImageType>& images, std::true_type) {
+    if (indexes.size() == 1) {
+      convolve(indexes.front(), images.front());
+      return;
+    }
+    auto key = std::make_tuple(ImageTraits<ImageType>::width(images.front()),
+                               ImageTraits<ImageType>::height(images.front()), images.size());
+    auto& prepared = m_batch_contexts[key];
+    if (!prepared.done) {
+      prepared.context = PsfType::prepare(images.front(), images.size());
+      prepared.done = true;
+    }
+    PsfType::convolveBatch(images, prepared.context);
+  }
 };
 
 
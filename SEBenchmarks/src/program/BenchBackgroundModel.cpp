@@ -32,6 +32,7 @@
 #include <Configuration/Utils.h>
 #include <AlexandriaKernel/memory_tools.h>
 #include <AlexandriaKernel/StringUtils.h>
+#include <AlexandriaKernel/ThreadPool.h>
 
 #include "SEFramework/Image/TileManager.h"
 #include "SEFramework/Image/ConstantImage.h"
@@ -62,6 +63,7 @@ private:
 
   std::string m_output_bg, m_output_var;
   std::vector<int> m_cell_size, m_smooth;
+  std::shared_ptr<ThreadPool> m_thread_pool;
 
   enum class Algorithm {
     SIMPLE, SE2, NG
@@ -93,14 +95,16 @@ private:
   }
 
   std::unique_ptr<BackgroundAnalyzer>
-  getBackgroundAnalyzer() {
-    switch (m_algorithm) {
+  getBackgroundAnalyzer(Algorithm algorithm) {
+    switch (algorithm) {
       case Algorithm::SIMPLE:
         return Euclid::make_unique<SimpleBackgroundAnalyzer>();
       case Algorithm::SE2:
-        return Euclid::make_unique<SE2BackgroundLevelAnalyzer>(m_cell_size, m_smooth, m_weight_config.getWeightType());
+        return Euclid::make_unique<SE2BackgroundLevelAnalyzer>(m_cell_size, m_smooth, m_weight_config.getWeightType(),
+                                                               m_thread_pool);
       case Algorithm::NG:
-        return Euclid::make_unique<SEBackgroundLevelAnalyzer>(m_cell_size, m_smooth, m_weight_config.getWeightType());
+        return Euclid::make_unique<SEBackgroundLevelAnalyzer>(m_cell_size, m_smooth, m_weight_config.getWeightType(),
+                                                              m_thread_pool);
     }
     return nullptr;
   }
@@ -126,6 +130,8 @@ public:
       ("cell-size", po::value<std::string>()->default_value("64"), "Cell size for the histogram")
       ("smooth-size", po::value<std::string>()->default_value("3"), "Box size for the median filtering")
       ("no-write", po::bool_switch(), "Do not write the image (skip interpolation)")
+      ("thread-count", po::value<int>()->default_value(0), "Number of threads for the background cells (0 = serial)")
+      ("compare", po::bool_switch(), "Also run the SE (ng) algorithm, and report the speedup against it")
       ("tile-size", po::value<int>()->default_value(512), "Tile size")
       ("tile-memory", po::value<int>()->default_value(2048), "Tile memory limit");
 
@@ -155,6 +161,11 @@ public:
     auto tile_size = args.at("tile-size").as<int>();
     auto tile_memory = args.at("tile-memory").as<int>();
     TileManager::getInstance()->setOptions(tile_size, tile_size, tile_memory);
+
+    auto thread_count = args.at("thread-count").as<int>();
+    if (thread_count > 0) {
+      m_thread_pool = std::make_shared<ThreadPool>(thread_count);
+    }
   }
 
   Elements::ExitCode mainMethod(std::map<std::string, po::variable_value>& args) override {
@@ -164,7 +175,7 @@ public:
     logger.info() << "Destination background image: " << m_output_bg;
     logger.info() << "Destination variance image: " << m_output_var;
 
-    auto bg_analyzer = getBackgroundAnalyzer();
+    auto bg_analyzer = getBackgroundAnalyzer(m_algorithm);
     assert (bg_analyzer != nullptr);
 
     auto image = m_detection_config.getDetectionImage();
@@ -181,6 +192,7 @@ public:
 
     timer::cpu_timer timer;
     auto bg_model = bg_analyzer->analyzeBackground(image, weight_image, mask, threshold);
+    auto analysis_wall = timer.elapsed().wall;
 
     if (!args.at("no-write").as<bool>()) {
       logger.info() << "Writing background";
@@ -194,6 +206,17 @@ public:
     std::cout << "Scaling factor: " << bg_model.getScalingFactor() << std::endl;
     std::cout << "Elapsed: " << timer.elapsed().wall << std::endl;
 
+    if (args.at("compare").as<bool>() && m_algorithm != Algorithm::NG) {
+      logger.info() << "Starting analysis with the SE algorithm";
+      auto se_analyzer = getBackgroundAnalyzer(Algorithm::NG);
+      timer::cpu_timer se_timer;
+      se_analyzer->analyzeBackground(image, weight_image, mask, threshold);
+      auto se_wall = se_timer.elapsed().wall;
+      std::cout << "Analysis: " << analysis_wall << std::endl;
+      std::cout << "SE analysis: " << se_wall << std::endl;
+      std::cout << "Speedup against SE: " << static_cast<double>(se_wall) / analysis_wall << std::endl;
+    }
+
     TileManager::getInstance()->saveAllTiles();
 
     return Elements::ExitCode::OK;
@@ -66,7 +66,9 @@ public:
       ("image-nsteps", po::value<int>()->default_value(1), "Number of steps for the image")
       ("kernel-nsteps", po::value<int>()->default_value(2), "Number of steps for the kernel")
       ("repeat", po::value<int>()->default_value(5), "Repeat")
-      ("measures", po::value<int>()->default_value(10), "Number of measures");
+      ("measures", po::value<int>()->default_value(10), "Number of measures")
+      ("direct-max-kernel", po::value<int>()->default_value(32), "Largest kernel timed with the direct implementation")
+      ("separable", po::bool_switch(), "Use separable kernels (outer product of two random vectors)");
     return options;
   }
 
@@ -80,6 +82,21 @@ public:
     return img;
   }
 
+  std::shared_ptr<VectorImage<SeFloat>> generateSeparableKernel(int size) {
+    std::vector<SeFloat> row(size), column(size);
+    for (int i = 0; i < size; ++i) {
+      row[i] = random_dist(random_generator);
+      column[i] = random_dist(random_generator);
+    }
+    auto img = VectorImage<SeFloat>::create(size, size);
+    for (int x = 0; x < size; ++x) {
+      for (int y = 0; y < size; ++y) {
+        img->setValue(x, y, row[x] * column[y]);
+      }
+    }
+    return img;
+  }
+
   Elements::ExitCode mainMethod(std::map<std::string, po::variable_value> &args) override {
 
     auto img_start = args["image-start"].as<int>();
@@ -89,6 +106,8 @@ public:
     auto krn_nsteps = args["kernel-nsteps"].as<int>();
     auto repeat = args["repeat"].as<int>();
     auto measures = args["measures"].as<int>();
+    auto direct_max_kernel = args["direct-max-kernel"].as<int>();
+    auto separable = args["separable"].as<bool>();
 
     std::cout << "Image,Kernel,Implementation,Time" << std::endl;
 
@@ -102,30 +121,32 @@ public:
         logger.info() << "Using an image of " << img_size << "x" << img_size;
         logger.info() << "Using a kernel of " << krn_size << "x" << krn_size;
 
-        auto kernel = generateImage(krn_size);
+        auto kernel = separable ? generateSeparableKernel(krn_size) : generateImage(krn_size);
 
 #ifdef WITH_OPENCV
         logger.info() << "Timing OpenCV implementation";
         auto opencv_result = benchmark<OpenCVConvolution>(image, kernel, repeat, measures);
 #endif
 
-        if (krn_size <= 10 || img_size <= 20) {
+        logger.info() << "Timing DFT implementation";
+        auto dft_result = benchmark<DFTConvolution<SeFloat>>(image, kernel, repeat, measures);
+
+#ifdef WITH_OPENCV
+        logger.info() << "Compare OpenCV vs DFT Result";
+        verifyResults(opencv_result, dft_result);
+#endif
+
+        if (krn_size <= direct_max_kernel || img_size <= 20) {
           logger.info() << "Timing Direct implementation";
           auto direct_result = benchmark<DirectConvolution<SeFloat>>(image, kernel, repeat, measures);
 
+          logger.info() << "Compare DFT vs Direct Result";
+          verifyResults(dft_result, direct_result);
 #ifdef WITH_OPENCV
           logger.info() << "Compare OpenCV vs Direct Result";
           verifyResults(opencv_result, direct_result);
 #endif
         }
-
-        logger.info() << "Timing DFT implementation";
-        auto dft_result = benchmark<DFTConvolution<SeFloat>>(image, kernel, repeat, measures);
-
-#ifdef WITH_OPENCV
-        logger.info() << "Compare OpenCV vs DFT Result";
-        verifyResults(opencv_result, dft_result);
-#endif
       }
     }
 
@@ -0,0 +1,104 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * ConvolutionProfile.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_CONVOLUTION_CONVOLUTIONPROFILE_H
+#define _SEFRAMEWORK_CONVOLUTION_CONVOLUTIONPROFILE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SourceXtractor {
+
+/**
+ * @class ConvolutionProfile
+ * Chooses between the direct and the DFT convolutions from the size of the image and of the kernel.
+ *
+ * Calibrated, it keeps the time taken by each implementation over a grid of sizes measured on this machine,
+ * and picks the fastest one at the nearest point of the grid. Otherwise, it falls back to the fixed rule
+ * (direct for kernels up to 5 pixels).
+ *
+ * The calibration times DirectConvolution and DFTConvolution the way ImagePsf runs them. Convolutions done
+ * otherwise, like the masked and batched detection filter, must not rely on it: they use selectFixed.
+ */
+class ConvolutionProfile {
+public:
+
+  enum class Engine {
+    DIRECT,
+    DFT
+  };
+
+  /// Uncalibrated profile
+  ConvolutionProfile();
+
+  /// Profile used by the convolutions
+  static std::shared_ptr<const ConvolutionProfile> getInstance();
+
+  static void setInstance(std::shared_ptr<const ConvolutionProfile> profile);
+
+  /**
+   * Times both implementations for each pair of sizes
+   * @param image_sizes
+   *    Sizes of the (square) images
+   * @param kernel_sizes
+   *    Sizes of the (square) kernels. Only those smaller than the image are timed
+   */
+  static std::shared_ptr<ConvolutionProfile> calibrate(
+    const std::vector<int>& image_sizes = {16, 32, 64, 128, 256},
+    const std::vector<int>& kernel_sizes = {3, 5, 7, 9, 13, 17, 25, 33});
+
+  /**
+   * Loads a profile saved before
+   * @return
+   *    nullptr if the file can not be read, or if it was calibrated on a different CPU
+   */
+  static std::shared_ptr<ConvolutionProfile> load(const std::string& path);
+
+  /// Saves the profile. Returns false on failure
+  bool save(const std::string& path) const;
+
+  bool isCalibrated() const {
+    return !m_measures.empty();
+  }
+
+  Engine select(int image_width, int image_height, int kernel_width, int kernel_height) const;
+
+  /// The rule used without calibration, from the kernel size only
+  static Engine selectFixed(int kernel_width, int kernel_height);
+
+  /// Identifies the CPU the profile is valid for
+  static std::string getCpuIdentifier();
+
+private:
+  struct Measure {
+    int image_size, kernel_size;
+    double direct_time, dft_time;
+  };
+
+  std::string m_cpu;
+  std::vector<Measure> m_measures;
+};
+
+} // end SourceXtractor
+
+#endif // _SEFRAMEWORK_CONVOLUTION_CONVOLUTIONPROFILE_H
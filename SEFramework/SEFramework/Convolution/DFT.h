@@ -55,9 +55,20 @@ public:
    * with the same kernel (i.e. ModelFitting)
    */
   struct ConvolutionContext {
+    // The work area goes back to the pool of the thread, for the next context of the same size
+    ~ConvolutionContext() {
+      if (m_work_area) {
+        FFT<T>::releaseWorkArea(std::move(m_work_area));
+      }
+    }
+
   private:
     int m_padded_width, m_padded_height, m_transform_padding;
-    std::vector<real_t> m_kernel_transform, m_work_area;
+    // Number of images transformed at once
+    int m_batch;
+    // Shared between all the contexts prepared alike, it is not modified once computed
+    std::shared_ptr<const typename FFT<T>::work_area_t> m_kernel_transform;
+    std::unique_ptr<typename FFT<T>::work_area_t> m_work_area;
     typename FFT<T>::plan_ptr_t m_fwd_plan, m_inv_plan;
 
     friend class DFTConvolution<T, TPadding>;
@@ -102,11 +113,20 @@ public:
    *    A context than can be used by `convolve` to avoid re-computing the kernel multiple times
    */
   std::unique_ptr<ConvolutionContext> prepare(const std::shared_ptr<const Image<T>>& model_ptr) const {
+    return prepare(model_ptr->getWidth(), model_ptr->getHeight());
+  }
+
+  /**
+   * Pre-computes the transform of the kernel, adapted to images of the given size
+   * @param batch
+   *    Number of images of that size convolved at once by the context. See convolveBatch
+   */
+  std::unique_ptr<ConvolutionContext> prepare(int width, int height, int batch = 1) const {
     auto context = Euclid::make_unique<ConvolutionContext>();
 
     // Dimension of the working padded images
-    context->m_padded_width = model_ptr->getWidth() + m_kernel->getWidth() - 1;
-    context->m_padded_height = model_ptr->getHeight() + m_kernel->getHeight() - 1;
+    context->m_padded_width = width + m_kernel->getWidth() - 1;
+    context->m_padded_height = height + m_kernel->getHeight() - 1;
 
     // For performance, use a size that is convenient for FFTW
     context->m_padded_width = fftRoundDimension(context->m_padded_width);
@@ -116,24 +136,46 @@ public:
     // (See FFTW documentation)
     context->m_transform_padding = 2 * (context->m_padded_width / 2 + 1) - context->m_padded_width;
     int work_area_size = context->m_padded_height * (context->m_padded_width / 2 + 1) * 2;
+    context->m_batch = batch;
 
-    // Pre-allocate buffers for the transformations
-    context->m_kernel_transform.resize(work_area_size);
-    context->m_work_area.resize(work_area_size);
+    // Pre-allocate buffers for the transformations. The work area may be one left by a previous context
+    auto kernel_transform = std::make_shared<typename FFT<T>::work_area_t>(work_area_size);
+    context->m_work_area = FFT<T>::acquireWorkArea(work_area_size * batch);
 
     // Since we already have the buffers, get the plans too
-    context->m_fwd_plan = FFT<T>::createForwardPlan(context->m_padded_width, context->m_padded_height,
-                                                    context->m_work_area);
-    context->m_inv_plan = FFT<T>::createInversePlan(context->m_padded_width, context->m_padded_height,
-                                                    context->m_work_area);
+    context->m_fwd_plan = FFT<T>::createForwardPlan(context->m_padded_width, context->m_padded_height, batch,
+                                                    *context->m_work_area);
+    context->m_inv_plan = FFT<T>::createInversePlan(context->m_padded_width, context->m_padded_height, batch,
+                                                    *context->m_work_area);
 
     // Transform here the kernel into frequency space
-    padKernel(*context);
-    FFT<T>::executeForward(context->m_fwd_plan, context->m_kernel_transform);
+    // The kernel is a single image, so a batch needs its own plan for it
+    auto kernel_plan = FFT<T>::createForwardPlan(context->m_padded_width, context->m_padded_height,
+                                                 *kernel_transform);
+    padKernel(*context, *kernel_transform);
+    FFT<T>::executeForward(kernel_plan, *kernel_transform);
+    context->m_kernel_transform = std::move(kernel_transform);
 
     return context;
   }
 
+  /**
+   * Creates a context for the same size and batch than the given one, with its own work area, but sharing
+   * the transform of the kernel, so it is not computed again. Both contexts can then be used concurrently.
+   */
+  std::unique_ptr<ConvolutionContext> prepareLike(const ConvolutionContext& other) const {
+    auto context = Euclid::make_unique<ConvolutionContext>();
+    context->m_padded_width = other.m_padded_width;
+    context->m_padded_height = other.m_padded_height;
+    context->m_transform_padding = other.m_transform_padding;
+    context->m_batch = other.m_batch;
+    context->m_kernel_transform = other.m_kernel_transform;
+    context->m_work_area = FFT<T>::acquireWorkArea(other.m_work_area->size());
+    context->m_fwd_plan = other.m_fwd_plan;
+    context->m_inv_plan = other.m_inv_plan;
+    return context;
+  }
+
   /**
    * Convolve the image with the stored kernel, using the given context storing the pre-computed
    * kernel transform, and pre-allocated buffers
@@ -150,45 +192,75 @@ public:
   void convolve(std::shared_ptr<WriteableImage<T>> image_ptr,
                 std::unique_ptr<ConvolutionContext>& context,
                 Args... padding_args) const {
-    assert(image_ptr->getWidth() <= context->m_padded_width);
-    assert(image_ptr->getHeight() <= context->m_padded_height);
-
-    // Padded image
-    auto padded = TPadding::create(image_ptr,
-                                   context->m_padded_width, context->m_padded_height,
-                                   std::forward<Args>(padding_args)...);
-
-    // Create a matrix with the padded image
-    dumpImage(padded, context->m_work_area);
-
-    // Transform the image
-    FFT<T>::executeForward(context->m_fwd_plan, context->m_work_area);
-
-    // Multiply the two DFT
-    complex_t* kernel_complex = reinterpret_cast<complex_t*>(context->m_kernel_transform.data());
-    complex_t* img_complex    = reinterpret_cast<complex_t*>(context->m_work_area.data());
-    size_t     ncomplex       = (context->m_padded_width / 2 + 1) * context->m_padded_height;
-    for (size_t i = 0; i < ncomplex; ++i) {
-      const auto& a  = img_complex[i];
-      const auto& b  = kernel_complex[i];
-      float       re = a[0] * b[0] - a[1] * b[1];
-      float       im = a[0] * b[1] + a[1] * b[0];
-
-      img_complex[i][0] = re;
-      img_complex[i][1] = im;
+    assert(context->m_batch == 1);
+    convolveBatch({image_ptr}, context, std::forward<Args>(padding_args)...);
+  }
+
+  /**
+   * Convolve, with the stored kernel, as many images as the batch of the context at once
+   * (i.e. an image and its mask). Compared to convolving them one by one, the transforms of the batch
+   * are done by a single FFTW plan, and the buffers are visited once.
+   * @param images
+   *    The images to convolve, all of the same size
+   * @param context
+   *    The prepared context
+   * @param padding_args
+   *    Forwarded to the padding strategy
+   */
+  template <typename ...Args>
+  void convolveBatch(const std::vector<std::shared_ptr<WriteableImage<T>>>& images,
+                     std::unique_ptr<ConvolutionContext>& context,
+                     Args... padding_args) const {
+    assert(static_cast<int>(images.size()) == context->m_batch);
+    auto& work_area = *context->m_work_area;
+    size_t work_area_size = work_area.size() / context->m_batch;
+
+    for (size_t i = 0; i < images.size(); ++i) {
+      assert(images[i]->getWidth() <= context->m_padded_width);
+      assert(images[i]->getHeight() <= context->m_padded_height);
+
+      // Padded image
+      auto padded = TPadding::create(images[i],
+                                     context->m_padded_width, context->m_padded_height,
+                                     padding_args...);
+
+      // Create a matrix with the padded image
+      dumpImage(padded, work_area.data() + i * work_area_size);
+    }
+
+    // Transform the images
+    FFT<T>::executeForward(context->m_fwd_plan, work_area);
+
+    // Multiply the DFT of each image by the DFT of the kernel
+    const complex_t* kernel_complex = reinterpret_cast<const complex_t*>(context->m_kernel_transform->data());
+    size_t ncomplex = (context->m_padded_width / 2 + 1) * context->m_padded_height;
+    for (size_t j = 0; j < images.size(); ++j) {
+      complex_t* img_complex = reinterpret_cast<complex_t*>(work_area.data() + j * work_area_size);
+      for (size_t i = 0; i < ncomplex; ++i) {
+        const auto& a  = img_complex[i];
+        const auto& b  = kernel_complex[i];
+        float       re = a[0] * b[0] - a[1] * b[1];
+        float       im = a[0] * b[1] + a[1] * b[0];
+
+        img_complex[i][0] = re;
+        img_complex[i][1] = im;
+      }
     }
 
     // Inverse DFT
-    FFT<T>::executeInverse(context->m_inv_plan, context->m_work_area);
+    FFT<T>::executeInverse(context->m_inv_plan, work_area);
 
     // Copy to the output, removing the pad
-    auto wpad = ::div(context->m_padded_width - image_ptr->getWidth(), 2);
-    auto lpad = wpad.quot;
-    auto rpad = wpad.quot + wpad.rem;
-    auto hpad = ::div(context->m_padded_height - image_ptr->getHeight(), 2);
-    auto tpad = hpad.quot;
-    auto bpad = hpad.quot + hpad.rem;
-    copyFFTWorkAreaToImage(context->m_work_area, *image_ptr, rpad, lpad, tpad, bpad, true);
+    for (size_t i = 0; i < images.size(); ++i) {
+      auto wpad = ::div(context->m_padded_width - images[i]->getWidth(), 2);
+      auto lpad = wpad.quot;
+      auto rpad = wpad.quot + wpad.rem;
+      auto hpad = ::div(context->m_padded_height - images[i]->getHeight(), 2);
+      auto tpad = hpad.quot;
+      auto bpad = hpad.quot + hpad.rem;
+      copyFFTWorkAreaToImage(work_area.data() + i * work_area_size, *images[i],
+                             rpad, lpad, tpad, bpad, true);
+    }
   }
 
   /**
@@ -218,17 +290,17 @@ public:
   }
 
 protected:
-  void padKernel(ConvolutionContext& context) const {
+  void padKernel(const ConvolutionContext& context, typename FFT<T>::work_area_t& kernel_transform) const {
     auto padded = PaddedImage<T>::create(m_kernel, context.m_padded_width, context.m_padded_height);
     auto center = PixelCoordinate{context.m_padded_width / 2, context.m_padded_height / 2};
     if (context.m_padded_width % 2 == 0) center.m_x--;
     if (context.m_padded_height % 2 == 0) center.m_y--;
     auto recenter = RecenterImage<T>::create(padded, center);
 
-    dumpImage(recenter, context.m_kernel_transform);
+    dumpImage(recenter, kernel_transform.data());
   }
 
-  void dumpImage(const std::shared_ptr<const Image<T>> &img, std::vector<T>& work_area) const {
+  void dumpImage(const std::shared_ptr<const Image<T>> &img, T* work_area) const {
     const auto chunk = img->getChunk(0, 0, img->getWidth(), img->getHeight());
     copyImageToFFTWorkArea(*chunk, work_area);
   }
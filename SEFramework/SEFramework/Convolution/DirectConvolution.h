@@ -23,43 +23,80 @@
 #ifndef _SEFRAMEWORK_CONVOLUTION_DIRECTCONVOLUTION_H
 #define _SEFRAMEWORK_CONVOLUTION_DIRECTCONVOLUTION_H
 
+#include "SEFramework/Convolution/SeparableKernel.h"
 #include "SEFramework/Image/MirrorImage.h"
 #include "SEFramework/Image/PaddedImage.h"
 #include "SEFramework/Image/VectorImage.h"
 
 namespace SourceXtractor {
 
+/**
+ * Correlates a kernel with a buffer, for the out_width x out_height pixels whose window starts at the same
+ * position in the input. The instruction set (AVX-512, AVX2 or the baseline) is chosen at run time
+ * where the compiler allows it.
+ */
+void directCorrelate(const float* kernel, int kernel_width, int kernel_height,
+                     const float* in, int in_stride, float* out, int out_stride, int out_width, int out_height);
+
+void directCorrelate(const double* kernel, int kernel_width, int kernel_height,
+                     const double* in, int in_stride, double* out, int out_stride, int out_width, int out_height);
+
 template <typename T = SeFloat, class TPadding = PaddedImage<T, Reflect101Coordinates>>
 class DirectConvolution {
 public:
-  DirectConvolution(std::shared_ptr<const Image<T>> img)
-    : m_kernel{VectorImage<T>::create(*MirrorImage<T>::create(img))} {
+  /**
+   * @param separable_tolerance
+   *    If the kernel can be reconstructed by SVD from one or two outer products within this relative error,
+   *    it is applied as 1D passes. The default only accepts kernels separable up to rounding. 0 disables it.
+   */
+  DirectConvolution(std::shared_ptr<const Image<T>> img, double separable_tolerance = 1e-6)
+    : m_kernel{VectorImage<T>::create(*MirrorImage<T>::create(img))},
+      m_separable{SeparableKernel<T>::decompose(*m_kernel, separable_tolerance)} {
   }
 
   virtual ~DirectConvolution() = default;
 
+  /**
+   * Convolves the image in place. The pixels whose kernel fits inside the image are computed straight from
+   * a copy of the image, only the bands along the borders are read through the padding strategy.
+   * A separable kernel is applied as 1D passes to the former, while the narrow bands use the full kernel.
+   */
   template <typename ...Args>
   void convolve(std::shared_ptr<WriteableImage<T>> image, Args... padding_args) const {
-    auto padded_width = image->getWidth() + m_kernel->getWidth() - 1;
-    auto padded_height = image->getHeight() + m_kernel->getHeight() - 1;
-    auto lpad = m_kernel->getWidth() / 2;
-    auto tpad = m_kernel->getHeight() / 2;
-
-    auto padded = VectorImage<T>::create(
-      TPadding::create(image, padded_width, padded_height, std::forward<Args>(padding_args)...)
-    );
-
-    for (int iy = tpad; iy < padded->getHeight() - tpad; ++iy) {
-      for (int ix = lpad; ix < padded->getWidth() - lpad; ++ix) {
-        T acc = 0;
-        for (int ky = 0; ky < m_kernel->getHeight(); ++ky) {
-          for (int kx = 0; kx < m_kernel->getWidth(); ++kx) {
-            acc += m_kernel->getValue(kx, ky) * padded->getValue(ix - lpad + kx, iy - tpad + ky);
-          }
-        }
-        image->setValue(ix - lpad, iy - tpad, acc);
+    int width = image->getWidth(), height = image->getHeight();
+    int kernel_width = m_kernel->getWidth(), kernel_height = m_kernel->getHeight();
+    auto padded_width = width + kernel_width - 1;
+    auto padded_height = height + kernel_height - 1;
+
+    // The image is overwritten, so keep the input
+    auto source = VectorImage<T>::create(*image);
+    auto padded = TPadding::create(source, padded_width, padded_height, std::forward<Args>(padding_args)...);
+
+    // Same split of the padding than PaddedImage
+    int lpad = (kernel_width - 1) / 2, rpad = kernel_width - 1 - lpad;
+    int tpad = (kernel_height - 1) / 2, bpad = kernel_height - 1 - tpad;
+    int inner_width = width - lpad - rpad, inner_height = height - tpad - bpad;
+
+    std::vector<T> result(width * height);
+    if (inner_width <= 0 || inner_height <= 0) {
+      correlatePadded(*padded, 0, 0, result.data(), width, width, height);
+    }
+    else {
+      auto inner = result.data() + lpad + tpad * width;
+      if (m_separable) {
+        m_separable->correlate(source->getData().data(), width, inner, width, inner_width, inner_height);
+      }
+      else {
+        directCorrelate(m_kernel->getData().data(), kernel_width, kernel_height,
+                        source->getData().data(), width, inner, width, inner_width, inner_height);
       }
+      correlatePadded(*padded, 0, 0, result.data(), width, width, tpad);
+      correlatePadded(*padded, 0, height - bpad, result.data() + (height - bpad) * width, width, width, bpad);
+      correlatePadded(*padded, 0, tpad, result.data() + tpad * width, width, lpad, inner_height);
+      correlatePadded(*padded, width - rpad, tpad, result.data() + tpad * width + width - rpad, width,
+                      rpad, inner_height);
     }
+    copyResult(result, *image);
   }
 
   std::size_t getWidth() const {
@@ -75,7 +112,32 @@ public:
   }
 
 private:
+  /// Correlates a band of output pixels, whose kernel starts at (x, y) in the padded image
+  void correlatePadded(const Image<T>& padded, int x, int y, T* out, int out_stride, int out_width,
+                       int out_height) const {
+    if (out_width <= 0 || out_height <= 0) {
+      return;
+    }
+    auto chunk = padded.getChunk(x, y, out_width + m_kernel->getWidth() - 1, out_height + m_kernel->getHeight() - 1);
+    directCorrelate(m_kernel->getData().data(), m_kernel->getWidth(), m_kernel->getHeight(),
+                    chunk->getRowSpan(0), chunk->getStride(), out, out_stride, out_width, out_height);
+  }
+
+  static void copyResult(const std::vector<T>& result, WriteableImage<T>& image) {
+    auto vector_image = dynamic_cast<VectorImage<T>*>(&image);
+    if (vector_image) {
+      std::copy(result.begin(), result.end(), vector_image->getData().begin());
+      return;
+    }
+    for (int iy = 0; iy < image.getHeight(); ++iy) {
+      for (int ix = 0; ix < image.getWidth(); ++ix) {
+        image.setValue(ix, iy, result[ix + iy * image.getWidth()]);
+      }
+    }
+  }
+
   std::shared_ptr<const VectorImage<T>> m_kernel;
+  std::shared_ptr<const SeparableKernel<T>> m_separable;
 };
 
 } // end SourceXtractor
@@ -0,0 +1,238 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * SeparableKernel.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_CONVOLUTION_SEPARABLEKERNEL_H
+#define _SEFRAMEWORK_CONVOLUTION_SEPARABLEKERNEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "SEFramework/Image/VectorImage.h"
+
+namespace SourceXtractor {
+
+/**
+ * @class SeparableKernel
+ * A kernel written as a sum of a few outer products of a column and a row (its largest singular values),
+ * so it can be applied as 1D passes: rank * (width + height) products per pixel, instead of width * height.
+ */
+template <typename T = SeFloat>
+class SeparableKernel {
+public:
+
+  /**
+   * Decomposes the kernel by SVD
+   * @param kernel
+   *    Kernel to decompose
+   * @param tolerance
+   *    Maximum error of the reconstructed kernel, relative to the kernel (Frobenius norm)
+   * @param max_rank
+   *    Maximum number of terms
+   * @return
+   *    nullptr if the kernel can not be reconstructed within the tolerance, or if the 1D passes
+   *    would need as many products as the full 2D kernel
+   */
+  static std::shared_ptr<SeparableKernel<T>> decompose(const VectorImage<T>& kernel, double tolerance,
+                                                      int max_rank = 2) {
+    int width = kernel.getWidth(), height = kernel.getHeight();
+
+    std::vector<double> residual(width * height);
+    double norm = 0;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        residual[x + y * width] = kernel.getValue(x, y);
+        norm += residual[x + y * width] * residual[x + y * width];
+      }
+    }
+    norm = std::sqrt(norm);
+    if (norm == 0 || tolerance <= 0) {
+      return nullptr;
+    }
+
+    auto separable = std::make_shared<SeparableKernel<T>>(width, height);
+    double error = 1.;
+    for (int rank = 0; rank < max_rank && error > tolerance; ++rank) {
+      // Power iteration for the largest singular value of the residual
+      std::vector<double> u(height), v(width);
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          v[x] += std::abs(residual[x + y * width]);
+        }
+      }
+      double sigma = 0;
+      for (int i = 0; i < 200; ++i) {
+        double prev_sigma = sigma;
+        multiply(residual, v, u, false);
+        multiply(residual, u, v, true);
+        sigma = normalize(v);
+        if (sigma == 0 || std::abs(sigma - prev_sigma) <= 1e-12 * sigma) {
+          break;
+        }
+      }
+      multiply(residual, v, u, false);
+      sigma = normalize(u);
+      if (sigma == 0) {
+        break;
+      }
+
+      std::vector<T> column(height), row(width);
+      for (int y = 0; y < height; ++y) {
+        column[y] = u[y] * sigma;
+      }
+      for (int x = 0; x < width; ++x) {
+        row[x] = v[x];
+      }
+
+      // Remove the term as it will be applied, so the error accounts for the rounding to T
+      error = 0;
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          residual[x + y * width] -= static_cast<double>(column[y]) * row[x];
+          error += residual[x + y * width] * residual[x + y * width];
+        }
+      }
+      error = std::sqrt(error) / norm;
+
+      separable->m_columns.emplace_back(std::move(column));
+      separable->m_rows.emplace_back(std::move(row));
+    }
+
+    separable->m_error = error;
+    if (error > tolerance || separable->getRank() * (width + height) >= width * height) {
+      return nullptr;
+    }
+    return separable;
+  }
+
+  SeparableKernel(int width, int height) : m_width(width), m_height(height), m_error(0) {
+  }
+
+  int getWidth() const {
+    return m_width;
+  }
+
+  int getHeight() const {
+    return m_height;
+  }
+
+  int getRank() const {
+    return m_rows.size();
+  }
+
+  /// Relative error of the reconstructed kernel
+  double getError() const {
+    return m_error;
+  }
+
+  /**
+   * Correlates the kernel with a row-major buffer, keeping only the pixels where the kernel fits entirely
+   * (as DirectConvolution does with its mirrored kernel over the padded image)
+   * @param in
+   *    Input buffer of in_width x in_height pixels
+   * @param out
+   *    Output buffer of (in_width - width + 1) x (in_height - height + 1) pixels
+   */
+  void correlate(const T* in, int in_width, int in_height, T* out) const {
+    int out_width = in_width - m_width + 1;
+    correlate(in, in_width, out, out_width, out_width, in_height - m_height + 1);
+  }
+
+  /**
+   * Correlates the kernel with a strided buffer, for the out_width x out_height pixels whose window
+   * starts at the same position in the input
+   */
+  void correlate(const T* in, int in_stride, T* out, int out_stride, int out_width, int out_height) const {
+    int in_height = out_height + m_height - 1;
+    for (int y = 0; y < out_height; ++y) {
+      std::fill(out + y * out_stride, out + y * out_stride + out_width, 0);
+    }
+
+    std::vector<T> horizontal(out_width * in_height);
+    for (int r = 0; r < getRank(); ++r) {
+      const auto& row = m_rows[r];
+      const auto& column = m_columns[r];
+
+      for (int y = 0; y < in_height; ++y) {
+        const T* in_row = in + y * in_stride;
+        T* h_row = horizontal.data() + y * out_width;
+        for (int x = 0; x < out_width; ++x) {
+          T acc = 0;
+          for (int k = 0; k < m_width; ++k) {
+            acc += row[k] * in_row[x + k];
+          }
+          h_row[x] = acc;
+        }
+      }
+
+      for (int y = 0; y < out_height; ++y) {
+        T* out_row = out + y * out_stride;
+        for (int k = 0; k < m_height; ++k) {
+          const T* h_row = horizontal.data() + (y + k) * out_width;
+          for (int x = 0; x < out_width; ++x) {
+            out_row[x] += column[k] * h_row[x];
+          }
+        }
+      }
+    }
+  }
+
+private:
+  int m_width, m_height;
+  double m_error;
+  std::vector<std::vector<T>> m_columns, m_rows;
+
+  /// out = m * in, or m^T * in when transposed
+  static void multiply(const std::vector<double>& m, const std::vector<double>& in, std::vector<double>& out,
+                       bool transposed) {
+    int width = transposed ? out.size() : in.size();
+    std::fill(out.begin(), out.end(), 0.);
+    for (size_t i = 0; i < m.size(); ++i) {
+      int x = i % width, y = i / width;
+      if (transposed) {
+        out[x] += m[i] * in[y];
+      }
+      else {
+        out[y] += m[i] * in[x];
+      }
+    }
+  }
+
+  static double normalize(std::vector<double>& v) {
+    double norm = 0;
+    for (auto e : v) {
+      norm += e * e;
+    }
+    norm = std::sqrt(norm);
+    if (norm > 0) {
+      for (auto& e : v) {
+        e /= norm;
+      }
+    }
+    return norm;
+  }
+};
+
+} // end SourceXtractor
+
+#endif // _SEFRAMEWORK_CONVOLUTION_SEPARABLEKERNEL_H
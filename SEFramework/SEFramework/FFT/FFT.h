@@ -24,8 +24,11 @@
 #define _SEFRAMEWORK_FFT_FFT_H
 
 #include <complex>
+#include <cstddef>
 #include <fftw3.h>
 #include <memory>
+#include <new>
+#include <string>
 #include <vector>
 
 namespace SourceXtractor {
@@ -45,12 +48,16 @@ struct FFTTraits<float> {
   typedef fftwf_complex                   complex_t;
   typedef decltype(fftwf_plan_dft_r2c_2d) func_plan_fwd_t;
   typedef decltype(fftwf_plan_dft_c2r_2d) func_plan_inv_t;
+  typedef decltype(fftwf_plan_many_dft_r2c) func_plan_many_fwd_t;
+  typedef decltype(fftwf_plan_many_dft_c2r) func_plan_many_inv_t;
   typedef decltype(fftwf_destroy_plan)    func_destroy_plan_t;
   typedef decltype(fftwf_execute_dft_r2c) func_execute_fwd_t;
   typedef decltype(fftwf_execute_dft_c2r) func_execute_inv_t;
 
   static func_plan_fwd_t*     func_plan_fwd;
   static func_plan_inv_t*     func_plan_inv;
+  static func_plan_many_fwd_t* func_plan_many_fwd;
+  static func_plan_many_inv_t* func_plan_many_inv;
   static func_destroy_plan_t* func_destroy_plan;
   static func_execute_fwd_t*  func_execute_fwd;
   static func_execute_inv_t*  func_execute_inv;
@@ -65,17 +72,59 @@ struct FFTTraits<double> {
   typedef fftw_complex                   complex_t;
   typedef decltype(fftw_plan_dft_r2c_2d) func_plan_fwd_t;
   typedef decltype(fftw_plan_dft_c2r_2d) func_plan_inv_t;
+  typedef decltype(fftw_plan_many_dft_r2c) func_plan_many_fwd_t;
+  typedef decltype(fftw_plan_many_dft_c2r) func_plan_many_inv_t;
   typedef decltype(fftw_destroy_plan)    func_destroy_plan_t;
   typedef decltype(fftw_execute_dft_r2c) func_execute_fwd_t;
   typedef decltype(fftw_execute_dft_c2r) func_execute_inv_t;
 
   static func_plan_fwd_t*     func_plan_fwd;
   static func_plan_inv_t*     func_plan_inv;
+  static func_plan_many_fwd_t* func_plan_many_fwd;
+  static func_plan_many_inv_t* func_plan_many_inv;
   static func_destroy_plan_t* func_destroy_plan;
   static func_execute_fwd_t*  func_execute_fwd;
   static func_execute_inv_t*  func_execute_inv;
 };
 
+/**
+ * @class FFTAllocator
+ * @brief Allocates through fftw_malloc, so the buffers have the alignment required by the SIMD codelets of FFTW
+ * (64 bytes when it is built with AVX-512). Plans created over unaligned buffers can only use the slower, scalar ones.
+ */
+template <typename T>
+struct FFTAllocator {
+  typedef T value_type;
+
+  FFTAllocator() = default;
+
+  template <typename U>
+  FFTAllocator(const FFTAllocator<U>&) {
+  }
+
+  T* allocate(std::size_t n) {
+    void* ptr = fftw_malloc(n * sizeof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, std::size_t) {
+    fftw_free(ptr);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const FFTAllocator<T>&, const FFTAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FFTAllocator<T>&, const FFTAllocator<U>&) {
+  return false;
+}
+
 /**
  * @class FFT
  * @brief Wraps the FFTW API with a more C++ like one.
@@ -91,6 +140,9 @@ struct FFT {
   typedef std::shared_ptr<typename fftw_traits::plan_t> plan_ptr_t;
   typedef typename fftw_traits::complex_t               complex_t;
 
+  /// Buffer for the in-place transforms. The plans are created and executed over aligned memory only
+  typedef std::vector<T, FFTAllocator<T>> work_area_t;
+
   /**
    * Create, or reuses if already exists, a 2D FFTW forward plan.
    * @param width
@@ -104,7 +156,17 @@ struct FFT {
    * @return
    *    A pointer to a plan fit to the given dimensions. It can be safely reused between threads.
    */
-  static plan_ptr_t createForwardPlan(int width, int height, std::vector<T>& inout);
+  static plan_ptr_t createForwardPlan(int width, int height, work_area_t& inout);
+
+  /**
+   * Create, or reuses if already exists, a plan for a batch of 2D forward transforms done at once.
+   * @param howmany
+   *    Number of transforms. Their buffers are laid one after the other in inout, each with the
+   *    layout expected by createForwardPlan
+   * @note
+   *    For howmany == 1, it is the same as createForwardPlan
+   */
+  static plan_ptr_t createForwardPlan(int width, int height, int howmany, work_area_t& inout);
 
   /**
    * Create, or reuses if already exists, a 2D FFTW inverse plan.
@@ -119,7 +181,13 @@ struct FFT {
    * @return
    *    A pointer to a plan fit to the given dimensions. It can be safely reused between threads.
    */
-  static plan_ptr_t createInversePlan(int width, int height, std::vector<T>& inout);
+  static plan_ptr_t createInversePlan(int width, int height, work_area_t& inout);
+
+  /**
+   * Create, or reuses if already exists, a plan for a batch of 2D inverse transforms done at once.
+   * @see createForwardPlan
+   */
+  static plan_ptr_t createInversePlan(int width, int height, int howmany, work_area_t& inout);
 
   /**
    * Execute a forward Fourier Transform
@@ -128,7 +196,7 @@ struct FFT {
    * @param inout
    *    A buffer *in row major order* with the input data. It will be overwritten.
    */
-  static void executeForward(plan_ptr_t& plan, std::vector<T>& inout);
+  static void executeForward(plan_ptr_t& plan, work_area_t& inout);
 
   /**
    * Execute an inverse Fourier Transform
@@ -137,7 +205,22 @@ struct FFT {
    * @param inout
    *    A buffer *in row major order* with the input data. It will be overwritten.
    */
-  static void executeInverse(plan_ptr_t& plan, std::vector<T>& inout);
+  static void executeInverse(plan_ptr_t& plan, work_area_t& inout);
+
+  /**
+   * Get a work area from a small pool kept by the calling thread, instead of allocating a new one
+   * @param size
+   *    Number of elements. Only a work area of exactly this size is reused.
+   * @return
+   *    A work area of the given size. Its content is undefined.
+   */
+  static std::unique_ptr<work_area_t> acquireWorkArea(std::size_t size);
+
+  /**
+   * Give back a work area to the pool of the calling thread, so it can be reused by the next
+   * acquireWorkArea of that size. The least recently released ones are freed when the pool is full.
+   */
+  static void releaseWorkArea(std::unique_ptr<work_area_t> work_area);
 };
 
 /**
@@ -154,6 +237,34 @@ struct FFT {
  */
 int fftRoundDimension(int size);
 
+/**
+ * Set how much effort FFTW puts into planning the transforms of the sizes not seen before.
+ * @param rigor
+ *  One of FFTW_ESTIMATE (the default), FFTW_MEASURE or FFTW_PATIENT. The last two time actual transforms,
+ *  which takes much longer than estimating, but is paid only once per size if the wisdom is kept.
+ * @note
+ *  The plans already created are kept as they are.
+ */
+void fftSetPlanningRigor(unsigned rigor);
+
+unsigned fftGetPlanningRigor();
+
+/**
+ * Import the wisdom exported by a previous run, for both precisions, so the sizes it covers do not
+ * need to be measured again.
+ * @return
+ *  false if the file can not be read, or FFTW does not accept its content (i.e. it comes from another version)
+ */
+bool fftImportWisdom(const std::string& path);
+
+/**
+ * Export the wisdom accumulated so far, for both precisions. It is written to a temporary file first,
+ * so concurrent runs sharing the file never see it half written.
+ * @return
+ *  false if the file could not be written
+ */
+bool fftExportWisdom(const std::string& path);
+
 extern template class FFT<float>;
 extern template class FFT<double>;
 
@@ -39,14 +39,14 @@ namespace SourceXtractor {
  *  Into this buffer
  * @warning
  *  The size of the buffer *must* fit the padded data used by FFTW3: height * (width / 2 + 1) * 2
+ *  It may be one of the transforms of a batch, hence the overload taking a pointer
  */
 template <typename T, template <typename> class Img>
-static void copyImageToFFTWorkArea(Img<T>& origin, std::vector<T>& buffer) {
+static void copyImageToFFTWorkArea(Img<T>& origin, T* buffer) {
   int width  = origin.getWidth();
   int height = origin.getHeight();
   int pad    = 2 * (width / 2 + 1) - width;
   int stride = width + pad;
-  assert(buffer.size() == static_cast<size_t>(height * (width + pad)));
   for (int y = 0; y < height; ++y) {
     for (int x = 0; x < width; ++x) {
       buffer[x + y * stride] = origin.getValue(x, y);
@@ -54,6 +54,12 @@ static void copyImageToFFTWorkArea(Img<T>& origin, std::vector<T>& buffer) {
   }
 }
 
+template <typename T, typename Alloc, template <typename> class Img>
+static void copyImageToFFTWorkArea(Img<T>& origin, std::vector<T, Alloc>& buffer) {
+  assert(buffer.size() == static_cast<size_t>(origin.getHeight() * 2 * (origin.getWidth() / 2 + 1)));
+  copyImageToFFTWorkArea(origin, buffer.data());
+}
+
 /**
  * Copy the data from a buffer following FFTW in-place memory layout (padded)
  * into an image
@@ -84,7 +90,7 @@ static void copyImageToFFTWorkArea(Img<T>& origin, std::vector<T>& buffer) {
  *  If true, scale-back dividing by N
  */
 template <typename T, template <typename> class Img>
-static void copyFFTWorkAreaToImage(std::vector<T>& buffer, Img<T>& dest, int rpad = 0, int lpad = 0, int tpad = 0, int bpad = 0,
+static void copyFFTWorkAreaToImage(const T* buffer, Img<T>& dest, int rpad = 0, int lpad = 0, int tpad = 0, int bpad = 0,
                                    bool normalize = true) {
   const int width         = dest.getWidth();
   const int height        = dest.getHeight();
@@ -93,7 +99,6 @@ static void copyFFTWorkAreaToImage(std::vector<T>& buffer, Img<T>& dest, int rpa
   const int fftw_pad      = 2 * (padded_width / 2 + 1) - padded_width;
   const int stride        = padded_width + fftw_pad;
   const int total_size    = normalize ? padded_width * padded_height : 1;
-  assert(buffer.size() == static_cast<size_t>(padded_height * (padded_width + fftw_pad)));
   for (int y = 0; y < height; ++y) {
     for (int x = 0; x < width; ++x) {
       dest.setValue(x, y, buffer[x + lpad + (y + tpad) * stride] / total_size);
@@ -101,6 +106,15 @@ static void copyFFTWorkAreaToImage(std::vector<T>& buffer, Img<T>& dest, int rpa
   }
 }
 
+template <typename T, typename Alloc, template <typename> class Img>
+static void copyFFTWorkAreaToImage(std::vector<T, Alloc>& buffer, Img<T>& dest, int rpad = 0, int lpad = 0, int tpad = 0, int bpad = 0,
+                                   bool normalize = true) {
+  const int padded_width  = dest.getWidth() + rpad + lpad;
+  const int padded_height = dest.getHeight() + tpad + bpad;
+  assert(buffer.size() == static_cast<size_t>(padded_height * 2 * (padded_width / 2 + 1)));
+  copyFFTWorkAreaToImage(buffer.data(), dest, rpad, lpad, tpad, bpad, normalize);
+}
+
 }  // namespace SourceXtractor
 
 #endif  // _SEFRAMEWORK_FFT_FFTHELPER_H
@@ -0,0 +1,118 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsCompressedImage.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_FITS_FITSCOMPRESSEDIMAGE_H_
+#define _SEFRAMEWORK_FITS_FITSCOMPRESSEDIMAGE_H_
+
+#include <memory>
+#include <string>
+
+#include <fitsio.h>
+
+#include "SEFramework/FITS/FitsHandlePool.h"
+#include "SEFramework/Image/ImageTile.h"
+
+namespace SourceXtractor {
+
+/**
+ * @class FitsCompressedImage
+ * @brief Decodes the tiles of a Rice compressed FITS image read without cfitsio
+ *
+ * @details
+ * A tile-compressed image is a binary table with one row per compression tile, the compressed bytes
+ * being in the heap. cfitsio decompresses them through the shared handle of the file, so this class reads
+ * the rows and the compressed bytes with pread through a FitsHandlePool handle instead, and decodes them on
+ * the calling thread with the Rice decoder of cfitsio, which does not touch the state of any file.
+ *
+ * Only the layouts fpack writes by default are supported: Rice compression of integer images, and of
+ * floating point images quantized with or without subtractive dithering. Tiles cfitsio would not
+ * decode the same way (i.e. with null pixels, or stored uncompressed) are left to it.
+ */
+class FitsCompressedImage {
+public:
+
+  /**
+   * Read the layout of the compressed image of the current HDU
+   * @param data_offset
+   *    Where the binary table starts in the file
+   * @param image_type
+   *    Type of the pixels that will be read
+   * @return nullptr if the tiles can not be decoded here, they must be read through cfitsio then
+   */
+  static std::unique_ptr<FitsCompressedImage> create(fitsfile *fptr, long long data_offset,
+                                                     ImageTile::ImageType image_type);
+
+  /**
+   * Decode the pixels of the region into out, in row major order
+   * @return false if some of the compression tiles can not be decoded here. The content of out is undefined then
+   */
+  bool read(const FitsHandlePool::Handle& handle, int x, int y, int width, int height, void* out) const;
+
+private:
+
+  enum class Quantization {
+    NONE, NO_DITHER, SUBTRACTIVE_DITHER_1, SUBTRACTIVE_DITHER_2
+  };
+
+  /// Where a value is in the rows of the table. For scalars, type is the TFORM letter
+  struct Column {
+    int m_offset = -1;
+    char m_type = 0;
+  };
+
+  FitsCompressedImage() = default;
+
+  template <typename T>
+  bool readTiles(const FitsHandlePool::Handle& handle, int x, int y, int width, int height, T* out) const;
+
+  template <typename T>
+  bool decodeTile(const FitsHandlePool::Handle& handle, long tile, const unsigned char* row,
+                  int x, int y, int width, int height, T* out) const;
+
+  double readScalar(const unsigned char* row, const Column& column, double default_value) const;
+
+  ImageTile::ImageType m_image_type;
+  int m_width, m_height;
+  int m_tile_width, m_tile_height;
+  int m_tiles_x;
+
+  // The rows of the table, and its heap, in the file
+  long long m_table_offset, m_heap_offset;
+  int m_row_size;
+
+  // COMPRESSED_DATA is an array descriptor, of 32 bits values for P or 64 bits for Q
+  Column m_data_column;
+  Column m_zscale_column, m_zzero_column, m_zblank_column;
+
+  int m_zbitpix;
+  int m_bytepix, m_blocksize;
+  double m_zscale, m_zzero;
+  bool m_has_zblank;
+  long long m_zblank;
+  double m_bscale, m_bzero;
+  Quantization m_quantization;
+  int m_dither_seed;
+};
+
+}  // namespace SourceXtractor
+
+#endif /* _SEFRAMEWORK_FITS_FITSCOMPRESSEDIMAGE_H_ */
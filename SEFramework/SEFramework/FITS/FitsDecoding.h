@@ -0,0 +1,149 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsDecoding.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_FITS_FITSDECODING_H_
+#define _SEFRAMEWORK_FITS_FITSDECODING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <fitsio.h>
+
+namespace SourceXtractor {
+
+/**
+ * Helpers to decode the pixels of a FITS data unit read without cfitsio (i.e. memory mapped, or read with pread):
+ * big-endian values of the type given by BITPIX, converted to the requested type.
+ */
+namespace FitsDecoding {
+
+inline std::uint8_t byteSwap(std::uint8_t v) {
+  return v;
+}
+
+inline std::uint16_t byteSwap(std::uint16_t v) {
+  return __builtin_bswap16(v);
+}
+
+inline std::uint32_t byteSwap(std::uint32_t v) {
+  return __builtin_bswap32(v);
+}
+
+inline std::uint64_t byteSwap(std::uint64_t v) {
+  return __builtin_bswap64(v);
+}
+
+template <std::size_t N>
+struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { using type = std::uint8_t; };
+template <> struct UnsignedOfSize<2> { using type = std::uint16_t; };
+template <> struct UnsignedOfSize<4> { using type = std::uint32_t; };
+template <> struct UnsignedOfSize<8> { using type = std::uint64_t; };
+
+template <typename D>
+inline D decodeValue(const unsigned char* input) {
+  using U = typename UnsignedOfSize<sizeof(D)>::type;
+  U raw;
+  std::memcpy(&raw, input, sizeof(D));
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  raw = byteSwap(raw);
+#endif
+  D value;
+  std::memcpy(&value, &raw, sizeof(D));
+  return value;
+}
+
+/**
+ * Decode count big-endian values of type D into output.
+ * The loop has no dependency between iterations and no branch, so the compiler turns it
+ * into vector byte shuffles (and conversions when D and T differ).
+ */
+template <typename D, typename T>
+void decodeRow(const unsigned char* __restrict__ input, T* __restrict__ output, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    output[i] = static_cast<T>(decodeValue<D>(input + i * sizeof(D)));
+  }
+}
+
+/// Same as decodeRow, applying BSCALE and BZERO as cfitsio does (value * bscale + bzero)
+template <typename D, typename T>
+void decodeScaledRow(const unsigned char* __restrict__ input, T* __restrict__ output, std::size_t count,
+                     double bscale, double bzero) {
+  for (std::size_t i = 0; i < count; ++i) {
+    output[i] = static_cast<T>(decodeValue<D>(input + i * sizeof(D)) * bscale + bzero);
+  }
+}
+
+/// decodeRow, or decodeScaledRow when there is a scaling
+template <typename D, typename T>
+void decodePixels(const unsigned char* input, T* output, std::size_t count, double bscale, double bzero) {
+  if (bscale != 1. || bzero != 0.) {
+    decodeScaledRow<D>(input, output, count, bscale, bzero);
+  }
+  else {
+    decodeRow<D>(input, output, count);
+  }
+}
+
+inline std::size_t bytesPerPixel(int bitpix) {
+  return static_cast<std::size_t>(bitpix < 0 ? -bitpix : bitpix) / 8;
+}
+
+}  // end namespace FitsDecoding
+
+/**
+ * Decode count pixels, stored as given by BITPIX, into output
+ * @param bscale
+ *    Scaling applied to the stored values. It is skipped when bscale is 1 and bzero 0
+ * @param bzero
+ *    Offset applied to the stored values
+ */
+template <typename T>
+void decodeFitsPixels(int bitpix, const unsigned char* input, T* output, std::size_t count,
+                      double bscale = 1., double bzero = 0.) {
+  using namespace FitsDecoding;
+  switch (bitpix) {
+    case BYTE_IMG:
+      decodePixels<std::uint8_t>(input, output, count, bscale, bzero);
+      break;
+    case SHORT_IMG:
+      decodePixels<std::int16_t>(input, output, count, bscale, bzero);
+      break;
+    case LONG_IMG:
+      decodePixels<std::int32_t>(input, output, count, bscale, bzero);
+      break;
+    case LONGLONG_IMG:
+      decodePixels<std::int64_t>(input, output, count, bscale, bzero);
+      break;
+    case FLOAT_IMG:
+      decodePixels<float>(input, output, count, bscale, bzero);
+      break;
+    case DOUBLE_IMG:
+      decodePixels<double>(input, output, count, bscale, bzero);
+      break;
+  }
+}
+
+}  // end namespace SourceXtractor
+
+#endif /* _SEFRAMEWORK_FITS_FITSDECODING_H_ */
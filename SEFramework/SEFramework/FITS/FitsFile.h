@@ -39,6 +39,9 @@ namespace SourceXtractor {
  * @class FitsFile
  * @brief represents access to a whole FITS file and handles loading and caching FITS headers
  *
+ * The headers of each HDU are parsed the first time they are asked for. For read-only files, the list
+ * of image HDUs and the raw header records can be kept in an on-disk cache, so opening the same
+ * unmodified file again does not need to go through all its HDUs.
  */
 class FitsFile {
 public:
@@ -56,17 +59,32 @@ public:
 
   void refresh();
 
+  /**
+   * Directory where the headers of read-only files are cached, keyed by path, size and modification time.
+   * An empty path disables the cache.
+   */
+  static void setHeaderCacheDirectory(const boost::filesystem::path& directory);
+
 private:
   boost::filesystem::path m_path;
   bool m_is_writeable;
   std::unique_ptr<fitsfile, void (*)(fitsfile*)> m_fits_ptr;
   std::vector<int> m_image_hdus;
   std::vector<std::map<std::string, MetadataEntry>> m_headers;
+  std::vector<bool> m_headers_loaded;
+  // Header records read from the cache, one per line, until they are parsed
+  std::vector<std::string> m_header_records;
+  // Values from the .head file, which override those of the FITS headers
+  std::map<int, std::map<std::string, MetadataEntry>> m_head_overrides;
 
   void open();
   void loadInfo();
-  void loadFitsHeader();
+  void loadFitsHeader(int hdu);
   void loadHeadFile();
+
+  boost::filesystem::path getHeaderCachePath() const;
+  bool readHeaderCache();
+  void writeHeaderCache() const;
 };
 
 }  // namespace SourceXtractor
@@ -0,0 +1,127 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsHandlePool.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_FITS_FITSHANDLEPOOL_H_
+#define _SEFRAMEWORK_FITS_FITSHANDLEPOOL_H_
+
+#include <sys/types.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+namespace SourceXtractor {
+
+/**
+ * @class FitsHandlePool
+ * @brief Keeps independent read-only descriptors to the FITS files
+ *
+ * @details
+ * All the accesses to a file through the FileManager share the same handler, so threads reading tiles
+ * from the same file wait for each other. Opening the file again with cfitsio does not help: it finds the
+ * file already open and shares the same internal state (buffers, current HDU), which can not be used
+ * without the FileManager lock. The handles of this pool are plain file descriptors instead, used to read
+ * the raw data units (see FitsImageSource) with pread, independently from cfitsio.
+ *
+ * The handles are kept open once released, to be reused by the next read on the same file. The total number
+ * of handles open, for all the files, is bounded: once reached, idle handles of other files are closed to make
+ * room, and if there are none, no handle is given and the caller has to use the shared one instead.
+ */
+class FitsHandlePool : public std::enable_shared_from_this<FitsHandlePool> {
+public:
+
+  /// A handle borrowed from the pool. It is returned to the pool when destroyed
+  class Handle {
+  public:
+    Handle(std::shared_ptr<FitsHandlePool> pool, std::string filename, int fd);
+
+    ~Handle();
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    int getDescriptor() const;
+
+    /// Read size bytes starting at offset. Throws if they can not all be read
+    void read(off_t offset, std::size_t size, void* out) const;
+
+  private:
+    std::shared_ptr<FitsHandlePool> m_pool;
+    std::string m_filename;
+    int m_fd;
+  };
+
+  explicit FitsHandlePool(unsigned max_handles = 32);
+
+  virtual ~FitsHandlePool();
+
+  static std::shared_ptr<FitsHandlePool> getInstance();
+
+  /// Maximum number of handles open at the same time, for all the files. 0 disables the pool
+  void setMaxHandles(unsigned max_handles);
+
+  unsigned getMaxHandles() const;
+
+  /// Number of handles open, in use or not
+  unsigned getOpenHandles() const;
+
+  /**
+   * @param filename
+   *    Path of the file on disk, without the cfitsio extended syntax
+   * @return A handle to the given file, opened read-only, or nullptr if the limit of handles open
+   *    has been reached, or the file could not be opened
+   */
+  std::unique_ptr<Handle> acquire(const std::string& filename);
+
+  /// Close all the handles not in use
+  void closeIdle();
+
+private:
+
+  struct IdleHandle {
+    std::string m_filename;
+    int m_fd;
+  };
+
+  void release(const std::string& filename, int fd);
+
+  /**
+   * Take out the least recently used idle handles, until there are at most max_open handles open.
+   * Must be called with the lock held. The handles are counted as closed, and must be closed by the caller.
+   */
+  std::vector<int> takeExtraHandles(unsigned max_open);
+
+  static void closeHandles(const std::vector<int>& handles);
+
+  mutable boost::mutex m_mutex;
+  unsigned m_max_handles, m_open_handles;
+  // Most recently released at the front
+  std::list<IdleHandle> m_idle;
+};
+
+}  // namespace SourceXtractor
+
+#endif /* _SEFRAMEWORK_FITS_FITSHANDLEPOOL_H_ */
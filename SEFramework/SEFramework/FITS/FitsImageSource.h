@@ -24,6 +24,7 @@
 #ifndef _SEFRAMEWORK_IMAGE_FITSIMAGESOURCE_H_
 #define _SEFRAMEWORK_IMAGE_FITSIMAGESOURCE_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <map>
@@ -33,7 +34,9 @@
 #include "FilePool/FileManager.h"
 #include "SEFramework/CoordinateSystem/CoordinateSystem.h"
 #include "SEFramework/Image/ImageSourceWithMetadata.h"
+#include "SEFramework/FITS/FitsCompressedImage.h"
 #include "SEFramework/FITS/FitsFile.h"
+#include "SEFramework/FITS/FitsHandlePool.h"
 #include "SEUtils/VariantCast.h"
 
 
@@ -53,6 +56,10 @@ public:
    * @param hdu_number
    *    HDU number. If <= 0, the constructor will use the first HDU containing an image
    * @param manager
+   * @note
+   *    If the image is stored as it is, or Rice compressed, in a plain file (not gzipped), the tiles of a source
+   *    opened this way are read straight from the data unit through the FitsHandlePool when possible,
+   *    so several threads can read and decompress them at the same time. This stops once a tile is saved.
    */
   FitsImageSource(const std::string& filename, int hdu_number = 0,
                   ImageTile::ImageType image_type = ImageTile::AutoType,
@@ -85,6 +92,9 @@ public:
 
   void saveTile(ImageTile& tile) override;
 
+  /// Tiles covering whole rows of the image are written as a single range of pixels, the file is flushed once
+  void saveTiles(const std::vector<std::shared_ptr<ImageTile>>& tiles) override;
+
   template<typename TT>
   bool readFitsKeyword(const std::string& header_keyword, TT& out_value) const {
     auto& headers = getMetadata();
@@ -104,6 +114,16 @@ public:
     return m_image_type;
   }
 
+  /// Reads go either through their own descriptor, or through the handle locked by the FileManager
+  bool isReentrant() const override {
+    return true;
+  }
+
+  /// For tile-compressed images, the size of the compression tiles (ZTILE1, ZTILE2)
+  std::pair<int, int> getNativeTileSize() const override {
+    return {m_native_tile_width, m_native_tile_height};
+  }
+
   std::unique_ptr<std::vector<char>> getFitsHeaders(int& number_of_records) const;
 
   const std::map<std::string, MetadataEntry> getMetadata() const override;
@@ -113,6 +133,19 @@ public:
 private:
   void switchHdu(fitsfile *fptr, int hdu_number) const;
 
+  void readPixels(fitsfile *fptr, int x, int y, int width, int height, void* out) const;
+
+  /// Reads the rows [start_y, end_y) of the tile straight into its buffer
+  void readRows(ImageTile& tile, int start_y, int end_y) const;
+
+  /// Reads the rows [start_y, end_y) of the tile from the data unit, without cfitsio
+  void readRawRows(const FitsHandlePool::Handle& handle, ImageTile& tile, int start_y, int end_y) const;
+
+  /// Find where the pixels are in the file, if they can be read without cfitsio. See m_data_file and m_compressed_image
+  void locateDataUnit(fitsfile *fptr);
+
+  void writeTile(fitsfile *fptr, ImageTile& tile);
+
   int getDataType() const;
 
   int getImageType() const;
@@ -125,6 +158,21 @@ private:
   int m_width;
   int m_height;
   ImageTile::ImageType m_image_type;
+
+  // Size of the compression tiles, 0 if the image is not tile-compressed
+  int m_native_tile_width;
+  int m_native_tile_height;
+
+  // Read the tiles through independent handles. Only while no one writes into the file
+  std::atomic<bool> m_pooled_reads;
+
+  // File holding the data unit, when its pixels can be read straight from it. Empty otherwise
+  std::string m_data_file;
+  // Decodes the tiles of a compressed data unit, null if it is not compressed
+  std::unique_ptr<FitsCompressedImage> m_compressed_image;
+  long long m_data_offset;
+  int m_bitpix;
+  double m_bscale, m_bzero;
 };
 
 }
@@ -23,8 +23,8 @@
 #ifndef _SEFRAMEWORK_IMAGE_FITSREADER_H
 #define _SEFRAMEWORK_IMAGE_FITSREADER_H
 
-#include "SEFramework/Image/BufferedImage.h"
 #include "SEFramework/FITS/FitsImageSource.h"
+#include "SEFramework/FITS/MmapFitsImage.h"
 
 namespace SourceXtractor {
 
@@ -45,7 +45,7 @@ public:
 
   static std::shared_ptr<Image<T>> readFile(const std::string& filename) {
     auto image_source = std::make_shared<FitsImageSource>(filename, 0, ImageTile::getTypeValue(T()));
-    return BufferedImage<T>::create(image_source);
+    return openFitsImage<T>(image_source);
   }
 
 }; /* End of FitsReader class */
@@ -0,0 +1,93 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * MmapFitsImage.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_FITS_MMAPFITSIMAGE_H_
+#define _SEFRAMEWORK_FITS_MMAPFITSIMAGE_H_
+
+#include <ElementsKernel/Exception.h>
+
+#include "SEFramework/FITS/FitsImageSource.h"
+#include "SEFramework/FITS/MmapFitsImageSource.h"
+#include "SEFramework/Image/BufferedImage.h"
+#include "SEFramework/Image/FusedImage.h"
+
+namespace SourceXtractor {
+
+/**
+ * @class MmapFitsImage
+ * @brief Read-only image decoding its pixels from a memory mapped FITS file on each request
+ *
+ * @details
+ * Decoding is a single pass over the mapped data, so unlike BufferedImage there is no tile cache: chunks are
+ * written directly from the mapping, and the operating system page cache keeps the data unit in memory.
+ */
+template <typename T>
+class MmapFitsImage : public FusedImage<T> {
+protected:
+  explicit MmapFitsImage(std::shared_ptr<const MmapFitsImageSource> source) : m_source(std::move(source)) {}
+
+public:
+  virtual ~MmapFitsImage() = default;
+
+  static std::shared_ptr<MmapFitsImage<T>> create(std::shared_ptr<const MmapFitsImageSource> source) {
+    return std::shared_ptr<MmapFitsImage<T>>(new MmapFitsImage<T>(std::move(source)));
+  }
+
+  std::string getRepr() const override {
+    return "MmapFitsImage(" + m_source->getRepr() + ")";
+  }
+
+  int getWidth() const override {
+    return m_source->getWidth();
+  }
+
+  int getHeight() const override {
+    return m_source->getHeight();
+  }
+
+  void evaluate(int x, int y, int width, int height, T* output) const override {
+    m_source->readPixels(x, y, width, height, output);
+  }
+
+private:
+  std::shared_ptr<const MmapFitsImageSource> m_source;
+};
+
+/**
+ * Image reading the pixels of a FITS image source that will not be modified: memory mapped when the
+ * data unit allows it, through the TileManager otherwise (i.e. compressed or scaled images).
+ */
+template <typename T>
+std::shared_ptr<Image<T>> openFitsImage(const std::shared_ptr<FitsImageSource>& fits_image_source) {
+  try {
+    auto mmap_source = std::make_shared<MmapFitsImageSource>(
+        fits_image_source->getRepr(), fits_image_source->getHDU(), ImageTile::getTypeValue(T()));
+    return MmapFitsImage<T>::create(mmap_source);
+  }
+  catch (const Elements::Exception&) {
+    return BufferedImage<T>::create(fits_image_source);
+  }
+}
+
+} /* namespace SourceXtractor */
+
+#endif /* _SEFRAMEWORK_FITS_MMAPFITSIMAGE_H_ */
@@ -0,0 +1,119 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * MmapFitsImageSource.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_FITS_MMAPFITSIMAGESOURCE_H_
+#define _SEFRAMEWORK_FITS_MMAPFITSIMAGESOURCE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "FilePool/FileManager.h"
+#include "SEFramework/Image/ImageSource.h"
+
+namespace SourceXtractor {
+
+using Euclid::FilePool::FileManager;
+
+/**
+ * @class MmapFitsImageSource
+ * @brief Read-only access to the pixels of an uncompressed FITS image through a memory mapping of its data unit
+ *
+ * @details
+ * cfitsio is only used to locate the data unit, the pixels are decoded (big-endian to native, and converted to
+ * the requested type) straight from the mapping into the caller's buffer, so there is no intermediate copy.
+ * Only images stored as they are on disk can be mapped: the constructor throws for compressed images, images
+ * with BSCALE/BZERO scaling, or files cfitsio does not read from a plain local file (i.e. gzipped).
+ * FitsImageSource is the fallback for those.
+ */
+class MmapFitsImageSource : public ImageSource, public std::enable_shared_from_this<ImageSource> {
+public:
+
+  /**
+   * Constructor
+   * @param filename
+   *    Path to the FITS file
+   * @param hdu_number
+   *    HDU number. If <= 0, the constructor will use the first HDU containing an image
+   * @param image_type
+   *    Type of the tiles, the pixels are converted on read. AutoType uses the type matching BITPIX
+   * @param manager
+   * @throw Elements::Exception
+   *    If the image can not be memory mapped
+   */
+  MmapFitsImageSource(const std::string& filename, int hdu_number = 0,
+                      ImageTile::ImageType image_type = ImageTile::AutoType,
+                      std::shared_ptr<FileManager> manager = FileManager::getDefault());
+
+  virtual ~MmapFitsImageSource();
+
+  MmapFitsImageSource(const MmapFitsImageSource&) = delete;
+  MmapFitsImageSource& operator=(const MmapFitsImageSource&) = delete;
+
+  std::string getRepr() const override {
+    return m_filename;
+  }
+
+  int getWidth() const override {
+    return m_width;
+  }
+
+  int getHeight() const override {
+    return m_height;
+  }
+
+  ImageTile::ImageType getType() const override {
+    return m_image_type;
+  }
+
+  std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const override;
+
+  /// The mapping is only read
+  bool isReentrant() const override {
+    return true;
+  }
+
+  void saveTile(ImageTile& tile) override;
+
+  /**
+   * Decode the given region into output, row by row without padding (width * height elements).
+   * Instantiated for the pixel types supported by ImageTile.
+   */
+  template <typename T>
+  void readPixels(int x, int y, int width, int height, T* output) const;
+
+private:
+  std::string m_filename;
+  int m_width, m_height;
+  int m_bitpix;
+  ImageTile::ImageType m_image_type;
+
+  // Start of the mapping, which begins at the page holding the first pixel
+  void* m_mapping;
+  std::size_t m_mapping_size;
+  // First pixel of the data unit inside the mapping
+  const unsigned char* m_data;
+};
+
+}
+
+#endif /* _SEFRAMEWORK_FITS_MMAPFITSIMAGESOURCE_H_ */
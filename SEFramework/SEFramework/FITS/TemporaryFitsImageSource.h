@@ -62,6 +62,10 @@ public:
     return m_image_source->saveTile(tile);
   }
 
+  virtual void saveTiles(const std::vector<std::shared_ptr<ImageTile>>& tiles) override {
+    return m_image_source->saveTiles(tiles);
+  }
+
   virtual int getWidth() const override {
     return m_image_source->getWidth();
   }
@@ -74,6 +78,10 @@ public:
     return m_image_source->getType();
   }
 
+  bool isReentrant() const override {
+    return m_image_source->isReentrant();
+  }
+
 private:
   Elements::TempFile m_temp_file;
   std::shared_ptr<FitsImageSource> m_image_source;
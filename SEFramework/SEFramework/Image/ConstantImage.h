@@ -24,13 +24,16 @@
 #ifndef _SEFRAMEWORK_IMAGE_CONSTANTIMAGE_H_
 #define _SEFRAMEWORK_IMAGE_CONSTANTIMAGE_H_
 
+#include <algorithm>
+
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ImageChunk.h"
+#include "SEFramework/Image/FusedImage.h"
 
 namespace SourceXtractor {
 
 template <typename T>
-class ConstantImage : public Image<T> {
+class ConstantImage : public FusedImage<T> {
 protected:
 
   ConstantImage(int width, int height, T constant_value)
@@ -58,8 +61,8 @@ public:
     return m_width;
   }
 
-  std::shared_ptr<ImageChunk<T>> getChunk(int /*x*/, int /*y*/, int width, int height) const final {
-    return UniversalImageChunk<T>::create(std::vector<T>(width * height, m_constant_value), width, height);
+  void evaluate(int /*x*/, int /*y*/, int width, int height, T* output) const final {
+    std::fill(output, output + width * height, m_constant_value);
   }
 
 private:
@@ -25,6 +25,7 @@
 
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ImageChunk.h"
+#include "SEFramework/Image/FusedImage.h"
 
 namespace SourceXtractor {
 
@@ -40,7 +41,7 @@ namespace SourceXtractor {
  *  Also, make sure that whatever is captured is thread safe!
  */
 template<typename T, typename I = T>
-class FunctionalImage : public Image<T> {
+class FunctionalImage : public FusedImage<T> {
 public:
   using FunctorType = std::function<T(int x, int y, I v)>;
 
@@ -69,15 +70,14 @@ public:
     return m_img->getHeight();
   }
 
-  std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const final {
-    auto in_chunk = m_img->getChunk(x, y, width, height);
-    auto chunk = UniversalImageChunk<T>::create(width, height);
+  void evaluate(int x, int y, int width, int height, T* output) const final {
+    ScratchBuffer<I> in_data(width * height);
+    evaluateImage<I>(*m_img, x, y, width, height, in_data.data());
     for (int iy = 0; iy < height; ++iy) {
       for (int ix = 0; ix < width; ++ix) {
-        chunk->at(ix, iy) = m_functor(ix + x, iy + y, in_chunk->getValue(ix, iy));
+        output[ix + iy * width] = m_functor(ix + x, iy + y, in_data[ix + iy * width]);
       }
     }
-    return chunk;
   }
 
 private:
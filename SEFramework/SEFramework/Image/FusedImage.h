@@ -0,0 +1,135 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FusedImage.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_IMAGE_FUSEDIMAGE_H_
+#define _SEFRAMEWORK_IMAGE_FUSEDIMAGE_H_
+
+#include <vector>
+
+#include "SEFramework/Image/Image.h"
+#include "SEFramework/Image/ImageChunk.h"
+
+namespace SourceXtractor {
+
+/**
+ * @class FusedImage
+ * @brief Base for images computed pixel by pixel from other images
+ *
+ * @details
+ * Images such as SubtractImage, ThresholdedImage or MaskedImage are chained at runtime
+ * (i.e. by Frame), so the chain can not be fused at compile time. However, going through getChunk,
+ * every level of the chain would allocate a new chunk for its output.
+ * A FusedImage evaluates its pixels directly into a buffer given by the caller instead, and asks its main
+ * operand to do the same on that very buffer. A whole chain is thus computed into the single output chunk,
+ * and only secondary operands need a buffer of their own, which is reused between calls (see ScratchBuffer).
+ *
+ * @tparam T
+ *  Pixel type
+ */
+template<typename T>
+class FusedImage : public Image<T> {
+public:
+  virtual ~FusedImage() = default;
+
+  std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const final {
+    std::vector<T> data(width * height);
+    evaluate(x, y, width, height, data.data());
+    return UniversalImageChunk<T>::create(std::move(data), width, height);
+  }
+
+  /**
+   * Write the pixel values of the given region into output, row by row without padding
+   * (width * height elements)
+   */
+  virtual void evaluate(int x, int y, int width, int height, T* output) const = 0;
+};
+
+/**
+ * Write the pixel values of the given region of any image into output (width * height elements).
+ * FusedImage are evaluated in place, other images go through getChunk.
+ */
+template<typename T>
+void evaluateImage(const Image<T>& image, int x, int y, int width, int height, T* output) {
+  auto fused = dynamic_cast<const FusedImage<T>*>(&image);
+  if (fused) {
+    fused->evaluate(x, y, width, height, output);
+    return;
+  }
+  auto chunk = image.getChunk(x, y, width, height);
+  for (int iy = 0; iy < height; ++iy) {
+    for (int ix = 0; ix < width; ++ix) {
+      output[ix + iy * width] = chunk->getValue(ix, iy);
+    }
+  }
+}
+
+/**
+ * Per-thread buffer for the secondary operands of a FusedImage.
+ * Buffers are taken from, and returned to, a thread local pool, so once warmed up
+ * evaluating a chain does not allocate. As chains are nested, several buffers can be in use at once.
+ * The pool keeps at most s_max_pooled buffers of up to s_max_pooled_bytes each, larger ones are freed.
+ */
+template<typename T>
+class ScratchBuffer {
+public:
+  explicit ScratchBuffer(std::size_t size) {
+    auto& pool = getPool();
+    if (!pool.empty()) {
+      m_buffer = std::move(pool.back());
+      pool.pop_back();
+    }
+    m_buffer.resize(size);
+  }
+
+  ~ScratchBuffer() {
+    auto& pool = getPool();
+    if (pool.size() < s_max_pooled && m_buffer.capacity() * sizeof(T) <= s_max_pooled_bytes) {
+      pool.emplace_back(std::move(m_buffer));
+    }
+  }
+
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+  T* data() {
+    return m_buffer.data();
+  }
+
+  T& operator[](std::size_t i) {
+    return m_buffer[i];
+  }
+
+private:
+  static constexpr std::size_t s_max_pooled = 8;
+  static constexpr std::size_t s_max_pooled_bytes = 4 * 1024 * 1024;
+
+  std::vector<T> m_buffer;
+
+  static std::vector<std::vector<T>>& getPool() {
+    static thread_local std::vector<std::vector<T>> pool;
+    return pool;
+  }
+};
+
+} /* namespace SourceXtractor */
+
+#endif /* _SEFRAMEWORK_IMAGE_FUSEDIMAGE_H_ */
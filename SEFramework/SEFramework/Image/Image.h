@@ -23,6 +23,7 @@
 #ifndef _SEFRAMEWORK_IMAGE_IMAGE_H
 #define _SEFRAMEWORK_IMAGE_IMAGE_H
 
+#include <cassert>
 #include <memory>
 
 #include "SEUtils/Types.h"
@@ -73,6 +74,21 @@ public:
     return x >= 0 && y >= 0 && x < getWidth() && y < getHeight();
   }
 
+  /**
+   * Calls func(y, row) for each row of the given region, where y is the row in image coordinates, and row
+   * points to the width contiguous pixel values of the row, starting at x. The region must be inside the image.
+   * The region is retrieved once, so in hot loops this is much cheaper than reading pixel by pixel,
+   * and the loop over the row can be vectorized.
+   */
+  template <typename Func>
+  void forEachRow(int x, int y, int width, int height, Func&& func) const {
+    assert(isInside(x, y) && isInside(x + width - 1, y + height - 1));
+    auto chunk = getChunk(x, y, width, height);
+    chunk->forEachRow([&func, y](int chunk_y, const T* row) {
+      func(y + chunk_y, row);
+    });
+  }
+
 }; /* End of Image class */
 
 /// Alias for the detection image, to make easier its type modification
@@ -89,4 +105,7 @@ using FlagImage = Image<std::int64_t>;
 
 } /* namespace SourceXtractor */
 
+// Image::forEachRow needs the complete definition of the chunk
+#include "SEFramework/Image/ImageChunk.h"
+
 #endif
@@ -73,6 +73,28 @@ public:
     return m_height;
   }
 
+  /// Returns the distance, in pixels, between the start of two consecutive rows
+  int getStride() const {
+    return m_stride;
+  }
+
+  /// Returns a pointer to the first pixel of the row y. The getWidth() pixels of the row are contiguous
+  const T* getRowSpan(int y) const {
+    assert(y >= 0 && y < m_height);
+    return m_data->data() + m_offset + y * m_stride;
+  }
+
+  using Image<T>::forEachRow;
+
+  /// Calls func(y, row) for each row of the chunk, where row points to the getWidth() contiguous pixels of the row
+  template <typename Func>
+  void forEachRow(Func&& func) const {
+    const T* row = m_data->data() + m_offset;
+    for (int y = 0; y < m_height; ++y, row += m_stride) {
+      func(y, row);
+    }
+  }
+
   virtual std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const override {
     return create(m_data, m_offset + x + y * m_stride, width, height, m_stride);
   }
@@ -24,6 +24,10 @@
 #ifndef _SEFRAMEWORK_IMAGE_IMAGESOURCE_H_
 #define _SEFRAMEWORK_IMAGE_IMAGESOURCE_H_
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <boost/variant.hpp>
 
 #include "SEFramework/Image/Image.h"
@@ -60,6 +64,16 @@ public:
   virtual std::string getRepr() const = 0;
 
   virtual void saveTile(ImageTile& tile) = 0;
+
+  /**
+   * Save a batch of tiles, sorted by row then column. Sources backed by a file can override it to
+   * group the writes and flush only once.
+   */
+  virtual void saveTiles(const std::vector<std::shared_ptr<ImageTile>>& tiles) {
+    for (auto& tile : tiles) {
+      saveTile(*tile);
+    }
+  }
   virtual std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const = 0;
 
 
@@ -71,6 +85,23 @@ public:
 
   virtual ImageTile::ImageType getType() const = 0;
 
+  /**
+   * Some sources are stored in blocks that must be read as a whole (i.e. tile-compressed FITS images),
+   * so they are read more efficiently by tiles aligned to those blocks.
+   * @return The width and height of the blocks, or 0 for a dimension with no preference
+   */
+  virtual std::pair<int, int> getNativeTileSize() const {
+    return {0, 0};
+  }
+
+  /**
+   * The TileManager reads the tiles of a source from several threads at the same time only if
+   * the source says getImageTile can be called concurrently. Otherwise the reads are serialized.
+   */
+  virtual bool isReentrant() const {
+    return false;
+  }
+
   /**
    * @return A copy of the metadata set
    */
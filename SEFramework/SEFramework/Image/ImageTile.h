@@ -26,6 +26,7 @@
 #include <iostream>
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/VectorImage.h"
+#include "SEFramework/Image/TileBufferPool.h"
 
 namespace SourceXtractor {
 
@@ -43,6 +44,7 @@ public:
     LongLongImage,
   };
 
+  /// The pixel values of the new tile are undefined, as its buffer may be recycled (see TileBufferPool)
   static std::shared_ptr<ImageTile> create(ImageType image_type, int x, int y, int width, int height, std::shared_ptr<ImageSource> source=nullptr);
 
   virtual ~ImageTile() = default;
@@ -160,11 +162,17 @@ public:
 
   ImageTileWithType(int x, int y, int width, int height, std::shared_ptr<ImageSource> source)
       : ImageTile(getTypeValue(T()), x, y, width, height, source) {
-    m_tile_image = VectorImage<T>::create(width, height);
+    m_tile_image = VectorImage<T>::create(width, height,
+                                          TileBufferPool::acquire<T>(static_cast<std::size_t>(width) * height));
   }
 
   virtual ~ImageTileWithType() {
     saveIfModified();
+    // Recycle the buffer, unless the pixels are still referenced from somewhere else
+    std::vector<T> buffer;
+    if (m_tile_image.use_count() == 1 && m_tile_image->releaseData(buffer)) {
+      TileBufferPool::release(std::move(buffer));
+    }
   }
 
   int getTileMemorySize() const override {
@@ -26,6 +26,7 @@
 
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ImageChunk.h"
+#include "SEFramework/Image/FusedImage.h"
 
 namespace SourceXtractor {
 
@@ -42,7 +43,7 @@ namespace SourceXtractor {
  *  The image is masked where the operator evaluates to true on the mask image
  */
 template<typename T, typename M, template <typename> class Operator = std::bit_and>
-class MaskedImage : public Image<T> {
+class MaskedImage : public FusedImage<T> {
 private:
   MaskedImage(const std::shared_ptr<Image<T>>& image, const std::shared_ptr<Image<M>>& mask,
               T replacement, M mask_flag) : m_image{image}, m_mask{mask}, m_replacement{replacement},
@@ -90,16 +91,14 @@ public:
     return m_image->getHeight();
   }
 
-  std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const final {
-    auto chunk = UniversalImageChunk<T>::create(std::move(*m_image->getChunk(x, y, width, height)));
-    auto mask_chunk = m_mask->getChunk(x, y, width, height);
-    for (int iy = 0; iy < height; ++iy) {
-      for (int ix = 0; ix < width; ++ix) {
-        if (m_operator(mask_chunk->getValue(ix, iy), m_mask_flag))
-          chunk->setValue(ix, iy, m_replacement);
-      }
+  void evaluate(int x, int y, int width, int height, T* output) const final {
+    evaluateImage<T>(*m_image, x, y, width, height, output);
+    ScratchBuffer<M> mask_data(width * height);
+    evaluateImage<M>(*m_mask, x, y, width, height, mask_data.data());
+    for (int i = 0; i < width * height; ++i) {
+      if (m_operator(mask_data[i], m_mask_flag))
+        output[i] = m_replacement;
     }
-    return chunk;
   }
 
 };
@@ -22,6 +22,7 @@
 
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ConstantImage.h"
+#include "SEFramework/Image/FusedImage.h"
 #include "SEFramework/Image/VectorImage.h"
 
 namespace SourceXtractor {
@@ -33,7 +34,7 @@ namespace SourceXtractor {
  */
 
 template <typename T, typename P>
-class ProcessedImage : public Image<T> {
+class ProcessedImage : public FusedImage<T> {
 
 protected:
 
@@ -72,17 +73,13 @@ public:
     return m_image_a->getHeight();
   }
 
-  std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const override {
-    std::vector<T> new_chunk_data(width * height);
-    auto a_chunk = m_image_a->getChunk(x, y, width, height);
-    auto b_chunk = m_image_b->getChunk(x, y, width, height);
-    for (int iy = 0; iy < height; ++iy) {
-      for (int ix = 0; ix < width; ++ix) {
-        new_chunk_data[ix + iy * width] = P::process(a_chunk->getValue(ix, iy),
-                                                     b_chunk->getValue(ix, iy));
-      }
+  void evaluate(int x, int y, int width, int height, T* output) const override {
+    evaluateImage(*m_image_a, x, y, width, height, output);
+    ScratchBuffer<T> b_data(width * height);
+    evaluateImage(*m_image_b, x, y, width, height, b_data.data());
+    for (int i = 0; i < width * height; ++i) {
+      output[i] = P::process(output[i], b_data[i]);
     }
-    return UniversalImageChunk<T>::create(std::move(new_chunk_data), width, height);
   }
 
 private:
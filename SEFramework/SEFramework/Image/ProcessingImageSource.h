@@ -64,6 +64,11 @@ public:
     return ImageTile::getTypeValue(T());
   }
 
+  /// generateTile only reads the input images. Implementations keeping some state must protect it.
+  bool isReentrant() const override {
+    return true;
+  }
+
 protected:
   virtual void generateTile(const std::shared_ptr<Image<T>>& image, ImageTileWithType<T>& tile, int x, int y, int width, int height) const = 0;
 
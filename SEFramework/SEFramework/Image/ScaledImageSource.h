@@ -157,6 +157,11 @@ public:
     return ImageTile::getTypeValue(T());
   }
 
+  /// The interpolated columns are only evaluated
+  bool isReentrant() const override {
+    return true;
+  }
+
 private:
   std::shared_ptr<Image<T>> m_image;
   int m_width, m_height;
@@ -29,6 +29,7 @@
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ImageChunk.h"
 #include "SEFramework/Image/ConstantImage.h"
+#include "SEFramework/Image/FusedImage.h"
 
 namespace SourceXtractor {
 
@@ -38,7 +39,7 @@ namespace SourceXtractor {
  *
  */
 template <typename T>
-class ThresholdedImage : public Image<T> {
+class ThresholdedImage : public FusedImage<T> {
 
 protected:
 
@@ -72,16 +73,13 @@ public:
     return m_image->getHeight();
   }
 
-  std::shared_ptr<ImageChunk<T>> getChunk(int x, int y, int width, int height) const override{
-    auto img_chunk = m_image->getChunk(x, y, width, height);
-    auto var_chunk = m_variance_map->getChunk(x, y, width, height);
-    auto chunk = UniversalImageChunk<T>::create(std::move(*img_chunk));
-    for (int iy = 0; iy < height; ++iy) {
-      for (int ix = 0; ix < width; ++ix) {
-        chunk->at(ix, iy) -= sqrt(var_chunk->getValue(ix, iy)) * m_threshold_multiplier;
-      }
+  void evaluate(int x, int y, int width, int height, T* output) const override {
+    evaluateImage(*m_image, x, y, width, height, output);
+    ScratchBuffer<T> var_data(width * height);
+    evaluateImage(*m_variance_map, x, y, width, height, var_data.data());
+    for (int i = 0; i < width * height; ++i) {
+      output[i] -= sqrt(var_data[i]) * m_threshold_multiplier;
     }
-    return chunk;
   }
 
 private:
@@ -0,0 +1,153 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileBufferPool.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_IMAGE_TILEBUFFERPOOL_H_
+#define _SEFRAMEWORK_IMAGE_TILEBUFFERPOOL_H_
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+namespace SourceXtractor {
+
+/**
+ * @class TileBufferPool
+ * @brief Recycles the pixel buffers of the image tiles
+ *
+ * @details
+ * Tiles are loaded and evicted all the time, and most of them have the same size. Instead of freeing
+ * the buffer of an evicted tile, and allocating (and zeroing) a new one for the next tile, buffers are kept
+ * here, by pixel type and size, up to a memory limit. Recycled buffers are handed out as they are, without
+ * being cleared.
+ *
+ * Optionally, new buffers are advised to be backed by transparent huge pages, which reduces the
+ * number of page faults and TLB misses for big tiles.
+ */
+class TileBufferPool {
+public:
+
+  struct Statistics {
+    /// Buffers handed out from the pool
+    long m_reused;
+    /// Buffers that had to be allocated
+    long m_allocated;
+    /// Buffers freed because the pool was full
+    long m_discarded;
+    /// Memory held by the buffers in the pool, in bytes
+    long m_pooled_bytes;
+  };
+
+  /// Memory limit of the buffers kept in the pool, in bytes. 0 disables the pool
+  static void setMaxMemory(long max_memory);
+
+  static long getMaxMemory();
+
+  static void setHugePages(bool huge_pages);
+
+  static Statistics getStatistics();
+
+  /// Memory held by the buffers in the pool, in bytes
+  static long getPooledMemory();
+
+  /// Free all the buffers kept in the pool
+  static void clear();
+
+  /**
+   * @return A buffer of the given number of elements, with undefined content if recycled
+   */
+  template <typename T>
+  static std::vector<T> acquire(std::size_t size) {
+    auto& buffers = getBuffers<T>();
+    {
+      boost::lock_guard<boost::mutex> lock(buffers.m_mutex);
+      auto i = buffers.m_free.find(size);
+      if (i != buffers.m_free.end() && !i->second.empty()) {
+        std::vector<T> buffer = std::move(i->second.back());
+        i->second.pop_back();
+        s_pooled_bytes -= size * sizeof(T);
+        ++s_reused;
+        return buffer;
+      }
+    }
+
+    ++s_allocated;
+    std::vector<T> buffer;
+    // The advice must be given before the pages are touched
+    buffer.reserve(size);
+    if (s_huge_pages) {
+      adviseHugePages(buffer.data(), size * sizeof(T));
+    }
+    buffer.resize(size);
+    return buffer;
+  }
+
+  /**
+   * Give back a buffer that is not used anymore. It is freed if the pool is full.
+   */
+  template <typename T>
+  static void release(std::vector<T>&& buffer) {
+    long bytes = buffer.size() * sizeof(T);
+    if (bytes == 0) {
+      return;
+    }
+
+    auto& buffers = getBuffers<T>();
+    boost::lock_guard<boost::mutex> lock(buffers.m_mutex);
+    if (s_pooled_bytes + bytes > s_max_memory) {
+      ++s_discarded;
+      return;
+    }
+    s_pooled_bytes += bytes;
+    buffers.m_free[buffer.size()].emplace_back(std::move(buffer));
+  }
+
+private:
+
+  template <typename T>
+  struct Buffers {
+    boost::mutex m_mutex;
+    std::unordered_map<std::size_t, std::vector<std::vector<T>>> m_free;
+  };
+
+  template <typename T>
+  static Buffers<T>& getBuffers() {
+    // Never destroyed, as tiles may still be released while static objects are destroyed at exit
+    static Buffers<T>* buffers = new Buffers<T>;
+    return *buffers;
+  }
+
+  template <typename T>
+  static void clearBuffers();
+
+  static void adviseHugePages(void* data, std::size_t bytes);
+
+  static std::atomic<long> s_max_memory, s_pooled_bytes;
+  static std::atomic<long> s_reused, s_allocated, s_discarded;
+  static std::atomic<bool> s_huge_pages;
+};
+
+} /* namespace SourceXtractor */
+
+#endif /* _SEFRAMEWORK_IMAGE_TILEBUFFERPOOL_H_ */
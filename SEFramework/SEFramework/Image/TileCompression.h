@@ -0,0 +1,49 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileCompression.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEFRAMEWORK_IMAGE_TILECOMPRESSION_H_
+#define _SEFRAMEWORK_IMAGE_TILECOMPRESSION_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace SourceXtractor {
+
+/**
+ * Compress count elements of element_size bytes, favoring speed over ratio.
+ *
+ * The bytes of the elements are first shuffled into planes (all the first bytes, then all the second bytes...),
+ * so the sign and exponent bytes of neighbouring pixels, which are usually similar, end up next to each other.
+ * The planes are then compressed with a byte oriented LZ77 coder, similar to LZ4.
+ * Data that does not compress is stored as it is, so the output is never much bigger than the input.
+ */
+std::vector<unsigned char> compressTileData(const void* data, std::size_t element_size, std::size_t count);
+
+/**
+ * Restore into output the count elements of element_size bytes compressed by compressTileData
+ */
+void decompressTileData(const std::vector<unsigned char>& compressed, std::size_t element_size, std::size_t count,
+                        void* output);
+
+} /* namespace SourceXtractor */
+
+#endif /* _SEFRAMEWORK_IMAGE_TILECOMPRESSION_H_ */
@@ -24,12 +24,20 @@
 #ifndef _SEFRAMEWORK_IMAGE_TILEMANAGER_H_
 #define _SEFRAMEWORK_IMAGE_TILEMANAGER_H_
 
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iostream>
 #include <thread>
 #include <list>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include <ElementsKernel/Logging.h>
 
@@ -38,9 +46,13 @@
 
 namespace SourceXtractor {
 
-
+/**
+ * Identifies a tile within the cache. The source is kept as a raw pointer so lookups
+ * do not need to touch any reference count: ownership of the source is held by the cache entry
+ * instead, which guarantees the address can not be reused while the tile is cached.
+ */
 struct TileKey {
-  std::shared_ptr<const ImageSource> m_source;
+  const ImageSource* m_source;
   int m_tile_x, m_tile_y;
 
   bool operator==(const TileKey& other) const;
@@ -72,50 +84,291 @@ struct hash<SourceXtractor::TileKey> {
 
 namespace SourceXtractor {
 
+/**
+ * Keeps in memory the image tiles loaded from the different image sources, up to a
+ * maximum amount of memory.
+ *
+ * The cache is split in a number of shards, each one protected by its own lock and with its own
+ * share of the memory budget, so threads working on different tiles rarely contend.
+ * Within a shard, tiles are evicted in least-recently-used order: a cache hit moves the tile
+ * to the front of the list.
+ *
+ * Modified tiles are not written when evicted, but handed to a background thread that writes them in batches,
+ * sorted by source and position, so the evicting thread does not wait for the I/O and the sources can group
+ * the writes. Until written, they are still served from memory if requested again.
+ *
+ * The buffers of evicted tiles are recycled through the TileBufferPool. The memory they can hold while idle is
+ * set aside from the memory limit.
+ *
+ * Optionally, tiles evicted without having been modified can be kept compressed in a second tier, with its own
+ * memory budget. Restoring them is much cheaper than reading them again from their source.
+ *
+ * Optionally, a background thread can read ahead regions that callers with a predictable traversal
+ * order (i.e. segmentation) hint they will need soon, overlapping the I/O with their own work.
+ *
+ * Optionally, the regions a thread reads while inside a Sweep can be read straight from their sources instead,
+ * so a single pass over an image larger than the cache does not evict everything else on its way.
+ *
+ * The cache activity is also counted per source, grouped by their representation, so it is possible to tell
+ * which layer of the processing is causing tiles to be read again. The table is logged on flush.
+ */
 class TileManager {
 public:
 
+  /// Number of tile requests served by each tier since the last flush
+  struct Statistics {
+    long m_memory_hits;
+    long m_compressed_hits;
+    long m_source_reads;
+  };
+
+  /// Cache activity for the tiles of all the sources with the same representation, since the last flush
+  struct SourceStatistics {
+    std::string m_repr;
+    // Requests served from memory (either tier), and requests that had to go to the source
+    long m_hits, m_misses;
+    // Tiles evicted from the memory tier
+    long m_evictions;
+    long m_bytes_read, m_bytes_written;
+    // Seconds spent in ImageSource::getImageTile, including the time spent reading the tiles of the sources it uses
+    double m_read_time;
+  };
+
+  /**
+   * While an instance is alive, and the streaming is enabled, the chunks the current thread gets from
+   * BufferedImage are read straight from their source, and not kept in the cache: their pixels are released
+   * as soon as the caller drops them. Meant for the passes that visit each region of an image exactly once.
+   * The sources read this way must not have modified tiles in the cache.
+   */
+  class Sweep {
+  public:
+    Sweep();
+    ~Sweep();
+    Sweep(const Sweep&) = delete;
+    Sweep& operator=(const Sweep&) = delete;
+  };
+
   TileManager();
 
   virtual ~TileManager();
 
-  // Actually not thread safe, call before starting the multi-threading
-  void setOptions(int tile_width, int tile_height, int max_memory);
+  /**
+   * Actually not thread safe, call before starting the multi-threading
+   * @param max_memory
+   *    Memory limit for the uncompressed tiles, in MB
+   * @param read_ahead
+   *    Maximum number of read-ahead requests queued, 0 disables the read-ahead
+   * @param max_compressed_memory
+   *    Memory limit for the compressed tiles, in MB. 0 disables the compressed tier
+   */
+  void setOptions(int tile_width, int tile_height, int max_memory, int read_ahead = 0, int max_compressed_memory = 0);
 
   void flush();
 
   std::shared_ptr<ImageTile>
-  getTileForPixel(int x, int y, std::shared_ptr<const ImageSource> source);
+  getTileForPixel(int x, int y, const std::shared_ptr<const ImageSource>& source);
 
   static std::shared_ptr<TileManager> getInstance();
 
+  /// Write all the modified tiles, cached or waiting to be written back, and wait until it is done
   void saveAllTiles();
 
   int getTileWidth() const;
 
   int getTileHeight() const;
 
+  /**
+   * Size of the tiles of the given source. If the source has a native tile size, the configured size
+   * is aligned to it, keeping about the same area. Otherwise, it is the configured size.
+   */
+  int getTileWidth(const ImageSource& source) const;
+
+  int getTileHeight(const ImageSource& source) const;
+
+  /// Number of regions ahead of the current position a caller should hint, 0 if the read-ahead is disabled
+  int getReadAhead() const;
+
+  /// Enables or disables the reads that bypass the cache inside a Sweep. Call before starting the multi-threading
+  void setStreaming(bool streaming);
+
+  bool isStreaming() const;
+
+  /// True if the current thread is inside a Sweep, and the streaming is enabled
+  bool isSweeping() const;
+
+  /// Reads the region from the source without going through the cache. It is still counted as a miss
+  std::shared_ptr<ImageTile> readRegion(const std::shared_ptr<const ImageSource>& source,
+                                        int x, int y, int width, int height);
+
+  Statistics getStatistics() const;
+
+  /// Statistics per source, sorted by decreasing number of misses
+  std::vector<SourceStatistics> getSourceStatistics() const;
+
+  /**
+   * Hint that the given region of the image is going to be accessed soon. The chunk is requested from
+   * the background thread and discarded, so the tiles of every source the image depends on end up in the cache.
+   * The image is kept alive until the request is served or dropped.
+   * If the read-ahead falls behind, the oldest requests are dropped, as their caller is probably already there.
+   */
+  template <typename TImage>
+  void prefetch(std::shared_ptr<TImage> image, int x, int y, int width, int height) {
+    if (m_read_ahead <= 0) {
+      return;
+    }
+    int end_x = std::min(x + width, image->getWidth());
+    int end_y = std::min(y + height, image->getHeight());
+    x = std::max(x, 0);
+    y = std::max(y, 0);
+    if (end_x <= x || end_y <= y) {
+      return;
+    }
+    queueReadAhead([image, x, y, end_x, end_y]() {
+      image->getChunk(x, y, end_x - x, end_y - y);
+    });
+  }
+
 private:
 
-  std::shared_ptr<ImageTile> tryTileFromCache(const TileKey& key);
+  // Shared by all the sources with the same representation, and updated without any lock held
+  struct SourceCounters {
+    std::atomic<long> m_hits{0}, m_misses{0}, m_evictions{0};
+    std::atomic<long> m_bytes_read{0}, m_bytes_written{0};
+    std::atomic<long> m_read_nanoseconds{0};
+  };
 
-  std::shared_ptr<boost::mutex>& getMutexForImageSource(const ImageSource*);
+  struct TileEntry {
+    // Keeps the source alive while any of its tiles are cached
+    std::shared_ptr<const ImageSource> m_source;
+    std::shared_ptr<ImageTile> m_tile;
+    std::list<TileKey>::iterator m_lru_position;
+    std::shared_ptr<SourceCounters> m_counters;
+  };
 
-  void removeTile(TileKey tile_key);
+  struct CompressedTileEntry {
+    std::shared_ptr<const ImageSource> m_source;
+    std::shared_ptr<SourceCounters> m_counters;
+    ImageTile::ImageType m_type;
+    int m_width, m_height;
+    std::vector<unsigned char> m_data;
+    std::list<TileKey>::iterator m_lru_position;
+  };
 
-  void removeExtraTiles();
+  struct SourceCountersEntry {
+    // Tells whether the address still belongs to the same source, without keeping it alive
+    std::weak_ptr<const ImageSource> m_source;
+    std::shared_ptr<SourceCounters> m_counters;
+  };
 
-  void addTile(TileKey key, std::shared_ptr<ImageTile> tile);
+  struct Shard {
+    boost::mutex m_mutex;
+    // Signaled when a tile that was being loaded by some thread is available (or failed)
+    boost::condition_variable m_tile_loaded;
 
-  int m_tile_width, m_tile_height;
-  long m_max_memory;
-  long m_total_memory_used;
+    std::unordered_map<TileKey, TileEntry> m_tile_map;
+    // Most recently used at the front
+    std::list<TileKey> m_lru_list;
+    // Tiles being read from their source, without any lock held
+    std::unordered_set<TileKey> m_loading;
+
+    long m_max_memory;
+    long m_memory_used;
+
+    // Second tier, with its own LRU order
+    std::unordered_map<TileKey, CompressedTileEntry> m_compressed_map;
+    std::list<TileKey> m_compressed_lru_list;
+    long m_max_compressed_memory;
+    long m_compressed_memory_used;
+
+    // Unmodified tiles evicted from the first tier, waiting to be compressed without the lock held
+    std::vector<std::pair<TileKey, TileEntry>> m_evicted;
+
+    // Modified tiles evicted from the first tier, waiting to be written back (m_lru_position is not used)
+    std::unordered_map<TileKey, TileEntry> m_dirty_map;
+
+    // Counters of the sources read through this shard, so a miss does not look them up by representation
+    std::unordered_map<const ImageSource*, SourceCountersEntry> m_source_counters;
+  };
+
+  Shard& getShard(const TileKey& key);
 
-  std::unordered_map<TileKey, std::shared_ptr<ImageTile>> m_tile_map;
-  std::unordered_map<const ImageSource*, std::shared_ptr<boost::mutex>> m_mutex_map;
-  std::list<TileKey> m_tile_list;
+  void createShards();
 
-  boost::shared_mutex m_mutex;
+  void removeTile(Shard& shard, std::list<TileKey>::iterator lru_position);
+
+  void removeExtraTiles(Shard& shard);
+
+  void addTile(Shard& shard, const TileKey& key, const std::shared_ptr<const ImageSource>& source,
+               std::shared_ptr<ImageTile> tile, std::shared_ptr<SourceCounters> counters);
+
+  std::shared_ptr<SourceCounters> getSourceCounters(const ImageSource& source);
+
+  /// Same, but cached in the shard. Called with its lock held
+  std::shared_ptr<SourceCounters> getSourceCounters(Shard& shard, const std::shared_ptr<const ImageSource>& source);
+
+  std::shared_ptr<ImageTile> readFromSource(const ImageSource& source, SourceCounters& counters,
+                                            int x, int y, int width, int height);
+
+  std::shared_ptr<boost::mutex> getMutexForImageSource(const ImageSource* source);
+
+  void logSourceStatistics() const;
+
+  std::shared_ptr<ImageTile> decompressTile(const TileKey& key, const CompressedTileEntry& entry);
+
+  void compressEvictedTiles(Shard& shard, boost::unique_lock<boost::mutex>& lock);
+
+  void removeCompressedTile(Shard& shard, std::list<TileKey>::iterator lru_position);
+
+  /// Writes the tiles, grouped by source. The tiles that could not be written are moved to the end, and
+  /// marked as modified again
+  /// @return The position of the first one
+  std::vector<std::pair<TileKey, TileEntry>>::iterator writeTiles(std::vector<std::pair<TileKey, TileEntry>>& tiles);
+
+  void writeBack();
+
+  void writeBackLoop();
+
+  void throttleWriteBack();
+
+  void stopWriteBack();
+
+  void queueReadAhead(std::function<void()> request);
+
+  void readAheadLoop();
+
+  void stopReadAhead();
+
+  int m_tile_width, m_tile_height;
+  long m_max_memory, m_max_compressed_memory;
+
+  std::vector<std::unique_ptr<Shard>> m_shards;
+
+  int m_read_ahead;
+  bool m_streaming;
+  std::thread m_read_ahead_thread;
+  boost::mutex m_read_ahead_mutex;
+  boost::condition_variable m_read_ahead_queued, m_read_ahead_idle;
+  std::deque<std::function<void()>> m_read_ahead_queue;
+  bool m_read_ahead_busy, m_read_ahead_stop;
+
+  std::atomic<long> m_memory_hits, m_compressed_hits, m_source_reads;
+
+  mutable boost::mutex m_counters_mutex;
+  std::map<std::string, std::shared_ptr<SourceCounters>> m_source_counters;
+
+  // Serialize the reads of the sources that are not re-entrant
+  boost::mutex m_source_mutexes_mutex;
+  std::unordered_map<const ImageSource*, std::shared_ptr<boost::mutex>> m_source_mutexes;
+
+  std::thread m_write_back_thread;
+  boost::mutex m_write_back_mutex;
+  boost::condition_variable m_write_back_queued, m_write_back_idle;
+  bool m_write_back_busy, m_write_back_stop;
+  // Memory used by the modified tiles evicted and not written yet
+  std::atomic<long> m_dirty_memory;
+  // First error raised while writing in the background, reported by saveAllTiles. The tiles that failed
+  // are kept, but the background thread does not retry until then
+  std::exception_ptr m_write_back_error;
 };
 
 }
@@ -151,6 +151,19 @@ public:
     return *m_data;
   }
 
+  /**
+   * Move the pixel values out, so the buffer can be reused, unless they are still shared with a chunk.
+   * The image must not be used afterwards.
+   * @return true if the values have been moved into output
+   */
+  bool releaseData(std::vector<T>& output) {
+    if (m_data.use_count() != 1) {
+      return false;
+    }
+    output = std::move(*m_data);
+    return true;
+  }
+
   /**
    * @brief Destructor
    */
@@ -76,6 +76,9 @@ FluxMeasurement measureFlux(const std::shared_ptr<Aperture> &aperture, SeFloat c
 
   // iterate over the aperture pixels
   for (int pixel_y = 0; pixel_y < img_cutout->getHeight(); pixel_y++) {
+    const SeFloat* img_row = img_cutout->getRowSpan(pixel_y);
+    const SeFloat* var_row = var_cutout->getRowSpan(pixel_y);
+
     for (int pixel_x = 0; pixel_x < img_cutout->getWidth(); pixel_x++) {
       SeFloat pixel_value = 0;
       SeFloat pixel_variance = 0;
@@ -89,7 +92,7 @@ FluxMeasurement measureFlux(const std::shared_ptr<Aperture> &aperture, SeFloat c
 
       measurement.m_total_area += area;
 
-      SeFloat variance_tmp = var_cutout->getValue(pixel_x, pixel_y);
+      SeFloat variance_tmp = var_row[pixel_x];
       if (variance_tmp > variance_threshold) {
         measurement.m_bad_area += 1;
         if (use_symmetry) {
@@ -100,7 +103,7 @@ FluxMeasurement measureFlux(const std::shared_ptr<Aperture> &aperture, SeFloat c
         }
       }
       else {
-        pixel_value = img_cutout->getValue(pixel_x, pixel_y);
+        pixel_value = img_row[pixel_x];
         pixel_variance = variance_tmp;
       }
 
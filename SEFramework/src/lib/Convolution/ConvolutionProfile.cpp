@@ -0,0 +1,207 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * ConvolutionProfile.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "SEFramework/Convolution/ConvolutionProfile.h"
+#include "SEFramework/Convolution/DFT.h"
+#include "SEFramework/Convolution/DirectConvolution.h"
+
+namespace SourceXtractor {
+
+static const std::string profile_header{"# Convolution profile"};
+
+static std::mutex s_instance_mutex;
+static std::shared_ptr<const ConvolutionProfile> s_instance;
+
+ConvolutionProfile::ConvolutionProfile() : m_cpu(getCpuIdentifier()) {
+}
+
+std::shared_ptr<const ConvolutionProfile> ConvolutionProfile::getInstance() {
+  std::lock_guard<std::mutex> lock(s_instance_mutex);
+  if (s_instance == nullptr) {
+    s_instance = std::make_shared<ConvolutionProfile>();
+  }
+  return s_instance;
+}
+
+void ConvolutionProfile::setInstance(std::shared_ptr<const ConvolutionProfile> profile) {
+  std::lock_guard<std::mutex> lock(s_instance_mutex);
+  s_instance = std::move(profile);
+}
+
+std::string ConvolutionProfile::getCpuIdentifier() {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (boost::starts_with(line, "model name")) {
+      auto colon = line.find(':');
+      if (colon != std::string::npos) {
+        return boost::trim_copy(line.substr(colon + 1));
+      }
+    }
+  }
+  return "unknown";
+}
+
+template <typename Func>
+static double timeBest(int repeat, Func&& func) {
+  double best = std::numeric_limits<double>::max();
+  for (int r = 0; r < repeat; ++r) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+static std::shared_ptr<VectorImage<SeFloat>> randomImage(std::default_random_engine& generator, int size) {
+  std::uniform_real_distribution<SeFloat> distribution{0, 1};
+  auto image = VectorImage<SeFloat>::create(size, size);
+  for (auto& v : image->getData()) {
+    v = distribution(generator);
+  }
+  return image;
+}
+
+std::shared_ptr<ConvolutionProfile> ConvolutionProfile::calibrate(const std::vector<int>& image_sizes,
+                                                                  const std::vector<int>& kernel_sizes) {
+  const int repeat = 3;
+  std::default_random_engine generator;
+  auto profile = std::make_shared<ConvolutionProfile>();
+
+  for (int image_size : image_sizes) {
+    auto image = randomImage(generator, image_size);
+    for (int kernel_size : kernel_sizes) {
+      if (kernel_size > image_size) {
+        continue;
+      }
+      auto kernel = randomImage(generator, kernel_size);
+
+      // Callers reuse the kernel transform, so it is not part of the measure
+      DirectConvolution<SeFloat> direct(kernel, 0);
+      DFTConvolution<SeFloat> dft(kernel);
+      auto context = dft.prepare(image);
+
+      auto copy = VectorImage<SeFloat>::create(*image);
+      double direct_time = timeBest(repeat, [&]() { direct.convolve(copy); });
+      double dft_time = timeBest(repeat, [&]() { dft.convolve(copy, context); });
+
+      profile->m_measures.emplace_back(Measure{image_size, kernel_size, direct_time, dft_time});
+    }
+  }
+  return profile;
+}
+
+std::shared_ptr<ConvolutionProfile> ConvolutionProfile::load(const std::string& path) {
+  std::ifstream input(path);
+  std::string line;
+  if (!std::getline(input, line) || line != profile_header) {
+    return nullptr;
+  }
+
+  auto profile = std::make_shared<ConvolutionProfile>();
+  if (!std::getline(input, line) || line != "cpu " + profile->m_cpu) {
+    return nullptr;
+  }
+
+  while (std::getline(input, line)) {
+    std::istringstream fields(line);
+    Measure measure;
+    if (!(fields >> measure.image_size >> measure.kernel_size >> measure.direct_time >> measure.dft_time)) {
+      return nullptr;
+    }
+    profile->m_measures.emplace_back(measure);
+  }
+  if (!profile->isCalibrated()) {
+    return nullptr;
+  }
+  return profile;
+}
+
+bool ConvolutionProfile::save(const std::string& path) const {
+  // Several processes may share the profile, so write it aside and move it into place
+  boost::system::error_code error;
+  auto tmp_path = boost::filesystem::unique_path(boost::filesystem::path(path + ".%%%%%%"), error);
+  if (error) {
+    return false;
+  }
+  {
+    std::ofstream output(tmp_path.native());
+    output << profile_header << '\n' << "cpu " << m_cpu << '\n';
+    output.precision(std::numeric_limits<double>::max_digits10);
+    for (auto& measure : m_measures) {
+      output << measure.image_size << ' ' << measure.kernel_size << ' '
+             << measure.direct_time << ' ' << measure.dft_time << '\n';
+    }
+    if (!output.flush()) {
+      boost::filesystem::remove(tmp_path, error);
+      return false;
+    }
+  }
+  boost::filesystem::rename(tmp_path, path, error);
+  if (error) {
+    boost::filesystem::remove(tmp_path, error);
+    return false;
+  }
+  return true;
+}
+
+auto ConvolutionProfile::select(int image_width, int image_height, int kernel_width,
+                                int kernel_height) const -> Engine {
+  if (!isCalibrated()) {
+    return selectFixed(kernel_width, kernel_height);
+  }
+  int kernel_size = std::max(kernel_width, kernel_height);
+
+  // Nearest measure, on a logarithmic scale
+  double image_size = std::sqrt(static_cast<double>(image_width) * image_height);
+  const Measure* nearest = nullptr;
+  double nearest_distance = std::numeric_limits<double>::max();
+  for (auto& measure : m_measures) {
+    double di = std::log2(image_size / measure.image_size);
+    double dk = std::log2(static_cast<double>(kernel_size) / measure.kernel_size);
+    double distance = di * di + dk * dk;
+    if (distance < nearest_distance) {
+      nearest_distance = distance;
+      nearest = &measure;
+    }
+  }
+  return nearest->direct_time <= nearest->dft_time ? Engine::DIRECT : Engine::DFT;
+}
+
+auto ConvolutionProfile::selectFixed(int kernel_width, int kernel_height) -> Engine {
+  return std::max(kernel_width, kernel_height) > 5 ? Engine::DFT : Engine::DIRECT;
+}
+
+} // end SourceXtractor
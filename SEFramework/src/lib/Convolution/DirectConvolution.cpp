@@ -0,0 +1,90 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * DirectConvolution.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+
+#include "SEFramework/Convolution/DirectConvolution.h"
+
+// Build the correlation for several instruction sets, the loader picks the best one for the CPU.
+// The target of the clones does not apply to the functions they call, so those are inlined into each clone
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define DIRECT_CONVOLUTION_CLONES __attribute__((target_clones("avx512f", "avx2", "default"), flatten))
+#else
+#define DIRECT_CONVOLUTION_CLONES
+#endif
+
+namespace SourceXtractor {
+
+// Number of output pixels accumulated at once. They stay in registers (or at least in L1)
+// while all the taps of the kernel are applied
+static constexpr int direct_block_size = 64;
+
+template <typename T>
+static inline void correlateBlock(const T* kernel, int kernel_width, int kernel_height,
+                                  const T* in, int in_stride, T* out, int n) {
+  T acc[direct_block_size] = {};
+  for (int ky = 0; ky < kernel_height; ++ky) {
+    const T* in_row = in + ky * in_stride;
+    const T* kernel_row = kernel + ky * kernel_width;
+    for (int kx = 0; kx < kernel_width; ++kx) {
+      const T k = kernel_row[kx];
+      const T* src = in_row + kx;
+      // A constant trip count lets the compiler vectorize without a remainder loop
+      if (n == direct_block_size) {
+        for (int i = 0; i < direct_block_size; ++i) {
+          acc[i] += k * src[i];
+        }
+      }
+      else {
+        for (int i = 0; i < n; ++i) {
+          acc[i] += k * src[i];
+        }
+      }
+    }
+  }
+  std::copy(acc, acc + n, out);
+}
+
+template <typename T>
+static inline void correlate(const T* kernel, int kernel_width, int kernel_height,
+                             const T* in, int in_stride, T* out, int out_stride, int out_width, int out_height) {
+  for (int y = 0; y < out_height; ++y) {
+    for (int x = 0; x < out_width; x += direct_block_size) {
+      correlateBlock(kernel, kernel_width, kernel_height, in + y * in_stride + x, in_stride, out + y * out_stride + x,
+                     std::min(direct_block_size, out_width - x));
+    }
+  }
+}
+
+DIRECT_CONVOLUTION_CLONES
+void directCorrelate(const float* kernel, int kernel_width, int kernel_height,
+                     const float* in, int in_stride, float* out, int out_stride, int out_width, int out_height) {
+  correlate(kernel, kernel_width, kernel_height, in, in_stride, out, out_stride, out_width, out_height);
+}
+
+DIRECT_CONVOLUTION_CLONES
+void directCorrelate(const double* kernel, int kernel_width, int kernel_height,
+                     const double* in, int in_stride, double* out, int out_stride, int out_width, int out_height) {
+  correlate(kernel, kernel_width, kernel_height, in, in_stride, out, out_stride, out_width, out_height);
+}
+
+} // end SourceXtractor
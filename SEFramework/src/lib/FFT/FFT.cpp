@@ -21,10 +21,16 @@
  */
 
 #include "SEFramework/FFT/FFT.h"
+#include <boost/filesystem/operations.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
+#include <deque>
 #include <fftw3.h>
+#include <fstream>
 #include <map>
+#include <sstream>
 
 namespace SourceXtractor {
 
@@ -34,14 +40,31 @@ namespace SourceXtractor {
  */
 boost::mutex fftw_global_plan_mutex{};
 
+/**
+ * Planning flags for the new plans
+ */
+static std::atomic<unsigned> fftw_planning_rigor{FFTW_ESTIMATE};
+
+/**
+ * Number of work areas kept by each thread, of any size, for reuse
+ */
+static const std::size_t fftw_pooled_work_areas = 16;
+
+// The wisdom of both precisions is stored in the same file, one after the other, and each starts a line with this
+static const std::string fftw_wisdom_header{"(fftw-"};
+
 typename FFTTraits<float>::func_plan_fwd_t*     FFTTraits<float>::func_plan_fwd{fftwf_plan_dft_r2c_2d};
 typename FFTTraits<float>::func_plan_inv_t*     FFTTraits<float>::func_plan_inv{fftwf_plan_dft_c2r_2d};
+typename FFTTraits<float>::func_plan_many_fwd_t* FFTTraits<float>::func_plan_many_fwd{fftwf_plan_many_dft_r2c};
+typename FFTTraits<float>::func_plan_many_inv_t* FFTTraits<float>::func_plan_many_inv{fftwf_plan_many_dft_c2r};
 typename FFTTraits<float>::func_destroy_plan_t* FFTTraits<float>::func_destroy_plan{fftwf_destroy_plan};
 typename FFTTraits<float>::func_execute_fwd_t*  FFTTraits<float>::func_execute_fwd{fftwf_execute_dft_r2c};
 typename FFTTraits<float>::func_execute_inv_t*  FFTTraits<float>::func_execute_inv{fftwf_execute_dft_c2r};
 
 typename FFTTraits<double>::func_plan_fwd_t*     FFTTraits<double>::func_plan_fwd{fftw_plan_dft_r2c_2d};
 typename FFTTraits<double>::func_plan_inv_t*     FFTTraits<double>::func_plan_inv{fftw_plan_dft_c2r_2d};
+typename FFTTraits<double>::func_plan_many_fwd_t* FFTTraits<double>::func_plan_many_fwd{fftw_plan_many_dft_r2c};
+typename FFTTraits<double>::func_plan_many_inv_t* FFTTraits<double>::func_plan_many_inv{fftw_plan_many_dft_c2r};
 typename FFTTraits<double>::func_destroy_plan_t* FFTTraits<double>::func_destroy_plan{fftw_destroy_plan};
 typename FFTTraits<double>::func_execute_fwd_t*  FFTTraits<double>::func_execute_fwd{fftw_execute_dft_r2c};
 typename FFTTraits<double>::func_execute_inv_t*  FFTTraits<double>::func_execute_inv{fftw_execute_dft_c2r};
@@ -107,8 +130,74 @@ int fftRoundDimension(int size) {
   return (size / 512 + (size % 512 != 0)) * 512;
 }
 
+void fftSetPlanningRigor(unsigned rigor) {
+  fftw_planning_rigor = rigor;
+}
+
+unsigned fftGetPlanningRigor() {
+  return fftw_planning_rigor;
+}
+
+bool fftImportWisdom(const std::string& path) {
+  std::ifstream input(path);
+  std::stringstream content;
+  content << input.rdbuf();
+  if (!input) {
+    return false;
+  }
+
+  auto wisdom = content.str();
+  auto second = wisdom.find("\n" + fftw_wisdom_header);
+  if (second == std::string::npos) {
+    return false;
+  }
+
+  // Importing the wisdom is not thread safe either
+  boost::lock_guard<boost::mutex> lock_planner{fftw_global_plan_mutex};
+  return fftw_import_wisdom_from_string(wisdom.substr(0, second + 1).c_str()) &&
+         fftwf_import_wisdom_from_string(wisdom.substr(second + 1).c_str());
+}
+
+bool fftExportWisdom(const std::string& path) {
+  std::string wisdom;
+  {
+    boost::lock_guard<boost::mutex> lock_planner{fftw_global_plan_mutex};
+    char* double_wisdom = fftw_export_wisdom_to_string();
+    char* float_wisdom = fftwf_export_wisdom_to_string();
+    if (double_wisdom && float_wisdom) {
+      wisdom = std::string(double_wisdom) + "\n" + std::string(float_wisdom);
+    }
+    std::free(double_wisdom);
+    std::free(float_wisdom);
+  }
+  if (wisdom.empty()) {
+    return false;
+  }
+
+  boost::system::error_code error;
+  auto tmp_path = boost::filesystem::path(path + ".%%%%%%");
+  tmp_path = boost::filesystem::unique_path(tmp_path, error);
+  if (error) {
+    return false;
+  }
+  {
+    std::ofstream output(tmp_path.native());
+    output << wisdom;
+    if (!output.flush()) {
+      boost::filesystem::remove(tmp_path, error);
+      return false;
+    }
+  }
+  boost::filesystem::rename(tmp_path, path, error);
+  if (error) {
+    boost::filesystem::remove(tmp_path, error);
+    return false;
+  }
+  return true;
+}
+
 template <typename T>
-auto FFT<T>::createForwardPlan(int width, int height, std::vector<T>& inout) -> plan_ptr_t {
+auto FFT<T>::createForwardPlan(int width, int height, work_area_t& inout) -> plan_ptr_t {
   int phy_height = height;
   int phy_width  = 2 * (width / 2 + 1);
   int mem_size = phy_height * phy_width;
@@ -139,7 +228,57 @@ auto FFT<T>::createForwardPlan(int width, int height, std::vector<T>& inout) ->
       fftw_traits::func_plan_fwd(
           height, width, // n0, n1
           inout.data(), reinterpret_cast<complex_t*>(inout.data()), // in, out
-          FFTW_ESTIMATE | FFTW_DESTROY_INPUT // flags
+          fftw_planning_rigor | FFTW_DESTROY_INPUT // flags
+        ),
+        fftw_traits::func_destroy_plan}
+  ).first;
+
+  return pi->second;
+}
+
+template <typename T>
+auto FFT<T>::createForwardPlan(int width, int height, int howmany, work_area_t& inout) -> plan_ptr_t {
+  if (howmany == 1) {
+    return createForwardPlan(width, height, inout);
+  }
+
+  int phy_width  = 2 * (width / 2 + 1);
+  int dist = height * phy_width;
+  int mem_size = dist * howmany;
+
+  // Make sure the buffers are big enough
+  if (inout.size() < mem_size) {
+    inout.resize(mem_size);
+  }
+
+  // Cache plan, as they can be reused
+  static boost::shared_mutex                             mutex;
+  static std::map<std::tuple<int, int, int>, plan_ptr_t> plan_cache;
+
+  boost::upgrade_lock<boost::shared_mutex> read_lock{mutex};
+
+  auto pi = plan_cache.find(std::make_tuple(width, height, howmany));
+  if (pi != plan_cache.end()) {
+    return pi->second;
+  }
+
+  // No available plan yet, so get one from FFTW
+  boost::upgrade_to_unique_lock<boost::shared_mutex> write_lock{read_lock};
+  boost::lock_guard<boost::mutex>                    lock_planner{fftw_global_plan_mutex};
+
+  // Same in-place layout as the single transforms: rows padded to phy_width reals, or width / 2 + 1 complex
+  int n[] = {height, width};
+  int real_embed[] = {height, phy_width};
+  int complex_embed[] = {height, width / 2 + 1};
+
+  pi = plan_cache.emplace(
+    std::make_tuple(width, height, howmany),
+    plan_ptr_t{
+      fftw_traits::func_plan_many_fwd(
+          2, n, howmany,
+          inout.data(), real_embed, 1, dist, // in
+          reinterpret_cast<complex_t*>(inout.data()), complex_embed, 1, dist / 2, // out
+          fftw_planning_rigor | FFTW_DESTROY_INPUT // flags
         ),
         fftw_traits::func_destroy_plan}
   ).first;
@@ -148,7 +287,7 @@ auto FFT<T>::createForwardPlan(int width, int height, std::vector<T>& inout) ->
 }
 
 template <typename T>
-auto FFT<T>::createInversePlan(int width, int height, std::vector<T>& inout) -> plan_ptr_t {
+auto FFT<T>::createInversePlan(int width, int height, work_area_t& inout) -> plan_ptr_t {
   int phy_height = height;
   int phy_width  = 2 * (width / 2 + 1);
   int mem_size = phy_height * phy_width;
@@ -179,7 +318,7 @@ auto FFT<T>::createInversePlan(int width, int height, std::vector<T>& inout) ->
       fftw_traits::func_plan_inv(
         height, width,       // n0, n1
         reinterpret_cast<complex_t*>(inout.data()), inout.data(),  // in, out
-        FFTW_ESTIMATE | FFTW_DESTROY_INPUT // flags
+        fftw_planning_rigor | FFTW_DESTROY_INPUT // flags
       ),
       fftw_traits::func_destroy_plan}
  ).first;
@@ -188,15 +327,93 @@ auto FFT<T>::createInversePlan(int width, int height, std::vector<T>& inout) ->
 }
 
 template <typename T>
-void FFT<T>::executeForward(plan_ptr_t& plan, std::vector<T>& inout) {
+auto FFT<T>::createInversePlan(int width, int height, int howmany, work_area_t& inout) -> plan_ptr_t {
+  if (howmany == 1) {
+    return createInversePlan(width, height, inout);
+  }
+
+  int phy_width  = 2 * (width / 2 + 1);
+  int dist = height * phy_width;
+  int mem_size = dist * howmany;
+
+  // Make sure the buffers are big enough
+  if (inout.size() < mem_size) {
+    inout.resize(mem_size);
+  }
+
+  // Cache plan, as they can be reused
+  static boost::shared_mutex                             mutex;
+  static std::map<std::tuple<int, int, int>, plan_ptr_t> plan_cache;
+
+  boost::upgrade_lock<boost::shared_mutex> read_lock{mutex};
+
+  auto pi = plan_cache.find(std::make_tuple(width, height, howmany));
+  if (pi != plan_cache.end()) {
+    return pi->second;
+  }
+
+  // No available plan yet, so get one from FFTW
+  boost::upgrade_to_unique_lock<boost::shared_mutex> write_lock{read_lock};
+  boost::lock_guard<boost::mutex>                    lock_planner{fftw_global_plan_mutex};
+
+  int n[] = {height, width};
+  int real_embed[] = {height, phy_width};
+  int complex_embed[] = {height, width / 2 + 1};
+
+  pi = plan_cache.emplace(
+    std::make_tuple(width, height, howmany),
+    plan_ptr_t{
+      fftw_traits::func_plan_many_inv(
+          2, n, howmany,
+          reinterpret_cast<complex_t*>(inout.data()), complex_embed, 1, dist / 2, // in
+          inout.data(), real_embed, 1, dist, // out
+          fftw_planning_rigor | FFTW_DESTROY_INPUT // flags
+        ),
+        fftw_traits::func_destroy_plan}
+  ).first;
+
+  return pi->second;
+}
+
+template <typename T>
+void FFT<T>::executeForward(plan_ptr_t& plan, work_area_t& inout) {
   fftw_traits::func_execute_fwd(plan.get(), inout.data(), reinterpret_cast<complex_t*>(inout.data()));
 }
 
 template <typename T>
-void FFT<T>::executeInverse(plan_ptr_t& plan, std::vector<T>& inout) {
+void FFT<T>::executeInverse(plan_ptr_t& plan, work_area_t& inout) {
   fftw_traits::func_execute_inv(plan.get(), reinterpret_cast<complex_t*>(inout.data()), inout.data());
 }
 
+template <typename T>
+static std::deque<std::unique_ptr<typename FFT<T>::work_area_t>>& workAreaPool() {
+  // Most recently released first
+  static thread_local std::deque<std::unique_ptr<typename FFT<T>::work_area_t>> pool;
+  return pool;
+}
+
+template <typename T>
+auto FFT<T>::acquireWorkArea(std::size_t size) -> std::unique_ptr<work_area_t> {
+  auto& pool = workAreaPool<T>();
+  for (auto i = pool.begin(); i != pool.end(); ++i) {
+    if ((*i)->size() == size) {
+      auto work_area = std::move(*i);
+      pool.erase(i);
+      return work_area;
+    }
+  }
+  return std::unique_ptr<work_area_t>{new work_area_t(size)};
+}
+
+template <typename T>
+void FFT<T>::releaseWorkArea(std::unique_ptr<work_area_t> work_area) {
+  auto& pool = workAreaPool<T>();
+  pool.emplace_front(std::move(work_area));
+  if (pool.size() > fftw_pooled_work_areas) {
+    pool.pop_back();
+  }
+}
+
 template class FFT<float>;
 template class FFT<double>;
 
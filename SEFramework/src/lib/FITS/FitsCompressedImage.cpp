@@ -0,0 +1,441 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsCompressedImage.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "SEFramework/FITS/FitsDecoding.h"
+#include "SEFramework/FITS/FitsCompressedImage.h"
+
+// The Rice decoders of cfitsio, declared in fitsio2.h. They only work on the given buffers
+extern "C" {
+int fits_rdecomp(unsigned char *c, int clen, unsigned int array[], int nx, int nblock);
+int fits_rdecomp_short(unsigned char *c, int clen, unsigned short array[], int nx, int nblock);
+int fits_rdecomp_byte(unsigned char *c, int clen, unsigned char array[], int nx, int nblock);
+}
+
+namespace SourceXtractor {
+
+// Values cfitsio stores for the pixels that are NaN, or 0 with SUBTRACTIVE_DITHER_2, in quantized images
+static const int QUANTIZED_NULL_VALUE = -2147483647;
+static const int QUANTIZED_ZERO_VALUE = -2147483646;
+
+// Same sequence as fits_init_randoms, used to dither the quantized images
+static const int N_RANDOM = 10000;
+
+static const std::vector<float>& getRandomValues() {
+  static const std::vector<float> values = []() {
+    std::vector<float> random(N_RANDOM);
+    double a = 16807.0, m = 2147483647.0, seed = 1.;
+    for (auto& value : random) {
+      double temp = a * seed;
+      seed = temp - m * static_cast<int>(temp / m);
+      value = static_cast<float>(seed / m);
+    }
+    return random;
+  }();
+  return values;
+}
+
+static bool readKey(fitsfile *fptr, int type, const std::string& keyword, void* value) {
+  int status = 0;
+  fits_read_key(fptr, type, keyword.c_str(), value, nullptr, &status);
+  return status == 0;
+}
+
+static bool readStringKey(fitsfile *fptr, const std::string& keyword, std::string& value) {
+  char buffer[FLEN_VALUE] = "";
+  if (!readKey(fptr, TSTRING, keyword, buffer)) {
+    return false;
+  }
+  value = buffer;
+  std::transform(value.begin(), value.end(), value.begin(), [](char c) { return std::toupper(c); });
+  return true;
+}
+
+/// Bytes taken by a column of the given TFORM in each row, -1 if it is not known
+static int getColumnSize(const std::string& tform, char& type) {
+  std::size_t letter = 0;
+  while (letter < tform.size() && std::isdigit(tform[letter])) {
+    ++letter;
+  }
+  if (letter == tform.size()) {
+    return -1;
+  }
+  int repeat = letter > 0 ? std::atoi(tform.substr(0, letter).c_str()) : 1;
+  type = static_cast<char>(std::toupper(tform[letter]));
+  switch (type) {
+    case 'L': case 'B': case 'A':
+      return repeat;
+    case 'X':
+      return (repeat + 7) / 8;
+    case 'I':
+      return 2 * repeat;
+    case 'J': case 'E':
+      return 4 * repeat;
+    case 'K': case 'D': case 'C': case 'P':
+      return 8 * repeat;
+    case 'M': case 'Q':
+      return 16 * repeat;
+    default:
+      return -1;
+  }
+}
+
+std::unique_ptr<FitsCompressedImage> FitsCompressedImage::create(fitsfile *fptr, long long data_offset,
+                                                                 ImageTile::ImageType image_type) {
+  std::unique_ptr<FitsCompressedImage> image(new FitsCompressedImage);
+  image->m_image_type = image_type;
+
+  std::string compression;
+  int znaxis = 0;
+  if (!readStringKey(fptr, "ZCMPTYPE", compression) || (compression != "RICE_1" && compression != "RICE_ONE") ||
+      !readKey(fptr, TINT, "ZBITPIX", &image->m_zbitpix) || !readKey(fptr, TINT, "ZNAXIS", &znaxis) ||
+      znaxis != 2 || !readKey(fptr, TINT, "ZNAXIS1", &image->m_width) ||
+      !readKey(fptr, TINT, "ZNAXIS2", &image->m_height)) {
+    return nullptr;
+  }
+  image->m_tile_width = image->m_width;
+  image->m_tile_height = 1;
+  readKey(fptr, TINT, "ZTILE1", &image->m_tile_width);
+  readKey(fptr, TINT, "ZTILE2", &image->m_tile_height);
+  if (image->m_tile_width <= 0 || image->m_tile_height <= 0) {
+    return nullptr;
+  }
+  image->m_tiles_x = (image->m_width + image->m_tile_width - 1) / image->m_tile_width;
+  long long tiles_y = (image->m_height + image->m_tile_height - 1) / image->m_tile_height;
+
+  // The binary table
+  long long rows = 0;
+  if (!readKey(fptr, TINT, "NAXIS1", &image->m_row_size) || !readKey(fptr, TLONGLONG, "NAXIS2", &rows) ||
+      rows != image->m_tiles_x * tiles_y) {
+    return nullptr;
+  }
+  long long heap = static_cast<long long>(image->m_row_size) * rows;
+  readKey(fptr, TLONGLONG, "THEAP", &heap);
+  image->m_table_offset = data_offset;
+  image->m_heap_offset = data_offset + heap;
+
+  int fields = 0;
+  if (!readKey(fptr, TINT, "TFIELDS", &fields)) {
+    return nullptr;
+  }
+  int offset = 0;
+  for (int i = 1; i <= fields; ++i) {
+    std::string name, tform;
+    readStringKey(fptr, "TTYPE" + std::to_string(i), name);
+    if (!readStringKey(fptr, "TFORM" + std::to_string(i), tform)) {
+      return nullptr;
+    }
+    Column column;
+    int size = getColumnSize(tform, column.m_type);
+    if (size < 0) {
+      return nullptr;
+    }
+    column.m_offset = offset;
+    offset += size;
+
+    if (name == "COMPRESSED_DATA") {
+      // An array of bytes in the heap
+      if ((column.m_type != 'P' && column.m_type != 'Q') || tform.find('B') == std::string::npos) {
+        return nullptr;
+      }
+      image->m_data_column = column;
+    }
+    else if (name == "ZSCALE") {
+      image->m_zscale_column = column;
+    }
+    else if (name == "ZZERO") {
+      image->m_zzero_column = column;
+    }
+    else if (name == "ZBLANK") {
+      image->m_zblank_column = column;
+    }
+  }
+  if (offset != image->m_row_size || image->m_data_column.m_offset < 0) {
+    return nullptr;
+  }
+
+  // Parameters of the Rice compression
+  image->m_blocksize = 32;
+  image->m_bytepix = image->m_zbitpix > 0 ? image->m_zbitpix / 8 : 4;
+  for (int i = 1; ; ++i) {
+    std::string name;
+    int value = 0;
+    if (!readStringKey(fptr, "ZNAME" + std::to_string(i), name) ||
+        !readKey(fptr, TINT, "ZVAL" + std::to_string(i), &value)) {
+      break;
+    }
+    if (name == "BLOCKSIZE") {
+      image->m_blocksize = value;
+    }
+    else if (name == "BYTEPIX") {
+      image->m_bytepix = value;
+    }
+  }
+
+  image->m_zscale = 1.;
+  image->m_zzero = 0.;
+  image->m_has_zblank = readKey(fptr, TLONGLONG, "ZBLANK", &image->m_zblank) ||
+                        readKey(fptr, TLONGLONG, "BLANK", &image->m_zblank);
+  image->m_bscale = 1.;
+  image->m_bzero = 0.;
+  readKey(fptr, TDOUBLE, "BSCALE", &image->m_bscale);
+  readKey(fptr, TDOUBLE, "BZERO", &image->m_bzero);
+  bool scaled = image->m_bscale != 1. || image->m_bzero != 0.;
+  bool floating_output = image_type == ImageTile::FloatImage || image_type == ImageTile::DoubleImage;
+
+  if (image->m_zbitpix > 0) {
+    // cfitsio rounds and clips the scaled values it converts to integers, that is left to it
+    if ((image->m_zbitpix != BYTE_IMG && image->m_zbitpix != SHORT_IMG && image->m_zbitpix != LONG_IMG) ||
+        image->m_bytepix != image->m_zbitpix / 8 || image_type == ImageTile::UIntImage ||
+        (scaled && !floating_output)) {
+      return nullptr;
+    }
+    image->m_quantization = Quantization::NONE;
+    return image;
+  }
+
+  // Floating point images are stored as quantized integers
+  std::string quantization = "NO_DITHER";
+  readStringKey(fptr, "ZQUANTIZ", quantization);
+  if (quantization == "NO_DITHER") {
+    image->m_quantization = Quantization::NO_DITHER;
+  }
+  else if (quantization == "SUBTRACTIVE_DITHER_1") {
+    image->m_quantization = Quantization::SUBTRACTIVE_DITHER_1;
+  }
+  else if (quantization == "SUBTRACTIVE_DITHER_2") {
+    image->m_quantization = Quantization::SUBTRACTIVE_DITHER_2;
+  }
+  else {
+    return nullptr;
+  }
+  image->m_dither_seed = 0;
+  if (image->m_quantization != Quantization::NO_DITHER &&
+      (!readKey(fptr, TINT, "ZDITHER0", &image->m_dither_seed) || image->m_dither_seed < 1)) {
+    return nullptr;
+  }
+
+  bool has_zscale = image->m_zscale_column.m_offset >= 0 || readKey(fptr, TDOUBLE, "ZSCALE", &image->m_zscale);
+  bool has_zzero = image->m_zzero_column.m_offset >= 0 || readKey(fptr, TDOUBLE, "ZZERO", &image->m_zzero);
+  if (!has_zscale || !has_zzero || image->m_bytepix != 4 || scaled || !floating_output) {
+    return nullptr;
+  }
+  return image;
+}
+
+bool FitsCompressedImage::read(const FitsHandlePool::Handle& handle, int x, int y, int width, int height,
+                               void* out) const {
+  switch (m_image_type) {
+    case ImageTile::FloatImage:
+      return readTiles(handle, x, y, width, height, static_cast<float*>(out));
+    case ImageTile::DoubleImage:
+      return readTiles(handle, x, y, width, height, static_cast<double*>(out));
+    case ImageTile::IntImage:
+      return readTiles(handle, x, y, width, height, static_cast<int*>(out));
+    case ImageTile::LongLongImage:
+      return readTiles(handle, x, y, width, height, static_cast<std::int64_t*>(out));
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool FitsCompressedImage::readTiles(const FitsHandlePool::Handle& handle, int x, int y, int width, int height,
+                                    T* out) const {
+  int first_tile_x = x / m_tile_width, last_tile_x = (x + width - 1) / m_tile_width;
+  int first_tile_y = y / m_tile_height, last_tile_y = (y + height - 1) / m_tile_height;
+
+  // The tiles side by side are consecutive rows of the table, read at once
+  std::vector<unsigned char> rows(static_cast<std::size_t>(last_tile_x - first_tile_x + 1) * m_row_size);
+  for (int tile_y = first_tile_y; tile_y <= last_tile_y; ++tile_y) {
+    long first_tile = static_cast<long>(tile_y) * m_tiles_x + first_tile_x;
+    handle.read(m_table_offset + static_cast<off_t>(first_tile) * m_row_size, rows.size(), rows.data());
+    for (int tile_x = first_tile_x; tile_x <= last_tile_x; ++tile_x) {
+      auto row = rows.data() + static_cast<std::size_t>(tile_x - first_tile_x) * m_row_size;
+      if (!decodeTile(handle, first_tile + tile_x - first_tile_x, row, x, y, width, height, out)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T>
+bool FitsCompressedImage::decodeTile(const FitsHandlePool::Handle& handle, long tile, const unsigned char* row,
+                                     int x, int y, int width, int height, T* out) const {
+  using FitsDecoding::decodeValue;
+
+  long long nbytes, heap_offset;
+  auto descriptor = row + m_data_column.m_offset;
+  if (m_data_column.m_type == 'P') {
+    nbytes = decodeValue<std::int32_t>(descriptor);
+    heap_offset = decodeValue<std::int32_t>(descriptor + 4);
+  }
+  else {
+    nbytes = decodeValue<std::int64_t>(descriptor);
+    heap_offset = decodeValue<std::int64_t>(descriptor + 8);
+  }
+  // Stored in another column, i.e. a tile that could not be quantized
+  if (nbytes <= 0) {
+    return false;
+  }
+
+  int tile_x = static_cast<int>(tile % m_tiles_x) * m_tile_width;
+  int tile_y = static_cast<int>(tile / m_tiles_x) * m_tile_height;
+  int tile_width = std::min(m_tile_width, m_width - tile_x);
+  int tile_height = std::min(m_tile_height, m_height - tile_y);
+  int npixels = tile_width * tile_height;
+
+  std::vector<unsigned char> compressed(nbytes);
+  handle.read(m_heap_offset + heap_offset, compressed.size(), compressed.data());
+
+  // On error, the tile is read again by cfitsio, which reports it
+  std::vector<int> values(npixels);
+  int rice_status = 0;
+  switch (m_bytepix) {
+    case 4:
+      rice_status = fits_rdecomp(compressed.data(), static_cast<int>(nbytes),
+                                 reinterpret_cast<unsigned int*>(values.data()), npixels, m_blocksize);
+      break;
+    case 2: {
+      std::vector<unsigned short> shorts(npixels);
+      rice_status = fits_rdecomp_short(compressed.data(), static_cast<int>(nbytes), shorts.data(), npixels,
+                                       m_blocksize);
+      std::transform(shorts.begin(), shorts.end(), values.begin(),
+                     [](unsigned short v) { return static_cast<std::int16_t>(v); });
+      break;
+    }
+    case 1: {
+      std::vector<unsigned char> bytes(npixels);
+      rice_status = fits_rdecomp_byte(compressed.data(), static_cast<int>(nbytes), bytes.data(), npixels,
+                                      m_blocksize);
+      std::copy(bytes.begin(), bytes.end(), values.begin());
+      break;
+    }
+    default:
+      return false;
+  }
+  if (rice_status != 0) {
+    return false;
+  }
+
+  // Part of the tile inside the region
+  int start_x = std::max(x, tile_x), end_x = std::min(x + width, tile_x + tile_width);
+  int start_y = std::max(y, tile_y), end_y = std::min(y + height, tile_y + tile_height);
+
+  bool has_zblank = m_has_zblank || m_zblank_column.m_offset >= 0;
+  long long zblank = static_cast<long long>(readScalar(row, m_zblank_column, static_cast<double>(m_zblank)));
+
+  // cfitsio replaces the null pixels by a value of its own, so those tiles are left to it
+  if (m_quantization == Quantization::NONE) {
+    bool scaled = m_bscale != 1. || m_bzero != 0.;
+    for (int iy = start_y; iy < end_y; ++iy) {
+      auto input = values.data() + static_cast<std::size_t>(iy - tile_y) * tile_width - tile_x;
+      auto output = out + static_cast<std::size_t>(iy - y) * width - x;
+      for (int ix = start_x; ix < end_x; ++ix) {
+        if (has_zblank && input[ix] == zblank) {
+          return false;
+        }
+        output[ix] = scaled ? static_cast<T>(input[ix] * m_bscale + m_bzero) : static_cast<T>(input[ix]);
+      }
+    }
+    return true;
+  }
+
+  double zscale = readScalar(row, m_zscale_column, m_zscale);
+  double zzero = readScalar(row, m_zzero_column, m_zzero);
+
+  if (m_quantization == Quantization::NO_DITHER) {
+    for (int iy = start_y; iy < end_y; ++iy) {
+      auto input = values.data() + static_cast<std::size_t>(iy - tile_y) * tile_width - tile_x;
+      auto output = out + static_cast<std::size_t>(iy - y) * width - x;
+      for (int ix = start_x; ix < end_x; ++ix) {
+        if (input[ix] == QUANTIZED_NULL_VALUE || (has_zblank && input[ix] == zblank)) {
+          return false;
+        }
+        output[ix] = static_cast<T>(input[ix] * zscale + zzero);
+      }
+    }
+    return true;
+  }
+
+  // The dithering follows the pixels of the whole tile, from a position in the sequence given by the tile number
+  auto& random = getRandomValues();
+  int seed = static_cast<int>((tile + m_dither_seed - 1) % N_RANDOM);
+  int next = static_cast<int>(random[seed] * 500);
+  for (int i = 0; i < npixels; ++i) {
+    int ix = tile_x + i % tile_width, iy = tile_y + i / tile_width;
+    if (ix >= start_x && ix < end_x && iy >= start_y && iy < end_y) {
+      int value = values[i];
+      if (value == QUANTIZED_NULL_VALUE || (has_zblank && value == zblank)) {
+        return false;
+      }
+      auto& output = out[static_cast<std::size_t>(iy - y) * width + ix - x];
+      if (m_quantization == Quantization::SUBTRACTIVE_DITHER_2 && value == QUANTIZED_ZERO_VALUE) {
+        output = 0;
+      }
+      else {
+        output = static_cast<T>((static_cast<double>(value) - random[next] + 0.5) * zscale + zzero);
+      }
+    }
+    if (++next == N_RANDOM) {
+      if (++seed == N_RANDOM) {
+        seed = 0;
+      }
+      next = static_cast<int>(random[seed] * 500);
+    }
+  }
+  return true;
+}
+
+double FitsCompressedImage::readScalar(const unsigned char* row, const Column& column, double default_value) const {
+  using FitsDecoding::decodeValue;
+
+  if (column.m_offset < 0) {
+    return default_value;
+  }
+  auto value = row + column.m_offset;
+  switch (column.m_type) {
+    case 'B':
+      return *value;
+    case 'I':
+      return decodeValue<std::int16_t>(value);
+    case 'J':
+      return decodeValue<std::int32_t>(value);
+    case 'K':
+      return static_cast<double>(decodeValue<std::int64_t>(value));
+    case 'E':
+      return decodeValue<float>(value);
+    case 'D':
+      return decodeValue<double>(value);
+    default:
+      return default_value;
+  }
+}
+
+}  // namespace SourceXtractor
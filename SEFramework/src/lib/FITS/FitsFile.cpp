@@ -24,9 +24,12 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include <boost/algorithm/string/case_conv.hpp>
@@ -40,6 +43,10 @@
 
 namespace SourceXtractor {
 
+static boost::filesystem::path s_header_cache_directory;
+
+static const std::string s_header_cache_signature{"SourceXtractor++ FITS header cache 1"};
+
 /**
  * Cast a string to a C++ type depending on the format of the content.
  * - if only digits are present, it will be casted to int64_t
@@ -99,6 +106,10 @@ FitsFile::FitsFile(const boost::filesystem::path& path, bool writeable)
 
 FitsFile::~FitsFile() {}
 
+void FitsFile::setHeaderCacheDirectory(const boost::filesystem::path& directory) {
+  s_header_cache_directory = directory;
+}
+
 fitsfile* FitsFile::getFitsFilePtr() {
   return m_fits_ptr.get();
 }
@@ -108,7 +119,12 @@ const std::vector<int>& FitsFile::getImageHdus() const {
 }
 
 std::map<std::string, MetadataEntry>& FitsFile::getHDUHeaders(int hdu) {
-  return m_headers.at(hdu - 1);
+  auto& headers = m_headers.at(hdu - 1);
+  if (!m_headers_loaded[hdu - 1]) {
+    loadFitsHeader(hdu);
+    m_headers_loaded[hdu - 1] = true;
+  }
+  return headers;
 }
 
 void FitsFile::open() {
@@ -152,62 +168,29 @@ void FitsFile::refresh() {
   loadInfo();
 }
 
-void FitsFile::loadInfo() {
-  int status = 0;
-
-  fitsfile* ptr = m_fits_ptr.get();
-
-  // save current HDU (if the file is opened with advanced cfitsio syntax it might be set already
-  int original_hdu = 0;
-  fits_get_hdu_num(ptr, &original_hdu);
-
-  // Number of HDU
-  m_image_hdus.clear();
-  int number_of_hdus = 0;
-  if (fits_get_num_hdus(ptr, &number_of_hdus, &status) < 0) {
-    throw Elements::Exception() << "Can't get the number of HDUs in FITS file: " << m_path;
-  }
-  m_headers.clear();
-  m_headers.resize(number_of_hdus);
-
-  // loop over HDUs to determine which ones are images
-  int hdu_type = 0;
-  for (int hdu_number = 1; hdu_number <= number_of_hdus; ++hdu_number) {
-    fits_movabs_hdu(ptr, hdu_number, &hdu_type, &status);
-    if (status != 0) {
-      throw Elements::Exception() << "Can't switch HDUs while opening: " << m_path;
-    }
-
-    if (hdu_type == IMAGE_HDU) {
-      int  bitpix, naxis;
-      long naxes[2] = {1, 1};
+// Raw records of the header of the current HDU, one per line
+static std::string readHeaderRecords(fitsfile* fptr) {
+  std::string records;
+  char record[81];
+  int keynum = 1, status = 0;
 
-      fits_get_img_param(ptr, 2, &bitpix, &naxis, naxes, &status);
-      if (status == 0 && naxis == 2) {
-        m_image_hdus.emplace_back(hdu_number);
-      }
-    }
+  fits_read_record(fptr, keynum, record, &status);
+  while (status == 0 && strncmp(record, "END", 3) != 0) {
+    records += record;
+    records += '\n';
+    fits_read_record(fptr, ++keynum, record, &status);
   }
 
-  // go back to saved HDU
-  fits_movabs_hdu(ptr, original_hdu, &hdu_type, &status);
-
-  // load all FITS headers
-  loadFitsHeader();
-
-  // load optional .head file to override headers
-  loadHeadFile();
+  return records;
 }
 
-static std::map<std::string, MetadataEntry> loadHeadersFromFits(fitsfile* fptr) {
+static std::map<std::string, MetadataEntry> parseHeaderRecords(const std::string& records) {
   std::map<std::string, MetadataEntry> headers;
-  char record[81];
-  int keynum = 1, status = 0;
+  std::istringstream stream(records);
+  std::string record_str;
 
-  fits_read_record(fptr, keynum, record, &status);
-  while (status == 0 && strncmp(record, "END", 3) != 0) {
+  while (std::getline(stream, record_str)) {
     static boost::regex regex("([^=]{8})=([^\\/]*)(\\/(.*))?");
-    std::string         record_str(record);
 
     boost::smatch sub_matches;
     if (boost::regex_match(record_str, sub_matches, regex)) {
@@ -219,28 +202,108 @@ static std::map<std::string, MetadataEntry> loadHeadersFromFits(fitsfile* fptr)
       boost::trim(comment);
       headers.emplace(keyword, MetadataEntry{valueAutoCast(value), {{"comment", comment}}});
     }
-    fits_read_record(fptr, ++keynum, record, &status);
   }
 
   return headers;
 }
 
-void FitsFile::loadFitsHeader() {
-  int status = 0;
+void FitsFile::loadInfo() {
+  m_image_hdus.clear();
+  m_header_records.clear();
+  m_head_overrides.clear();
+
+  int number_of_hdus = 0;
+  if (readHeaderCache()) {
+    number_of_hdus = m_header_records.size();
+  }
+  else {
+    int status = 0;
 
-  // save current HDU (if the file is opened with advanced cfitsio syntax it might be set already)
-  int original_hdu = 0;
-  fits_get_hdu_num(m_fits_ptr.get(), &original_hdu);
+    fitsfile* ptr = m_fits_ptr.get();
 
-  int hdu_type = 0;
-  for (unsigned int i = 0; i < m_headers.size(); i++) {
-    fits_movabs_hdu(m_fits_ptr.get(), i + 1, &hdu_type, &status);  // +1 hdus start at 1
+    // save current HDU (if the file is opened with advanced cfitsio syntax it might be set already
+    int original_hdu = 0;
+    fits_get_hdu_num(ptr, &original_hdu);
 
-    m_headers[i] = loadHeadersFromFits(m_fits_ptr.get());
+    // Number of HDU
+    if (fits_get_num_hdus(ptr, &number_of_hdus, &status) < 0) {
+      throw Elements::Exception() << "Can't get the number of HDUs in FITS file: " << m_path;
+    }
+
+    // Reading the raw records to fill the cache is much cheaper than parsing them
+    bool fill_cache = !getHeaderCachePath().empty();
+    if (fill_cache) {
+      m_header_records.resize(number_of_hdus);
+    }
+
+    // loop over HDUs to determine which ones are images
+    int hdu_type = 0;
+    for (int hdu_number = 1; hdu_number <= number_of_hdus; ++hdu_number) {
+      fits_movabs_hdu(ptr, hdu_number, &hdu_type, &status);
+      if (status != 0) {
+        throw Elements::Exception() << "Can't switch HDUs while opening: " << m_path;
+      }
+
+      if (hdu_type == IMAGE_HDU) {
+        int  bitpix, naxis;
+        long naxes[2] = {1, 1};
+
+        fits_get_img_param(ptr, 2, &bitpix, &naxis, naxes, &status);
+        if (status == 0 && naxis == 2) {
+          m_image_hdus.emplace_back(hdu_number);
+        }
+      }
+
+      if (fill_cache) {
+        m_header_records[hdu_number - 1] = readHeaderRecords(ptr);
+      }
+    }
+
+    // go back to saved HDU
+    fits_movabs_hdu(ptr, original_hdu, &hdu_type, &status);
+
+    if (fill_cache) {
+      writeHeaderCache();
+    }
   }
 
-  // go back to saved HDU
-  fits_movabs_hdu(m_fits_ptr.get(), original_hdu, &hdu_type, &status);
+  // the FITS headers are parsed when first needed
+  m_headers.clear();
+  m_headers.resize(number_of_hdus);
+  m_headers_loaded.assign(number_of_hdus, false);
+
+  // load optional .head file to override headers
+  loadHeadFile();
+}
+
+void FitsFile::loadFitsHeader(int hdu) {
+  auto& headers = m_headers[hdu - 1];
+
+  if (!m_header_records.empty()) {
+    headers = parseHeaderRecords(m_header_records[hdu - 1]);
+    std::string().swap(m_header_records[hdu - 1]);
+  }
+  else {
+    int status = 0;
+
+    // save current HDU (if the file is opened with advanced cfitsio syntax it might be set already)
+    int original_hdu = 0;
+    fits_get_hdu_num(m_fits_ptr.get(), &original_hdu);
+
+    int hdu_type = 0;
+    fits_movabs_hdu(m_fits_ptr.get(), hdu, &hdu_type, &status);
+    headers = parseHeaderRecords(readHeaderRecords(m_fits_ptr.get()));
+
+    // go back to saved HDU
+    fits_movabs_hdu(m_fits_ptr.get(), original_hdu, &hdu_type, &status);
+  }
+
+  auto overrides = m_head_overrides.find(hdu);
+  if (overrides != m_head_overrides.end()) {
+    for (auto& entry : overrides->second) {
+      headers[entry.first] = entry.second;
+    }
+  }
 }
 
 void FitsFile::loadHeadFile() {
@@ -274,7 +337,7 @@ void FitsFile::loadHeadFile() {
     }
 
     if (boost::to_upper_copy(line) == "END") {
-      current_hdu = *(++hdu_iter);
+      ++hdu_iter;
     } else {
       static boost::regex regex("([^=]{1,8})=([^\\/]*)(\\/ (.*))?");
       boost::smatch       sub_matches;
@@ -285,11 +348,129 @@ void FitsFile::loadHeadFile() {
         boost::trim(keyword);
         boost::trim(value);
         boost::trim(comment);
-        m_headers.at(current_hdu - 1)[keyword] = MetadataEntry{valueAutoCast(value), {{"comment", comment}}};
-        ;
+        m_head_overrides[current_hdu][keyword] = MetadataEntry{valueAutoCast(value), {{"comment", comment}}};
       }
     }
   }
 }
 
+// Identifies the content of the file: its canonical path, size and modification time
+static std::string getFileStamp(const boost::filesystem::path& path) {
+  boost::system::error_code ec;
+  auto canonical = boost::filesystem::canonical(path, ec);
+  if (ec) {
+    return {};
+  }
+  auto size = boost::filesystem::file_size(canonical, ec);
+  if (ec) {
+    return {};
+  }
+  auto mtime = boost::filesystem::last_write_time(canonical, ec);
+  if (ec) {
+    return {};
+  }
+
+  std::ostringstream stamp;
+  stamp << canonical.native() << ' ' << size << ' ' << mtime;
+  return stamp.str();
+}
+
+boost::filesystem::path FitsFile::getHeaderCachePath() const {
+  // Paths with the cfitsio extended syntax are not real files, so they are not cached
+  boost::system::error_code ec;
+  if (m_is_writeable || s_header_cache_directory.empty() || !boost::filesystem::is_regular_file(m_path, ec)) {
+    return {};
+  }
+
+  std::ostringstream name;
+  name << std::hex << std::hash<std::string>()(boost::filesystem::canonical(m_path, ec).native()) << ".hdr";
+  return s_header_cache_directory / name.str();
+}
+
+bool FitsFile::readHeaderCache() {
+  auto cache_path = getHeaderCachePath();
+  if (cache_path.empty()) {
+    return false;
+  }
+
+  std::ifstream cache(cache_path.native());
+  std::string line;
+  if (!std::getline(cache, line) || line != s_header_cache_signature) {
+    return false;
+  }
+  // A different or modified file with the same path
+  if (!std::getline(cache, line) || line != getFileStamp(m_path)) {
+    return false;
+  }
+
+  size_t number_of_hdus = 0, number_of_images = 0;
+  cache >> number_of_hdus >> number_of_images;
+  if (!cache || number_of_images > number_of_hdus) {
+    return false;
+  }
+
+  std::vector<int> image_hdus(number_of_images);
+  for (auto& hdu : image_hdus) {
+    cache >> hdu;
+  }
+
+  std::vector<std::string> header_records(number_of_hdus);
+  for (auto& records : header_records) {
+    size_t number_of_records = 0;
+    cache >> number_of_records;
+    std::getline(cache, line);
+    for (size_t i = 0; i < number_of_records && std::getline(cache, line); ++i) {
+      records += line;
+      records += '\n';
+    }
+  }
+  if (!cache) {
+    return false;
+  }
+
+  m_image_hdus = std::move(image_hdus);
+  m_header_records = std::move(header_records);
+  return true;
+}
+
+void FitsFile::writeHeaderCache() const {
+  auto cache_path = getHeaderCachePath();
+  auto stamp = getFileStamp(m_path);
+  if (cache_path.empty() || stamp.empty()) {
+    return;
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(s_header_cache_directory, ec);
+  if (ec) {
+    return;
+  }
+
+  // Written aside and then renamed, so a concurrent run never reads a partial cache.
+  // The cache is only an optimization, failing to write it is not an error
+  auto tmp_path = cache_path;
+  tmp_path += boost::filesystem::unique_path(".%%%%%%");
+  {
+    std::ofstream cache(tmp_path.native());
+    cache << s_header_cache_signature << '\n' << stamp << '\n';
+    cache << m_header_records.size() << ' ' << m_image_hdus.size();
+    for (auto hdu : m_image_hdus) {
+      cache << ' ' << hdu;
+    }
+    cache << '\n';
+    for (auto& records : m_header_records) {
+      cache << std::count(records.begin(), records.end(), '\n') << '\n' << records;
+    }
+    if (!cache) {
+      boost::filesystem::remove(tmp_path, ec);
+      return;
+    }
+  }
+
+  boost::filesystem::rename(tmp_path, cache_path, ec);
+  if (ec) {
+    boost::filesystem::remove(tmp_path, ec);
+  }
+}
+
 }  // namespace SourceXtractor
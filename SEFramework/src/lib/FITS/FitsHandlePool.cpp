@@ -0,0 +1,180 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsHandlePool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <ElementsKernel/Exception.h>
+#include <ElementsKernel/Logging.h>
+
+#include "SEFramework/FITS/FitsHandlePool.h"
+
+namespace SourceXtractor {
+
+static Elements::Logging s_pool_logger = Elements::Logging::getLogger("FitsHandlePool");
+
+FitsHandlePool::Handle::Handle(std::shared_ptr<FitsHandlePool> pool, std::string filename, int fd)
+    : m_pool(std::move(pool)), m_filename(std::move(filename)), m_fd(fd) {
+}
+
+FitsHandlePool::Handle::~Handle() {
+  m_pool->release(m_filename, m_fd);
+}
+
+int FitsHandlePool::Handle::getDescriptor() const {
+  return m_fd;
+}
+
+void FitsHandlePool::Handle::read(off_t offset, std::size_t size, void* out) const {
+  auto buffer = static_cast<char*>(out);
+  while (size > 0) {
+    auto nread = ::pread(m_fd, buffer, size, offset);
+    if (nread < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nread <= 0) {
+      throw Elements::Exception() << "Could not read " << size << " bytes at " << offset << " from " << m_filename
+                                  << ": " << (nread < 0 ? std::strerror(errno) : "end of file");
+    }
+    buffer += nread;
+    offset += nread;
+    size -= nread;
+  }
+}
+
+FitsHandlePool::FitsHandlePool(unsigned max_handles) : m_max_handles(max_handles), m_open_handles(0) {
+}
+
+FitsHandlePool::~FitsHandlePool() {
+  closeIdle();
+}
+
+std::shared_ptr<FitsHandlePool> FitsHandlePool::getInstance() {
+  static std::shared_ptr<FitsHandlePool> instance = std::make_shared<FitsHandlePool>();
+  return instance;
+}
+
+void FitsHandlePool::setMaxHandles(unsigned max_handles) {
+  std::vector<int> extra;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_max_handles = max_handles;
+    // Handles in use are closed when released
+    extra = takeExtraHandles(m_max_handles);
+  }
+  closeHandles(extra);
+}
+
+unsigned FitsHandlePool::getMaxHandles() const {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_max_handles;
+}
+
+unsigned FitsHandlePool::getOpenHandles() const {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_open_handles;
+}
+
+std::unique_ptr<FitsHandlePool::Handle> FitsHandlePool::acquire(const std::string& filename) {
+  std::vector<int> extra;
+  bool can_open;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    auto idle = std::find_if(m_idle.begin(), m_idle.end(), [&filename](const IdleHandle& h) {
+      return h.m_filename == filename;
+    });
+    if (idle != m_idle.end()) {
+      std::unique_ptr<Handle> handle(new Handle(shared_from_this(), filename, idle->m_fd));
+      m_idle.erase(idle);
+      return handle;
+    }
+
+    // Make room for a new one, closing idle handles of other files if needed
+    if (m_max_handles > 0) {
+      extra = takeExtraHandles(m_max_handles - 1);
+    }
+    can_open = m_open_handles < m_max_handles;
+    if (can_open) {
+      ++m_open_handles;
+    }
+  }
+  closeHandles(extra);
+
+  if (!can_open) {
+    return nullptr;
+  }
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    // The caller falls back to the shared handle, which reports the error if there is really one
+    s_pool_logger.debug() << "Could not open " << filename << ": " << std::strerror(errno);
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    --m_open_handles;
+    return nullptr;
+  }
+
+  return std::unique_ptr<Handle>(new Handle(shared_from_this(), filename, fd));
+}
+
+void FitsHandlePool::closeIdle() {
+  std::vector<int> idle;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    idle = takeExtraHandles(0);
+  }
+  closeHandles(idle);
+}
+
+void FitsHandlePool::release(const std::string& filename, int fd) {
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    // The limit may have been lowered while the handle was in use
+    if (m_open_handles <= m_max_handles) {
+      m_idle.push_front(IdleHandle{filename, fd});
+      return;
+    }
+    --m_open_handles;
+  }
+  closeHandles({fd});
+}
+
+std::vector<int> FitsHandlePool::takeExtraHandles(unsigned max_open) {
+  std::vector<int> extra;
+  while (m_open_handles > max_open && !m_idle.empty()) {
+    extra.emplace_back(m_idle.back().m_fd);
+    m_idle.pop_back();
+    --m_open_handles;
+  }
+  return extra;
+}
+
+void FitsHandlePool::closeHandles(const std::vector<int>& handles) {
+  for (auto fd : handles) {
+    ::close(fd);
+  }
+}
+
+}  // namespace SourceXtractor
@@ -21,6 +21,9 @@
  *      Author: mschefer
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
 #include <fstream>
 #include <numeric>
@@ -34,20 +37,22 @@
 
 #include <ElementsKernel/Exception.h>
 
+#include "SEFramework/FITS/FitsCompressedImage.h"
+#include "SEFramework/FITS/FitsDecoding.h"
 #include "SEFramework/FITS/FitsFile.h"
+#include "SEFramework/FITS/FitsHandlePool.h"
 #include "SEUtils/VariantCast.h"
 
 #include "SEFramework/FITS/FitsImageSource.h"
 
 namespace SourceXtractor {
 
-namespace {
-}
-
 FitsImageSource::FitsImageSource(const std::string& filename, int hdu_number,
                                  ImageTile::ImageType image_type,
                                  std::shared_ptr<FileManager> manager)
-    : m_filename(filename), m_handler(manager->getFileHandler(filename)), m_hdu_number(hdu_number) {
+    : m_filename(filename), m_handler(manager->getFileHandler(filename)), m_hdu_number(hdu_number),
+      m_native_tile_width(0), m_native_tile_height(0), m_pooled_reads(true),
+      m_data_offset(0), m_bitpix(0), m_bscale(1.), m_bzero(0.) {
   int status = 0;
   int bitpix, naxis;
   long naxes[2] = {1, 1};
@@ -72,6 +77,17 @@ FitsImageSource::FitsImageSource(const std::string& filename, int hdu_number,
   m_width = naxes[0];
   m_height = naxes[1];
 
+  // Tile-compressed images are decompressed one compression tile at a time, tiling along them avoids
+  // decompressing the same tiles twice. When missing, the tiles are the image rows
+  if (fits_is_compressed_image(fptr, &status)) {
+    m_native_tile_width = m_width;
+    m_native_tile_height = 1;
+    fits_read_key(fptr, TINT, "ZTILE1", &m_native_tile_width, nullptr, &status);
+    status = 0;
+    fits_read_key(fptr, TINT, "ZTILE2", &m_native_tile_height, nullptr, &status);
+    status = 0;
+  }
+
   if (image_type < 0) {
     switch (bitpix) {
     case FLOAT_IMG:
@@ -96,6 +112,9 @@ FitsImageSource::FitsImageSource(const std::string& filename, int hdu_number,
   else {
     m_image_type = image_type;
   }
+
+  m_bitpix = bitpix;
+  locateDataUnit(fptr);
 }
 
 
@@ -108,7 +127,14 @@ FitsImageSource::FitsImageSource(const std::string& filename, int width, int hei
     , m_handler(manager->getFileHandler(filename))
     , m_width(width)
     , m_height(height)
-    , m_image_type(image_type) {
+    , m_image_type(image_type)
+    , m_native_tile_width(0)
+    , m_native_tile_height(0)
+    , m_pooled_reads(false)
+    , m_data_offset(0)
+    , m_bitpix(0)
+    , m_bscale(1.)
+    , m_bzero(0.) {
 
   int status = 0;
   fitsfile* fptr = nullptr;
@@ -182,32 +208,228 @@ FitsImageSource::FitsImageSource(const std::string& filename, int width, int hei
 }
 
 std::shared_ptr<ImageTile> FitsImageSource::getImageTile(int x, int y, int width, int height) const {
+  auto tile = ImageTile::create(m_image_type, x, y, width, height,
+                                std::const_pointer_cast<ImageSource>(shared_from_this()));
+
+  readRows(*tile, y, y + height);
+  return tile;
+}
+
+void FitsImageSource::readRows(ImageTile& tile, int start_y, int end_y) const {
+  auto out = static_cast<char*>(tile.getDataPtr()) +
+             ImageTile::getTypeSize(m_image_type) * static_cast<size_t>(start_y - tile.getPosY()) * tile.getWidth();
+
+  // cfitsio shares its state between all the handles to a file, so it is only used through the FileManager.
+  // The pixels stored as they are, or Rice compressed, can be read and decoded concurrently without it
+  if (m_pooled_reads && !m_data_file.empty()) {
+    auto handle = FitsHandlePool::getInstance()->acquire(m_data_file);
+    if (handle && !m_compressed_image) {
+      readRawRows(*handle, tile, start_y, end_y);
+      return;
+    }
+    // The compressed tiles cfitsio would decode otherwise (i.e. with null pixels) are left to it
+    int width = tile.getWidth(), height = end_y - start_y;
+    if (handle && m_compressed_image->read(*handle, tile.getPosX(), start_y, width, height, out)) {
+      return;
+    }
+  }
+
   auto acc  = m_handler->getAccessor<FitsFile>();
   auto fptr = acc->m_fd.getFitsFilePtr();
   switchHdu(fptr, m_hdu_number);
+  readPixels(fptr, tile.getPosX(), start_y, tile.getWidth(), end_y - start_y, out);
+}
 
-  auto tile = ImageTile::create(m_image_type, x, y, width, height,
-                                std::const_pointer_cast<ImageSource>(shared_from_this()));
+template <typename T>
+static void decodeRawRows(const std::vector<unsigned char>& raw, int bitpix, int width, int height,
+                          size_t raw_row_size, double bscale, double bzero, T* out) {
+  for (int row = 0; row < height; ++row) {
+    decodeFitsPixels(bitpix, raw.data() + row * raw_row_size, out + static_cast<size_t>(row) * width, width,
+                     bscale, bzero);
+  }
+}
 
-  long first_pixel[2] = {x + 1, y + 1};
-  long last_pixel[2] = {x + width, y + height};
-  long increment[2] = {1, 1};
-  int status = 0;
+void FitsImageSource::readRawRows(const FitsHandlePool::Handle& handle, ImageTile& tile,
+                                  int start_y, int end_y) const {
+  int width = tile.getWidth();
+  int height = end_y - start_y;
+  size_t pixel_size = FitsDecoding::bytesPerPixel(m_bitpix);
+  size_t row_size = pixel_size * width;
+  std::vector<unsigned char> raw(row_size * height);
+
+  off_t first_row = m_data_offset + (static_cast<off_t>(start_y) * m_width + tile.getPosX()) * pixel_size;
+  if (width == m_width) {
+    // Whole rows are contiguous in the file
+    handle.read(first_row, raw.size(), raw.data());
+  }
+  else {
+    for (int row = 0; row < height; ++row) {
+      handle.read(first_row + static_cast<off_t>(row) * m_width * pixel_size, row_size, raw.data() + row * row_size);
+    }
+  }
 
-  fits_read_subset(fptr, getDataType(), first_pixel, last_pixel, increment,
-                   nullptr, tile->getDataPtr(), nullptr, &status);
+  size_t offset = static_cast<size_t>(start_y - tile.getPosY()) * width;
+  switch (m_image_type) {
+    default:
+    case ImageTile::FloatImage:
+      decodeRawRows(raw, m_bitpix, width, height, row_size, m_bscale, m_bzero,
+                    static_cast<float*>(tile.getDataPtr()) + offset);
+      break;
+    case ImageTile::DoubleImage:
+      decodeRawRows(raw, m_bitpix, width, height, row_size, m_bscale, m_bzero,
+                    static_cast<double*>(tile.getDataPtr()) + offset);
+      break;
+    case ImageTile::IntImage:
+      decodeRawRows(raw, m_bitpix, width, height, row_size, m_bscale, m_bzero,
+                    static_cast<int*>(tile.getDataPtr()) + offset);
+      break;
+    case ImageTile::UIntImage:
+      decodeRawRows(raw, m_bitpix, width, height, row_size, m_bscale, m_bzero,
+                    static_cast<unsigned int*>(tile.getDataPtr()) + offset);
+      break;
+    case ImageTile::LongLongImage:
+      decodeRawRows(raw, m_bitpix, width, height, row_size, m_bscale, m_bzero,
+                    static_cast<std::int64_t*>(tile.getDataPtr()) + offset);
+      break;
+  }
+}
+
+void FitsImageSource::locateDataUnit(fitsfile *fptr) {
+  int status = 0;
+  bool compressed = fits_is_compressed_image(fptr, &status);
   if (status != 0) {
-    throw Elements::Exception() << "Error reading image tile from FITS file.";
+    return;
   }
 
-  return tile;
+  // The scaling of compressed images is applied by FitsCompressedImage
+  if (!compressed) {
+    fits_read_key(fptr, TDOUBLE, "BSCALE", &m_bscale, nullptr, &status);
+    if (status == KEY_NO_EXIST) {
+      status = 0;
+    }
+    fits_read_key(fptr, TDOUBLE, "BZERO", &m_bzero, nullptr, &status);
+    if (status == KEY_NO_EXIST) {
+      status = 0;
+    }
+  }
+
+  // cfitsio rounds the scaled values it converts to integers, that is left to it
+  bool scaled = m_bscale != 1. || m_bzero != 0.;
+  if (status != 0 || (scaled && m_image_type != ImageTile::FloatImage && m_image_type != ImageTile::DoubleImage)) {
+    return;
+  }
+
+  // Only plain files on disk have their data unit where cfitsio says, i.e. not gzipped ones.
+  // What may have been written through the shared handle must be there too
+  LONGLONG head_start = 0, data_start = 0, data_end = 0;
+  char disk_filename[FLEN_FILENAME];
+  char url_type[FLEN_FILENAME];
+  fits_flush_buffer(fptr, 0, &status);
+  fits_get_hduaddrll(fptr, &head_start, &data_start, &data_end, &status);
+  fits_file_name(fptr, disk_filename, &status);
+  fits_url_type(fptr, url_type, &status);
+  if (status != 0 || std::strcmp(url_type, "file://") != 0) {
+    return;
+  }
+
+  // For compressed images, the data unit is the binary table with the compressed tiles
+  if (compressed) {
+    m_compressed_image = FitsCompressedImage::create(fptr, data_start, m_image_type);
+    if (!m_compressed_image) {
+      return;
+    }
+  }
+
+  m_data_file = disk_filename;
+  m_data_offset = data_start;
 }
 
 void FitsImageSource::saveTile(ImageTile& tile) {
+  // Other handles would not see what is written
+  m_pooled_reads = false;
+
   auto acc  = m_handler->getAccessor<FitsFile>(FileHandler::kWrite);
   auto fptr = acc->m_fd.getFitsFilePtr();
   switchHdu(fptr, m_hdu_number);
 
+  writeTile(fptr, tile);
+
+  int status = 0;
+  fits_flush_buffer(fptr, 0, &status);
+}
+
+void FitsImageSource::saveTiles(const std::vector<std::shared_ptr<ImageTile>>& tiles) {
+  if (tiles.empty()) {
+    return;
+  }
+
+  m_pooled_reads = false;
+
+  auto acc  = m_handler->getAccessor<FitsFile>(FileHandler::kWrite);
+  auto fptr = acc->m_fd.getFitsFilePtr();
+  switchHdu(fptr, m_hdu_number);
+
+  size_t pixel_size = ImageTile::getTypeSize(m_image_type);
+  std::vector<char> buffer;
+
+  size_t i = 0;
+  while (i < tiles.size()) {
+    // Find a band of tiles side by side, from the first to the last column
+    int y = tiles[i]->getPosY();
+    int height = tiles[i]->getHeight();
+    size_t end = i;
+    int next_x = 0;
+    while (end < tiles.size() && tiles[end]->getPosY() == y && tiles[end]->getHeight() == height &&
+           tiles[end]->getPosX() == next_x) {
+      next_x += tiles[end]->getWidth();
+      ++end;
+    }
+
+    if (next_x != m_width) {
+      writeTile(fptr, *tiles[i]);
+      ++i;
+      continue;
+    }
+
+    // The band covers whole rows, which are contiguous in the file
+    buffer.resize(pixel_size * m_width * height);
+    for (size_t t = i; t < end; ++t) {
+      auto& tile = *tiles[t];
+      auto data = static_cast<const char*>(tile.getDataPtr());
+      size_t row_size = pixel_size * tile.getWidth();
+      for (int row = 0; row < height; ++row) {
+        std::copy(data + row * row_size, data + (row + 1) * row_size,
+                  buffer.data() + pixel_size * (static_cast<size_t>(row) * m_width + tile.getPosX()));
+      }
+    }
+
+    long first_pixel[2] = {1, y + 1};
+    int status = 0;
+    fits_write_pix(fptr, getDataType(), first_pixel, static_cast<LONGLONG>(m_width) * height, buffer.data(), &status);
+    if (status != 0) {
+      throw Elements::Exception() << "Error saving image rows to FITS file.";
+    }
+    i = end;
+  }
+
+  int status = 0;
+  fits_flush_buffer(fptr, 0, &status);
+}
+
+void FitsImageSource::readPixels(fitsfile *fptr, int x, int y, int width, int height, void* out) const {
+  long first_pixel[2] = {x + 1, y + 1};
+  long last_pixel[2] = {x + width, y + height};
+  long increment[2] = {1, 1};
+  int status = 0;
+
+  fits_read_subset(fptr, getDataType(), first_pixel, last_pixel, increment,
+                   nullptr, out, nullptr, &status);
+  if (status != 0) {
+    throw Elements::Exception() << "Error reading image tile from FITS file.";
+  }
+}
+
+void FitsImageSource::writeTile(fitsfile *fptr, ImageTile& tile) {
   int x = tile.getPosX();
   int y = tile.getPosY();
   int width = tile.getWidth();
@@ -221,7 +443,6 @@ void FitsImageSource::saveTile(ImageTile& tile) {
   if (status != 0) {
     throw Elements::Exception() << "Error saving image tile to FITS file.";
   }
-  fits_flush_buffer(fptr, 0, &status);
 }
 
 void FitsImageSource::switchHdu(fitsfile *fptr, int hdu_number) const {
@@ -0,0 +1,217 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * MmapFitsImageSource.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <ElementsKernel/Exception.h>
+
+#include "SEFramework/FITS/FitsDecoding.h"
+#include "SEFramework/FITS/FitsFile.h"
+#include "SEFramework/FITS/MmapFitsImageSource.h"
+
+namespace SourceXtractor {
+
+using Euclid::FilePool::FileHandler;
+
+namespace {
+
+template <typename T>
+void decodeRegion(int bitpix, const unsigned char* data, int image_width, int x, int y, int width, int height,
+                  T* output) {
+  std::size_t pixel_size = FitsDecoding::bytesPerPixel(bitpix);
+  for (int iy = 0; iy < height; ++iy) {
+    std::size_t offset = (static_cast<std::size_t>(y + iy) * image_width + x) * pixel_size;
+    decodeFitsPixels(bitpix, data + offset, output + static_cast<std::size_t>(iy) * width, width);
+  }
+}
+
+ImageTile::ImageType typeFromBitpix(int bitpix) {
+  switch (bitpix) {
+    case FLOAT_IMG:
+      return ImageTile::FloatImage;
+    case DOUBLE_IMG:
+      return ImageTile::DoubleImage;
+    case BYTE_IMG:
+    case SHORT_IMG:
+    case LONG_IMG:
+      return ImageTile::IntImage;
+    case LONGLONG_IMG:
+      return ImageTile::LongLongImage;
+    default:
+      throw Elements::Exception() << "Unsupported FITS image type: " << bitpix;
+  }
+}
+
+}  // end anonymous namespace
+
+MmapFitsImageSource::MmapFitsImageSource(const std::string& filename, int hdu_number,
+                                         ImageTile::ImageType image_type,
+                                         std::shared_ptr<FileManager> manager)
+    : m_filename(filename), m_width(0), m_height(0), m_bitpix(0), m_image_type(image_type),
+      m_mapping(nullptr), m_mapping_size(0), m_data(nullptr) {
+  int status = 0;
+  int naxis = 0;
+  long naxes[2] = {1, 1};
+  LONGLONG head_start = 0, data_start = 0, data_end = 0;
+  char disk_filename[FLEN_FILENAME];
+  char url_type[FLEN_FILENAME];
+  double bscale = 1., bzero = 0.;
+
+  {
+    auto handler = manager->getFileHandler(filename);
+    auto acc = handler->getAccessor<FitsFile>();
+    auto fptr = acc->m_fd.getFitsFilePtr();
+
+    if (hdu_number > 0) {
+      int hdu_type = 0;
+      fits_movabs_hdu(fptr, hdu_number, &hdu_type, &status);
+      if (status != 0 || hdu_type != IMAGE_HDU) {
+        throw Elements::Exception() << "Can't find image HDU # " << hdu_number << " in file " << filename;
+      }
+    }
+
+    if (fits_is_compressed_image(fptr, &status) || status != 0) {
+      throw Elements::Exception() << "Can't memory map compressed FITS image: " << filename;
+    }
+
+    fits_get_img_param(fptr, 2, &m_bitpix, &naxis, naxes, &status);
+    if (status != 0 || naxis != 2) {
+      throw Elements::Exception() << "Can't find 2D image in FITS file: " << filename;
+    }
+
+    // Scaled values are left to cfitsio
+    fits_read_key(fptr, TDOUBLE, "BSCALE", &bscale, nullptr, &status);
+    if (status == KEY_NO_EXIST) {
+      status = 0;
+    }
+    fits_read_key(fptr, TDOUBLE, "BZERO", &bzero, nullptr, &status);
+    if (status == KEY_NO_EXIST) {
+      status = 0;
+    }
+    if (status != 0 || bscale != 1. || bzero != 0.) {
+      throw Elements::Exception() << "Can't memory map scaled FITS image: " << filename;
+    }
+
+    // Only plain files on disk have their data unit where cfitsio says, i.e. not gzipped ones
+    fits_get_hduaddrll(fptr, &head_start, &data_start, &data_end, &status);
+    fits_file_name(fptr, disk_filename, &status);
+    fits_url_type(fptr, url_type, &status);
+    if (status != 0 || std::strcmp(url_type, "file://") != 0) {
+      throw Elements::Exception() << "Can't memory map FITS file not stored as a plain file: " << filename;
+    }
+  }
+
+  m_width = naxes[0];
+  m_height = naxes[1];
+  if (m_image_type < 0) {
+    m_image_type = typeFromBitpix(m_bitpix);
+  }
+
+  std::size_t data_size = static_cast<std::size_t>(m_width) * m_height * FitsDecoding::bytesPerPixel(m_bitpix);
+
+  int fd = ::open(disk_filename, O_RDONLY);
+  if (fd < 0) {
+    throw Elements::Exception() << "Can't open FITS file for memory mapping: " << disk_filename;
+  }
+
+  struct stat file_stat;
+  char signature[6] = {};
+  bool is_consistent = ::fstat(fd, &file_stat) == 0 &&
+      static_cast<std::size_t>(file_stat.st_size) >= data_start + data_size &&
+      ::pread(fd, signature, sizeof(signature), 0) == sizeof(signature) &&
+      std::memcmp(signature, "SIMPLE", sizeof(signature)) == 0;
+  if (!is_consistent || data_size == 0) {
+    ::close(fd);
+    throw Elements::Exception() << "Can't memory map FITS file: " << disk_filename;
+  }
+
+  // The mapping must start on a page boundary
+  std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+  std::size_t map_offset = data_start - data_start % page_size;
+  m_mapping_size = data_start - map_offset + data_size;
+  m_mapping = ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_SHARED, fd, map_offset);
+  ::close(fd);
+
+  if (m_mapping == MAP_FAILED) {
+    m_mapping = nullptr;
+    throw Elements::Exception() << "Failed to memory map FITS file: " << disk_filename;
+  }
+  m_data = static_cast<const unsigned char*>(m_mapping) + (data_start - map_offset);
+}
+
+MmapFitsImageSource::~MmapFitsImageSource() {
+  if (m_mapping != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+}
+
+std::shared_ptr<ImageTile> MmapFitsImageSource::getImageTile(int x, int y, int width, int height) const {
+  auto tile = ImageTile::create(m_image_type, x, y, width, height,
+                                std::const_pointer_cast<ImageSource>(shared_from_this()));
+
+  switch (m_image_type) {
+    default:
+    case ImageTile::FloatImage:
+      readPixels(x, y, width, height, static_cast<float*>(tile->getDataPtr()));
+      break;
+    case ImageTile::DoubleImage:
+      readPixels(x, y, width, height, static_cast<double*>(tile->getDataPtr()));
+      break;
+    case ImageTile::IntImage:
+      readPixels(x, y, width, height, static_cast<int*>(tile->getDataPtr()));
+      break;
+    case ImageTile::UIntImage:
+      readPixels(x, y, width, height, static_cast<unsigned int*>(tile->getDataPtr()));
+      break;
+    case ImageTile::LongLongImage:
+      readPixels(x, y, width, height, static_cast<std::int64_t*>(tile->getDataPtr()));
+      break;
+  }
+
+  return tile;
+}
+
+void MmapFitsImageSource::saveTile(ImageTile&) {
+  throw Elements::Exception() << "Memory mapped FITS images are read only: " << m_filename;
+}
+
+template <typename T>
+void MmapFitsImageSource::readPixels(int x, int y, int width, int height, T* output) const {
+  assert(x >= 0 && y >= 0 && x + width <= m_width && y + height <= m_height);
+
+  decodeRegion(m_bitpix, m_data, m_width, x, y, width, height, output);
+}
+
+template void MmapFitsImageSource::readPixels(int, int, int, int, float*) const;
+template void MmapFitsImageSource::readPixels(int, int, int, int, double*) const;
+template void MmapFitsImageSource::readPixels(int, int, int, int, int*) const;
+template void MmapFitsImageSource::readPixels(int, int, int, int, unsigned int*) const;
+template void MmapFitsImageSource::readPixels(int, int, int, int, std::int64_t*) const;
+
+}
@@ -15,6 +15,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+
 #include "SEFramework/Image/BufferedImage.h"
 #include "SEFramework/Image/ImageSource.h"
 #include "SEFramework/Image/ImageTile.h"
@@ -55,22 +57,35 @@ int BufferedImage<T>::getHeight() const {
 
 template<typename T>
 std::shared_ptr<ImageChunk<T>> BufferedImage<T>::getChunk(int x, int y, int width, int height) const {
-  int tile_width = m_tile_manager->getTileWidth();
-  int tile_height = m_tile_manager->getTileHeight();
+  int tile_width = m_tile_manager->getTileWidth(*m_source);
+  int tile_height = m_tile_manager->getTileHeight(*m_source);
   int tile_offset_x = x % tile_width;
   int tile_offset_y = y % tile_height;
 
+  // Inside a sweep, the whole region is read at once and is not cached. The chunk pins the region tile
+  if (m_tile_manager->isSweeping()) {
+    auto tile = std::dynamic_pointer_cast<ImageTileWithType<T>>(
+      m_tile_manager->readRegion(m_source, x, y, width, height));
+    assert(tile != nullptr);
+    const auto& image = tile->getImage();
+    std::shared_ptr<const std::vector<T>> tile_data(tile, &image->getData());
+    return ImageChunk<T>::create(std::move(tile_data), 0, width, height, width);
+  }
+
   // When the chunk does *not* cross boundaries, we can just use the memory hold by the single tile
   if (tile_offset_x + width <= tile_width && tile_offset_y + height <= tile_height) {
-    // the tile image is going to be kept in memory as long as the chunk exists, but it could be unloaded
-    // from TileManager and even reloaded again, wasting memory,
-    // however image chunks are normally short lived so it's probably OK
+    // The chunk is a view over the tile memory, and pins the tile itself through an aliasing pointer,
+    // so there is no allocation nor copy of pixels.
+    // The tile could be unloaded from TileManager and even reloaded again while the chunk is alive,
+    // wasting memory, however image chunks are normally short lived so it's probably OK
     auto tile = std::dynamic_pointer_cast<ImageTileWithType<T>>(m_tile_manager->getTileForPixel(x, y, m_source));
     assert(tile != nullptr);
 
     // The tile may be smaller than tile_width x tile_height if the image is smaller, or does not divide neatly!
-    auto image = tile->getImage();
-    return image->getChunk(tile_offset_x, tile_offset_y, width, height);
+    const auto& image = tile->getImage();
+    std::shared_ptr<const std::vector<T>> tile_data(tile, &image->getData());
+    return ImageChunk<T>::create(std::move(tile_data), tile_offset_x + tile_offset_y * image->getWidth(),
+                                 width, height, image->getWidth());
   }
   else {
     // If the chunk cross boundaries, we can't just use the memory from within a tile, so we need to copy
@@ -78,8 +93,8 @@ std::shared_ptr<ImageChunk<T>> BufferedImage<T>::getChunk(int x, int y, int widt
     // Also, instead of iterating on the pixel coordinates, to avoid asking several times for the same tile,
     // iterate over the tiles
     std::vector<T> data(width * height);
-    int tile_w = m_tile_manager->getTileWidth();
-    int tile_h = m_tile_manager->getTileHeight();
+    int tile_w = m_tile_manager->getTileWidth(*m_source);
+    int tile_h = m_tile_manager->getTileHeight(*m_source);
 
     int tile_start_x = x / tile_w * tile_w;
     int tile_start_y = y / tile_h * tile_h;
@@ -109,10 +124,15 @@ void BufferedImage<T>::copyOverlappingPixels(const ImageTileWithType<T> &tile, s
   int off_x = start_x - x;
   int off_y = start_y - y;
 
+  // Rows are contiguous both on the tile and on the output, so copy them in one go
+  const auto& tile_image = *tile.getImage();
+  const T* tile_data = tile_image.getData().data();
+  int tile_stride = tile_image.getWidth();
+  int row_size = end_x - start_x;
+
   for (int data_y = off_y, img_y = start_y; img_y < end_y; ++data_y, ++img_y) {
-    for (int data_x = off_x, img_x = start_x; img_x < end_x; ++data_x, ++img_x) {
-      tile.getValue(img_x, img_y, output[data_x + data_y * w]);
-    }
+    const T* src = tile_data + (start_x - tile.getPosX()) + (img_y - tile.getPosY()) * tile_stride;
+    std::copy(src, src + row_size, output.begin() + off_x + data_y * w);
   }
 }
 
@@ -0,0 +1,96 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileBufferPool.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "SEFramework/Image/TileBufferPool.h"
+
+namespace SourceXtractor {
+
+static const std::size_t s_huge_page_size = 2 * 1024 * 1024;
+
+std::atomic<long> TileBufferPool::s_max_memory(0);
+std::atomic<long> TileBufferPool::s_pooled_bytes(0);
+std::atomic<long> TileBufferPool::s_reused(0);
+std::atomic<long> TileBufferPool::s_allocated(0);
+std::atomic<long> TileBufferPool::s_discarded(0);
+std::atomic<bool> TileBufferPool::s_huge_pages(false);
+
+void TileBufferPool::setMaxMemory(long max_memory) {
+  s_max_memory = max_memory;
+  if (s_pooled_bytes > s_max_memory) {
+    clear();
+  }
+}
+
+long TileBufferPool::getMaxMemory() {
+  return s_max_memory;
+}
+
+void TileBufferPool::setHugePages(bool huge_pages) {
+  s_huge_pages = huge_pages;
+}
+
+auto TileBufferPool::getStatistics() -> Statistics {
+  return Statistics{s_reused, s_allocated, s_discarded, s_pooled_bytes};
+}
+
+long TileBufferPool::getPooledMemory() {
+  return s_pooled_bytes;
+}
+
+template <typename T>
+void TileBufferPool::clearBuffers() {
+  auto& buffers = getBuffers<T>();
+  boost::lock_guard<boost::mutex> lock(buffers.m_mutex);
+  for (auto& sized : buffers.m_free) {
+    s_pooled_bytes -= sized.first * sizeof(T) * sized.second.size();
+  }
+  buffers.m_free.clear();
+}
+
+void TileBufferPool::clear() {
+  // The types supported by ImageTile
+  clearBuffers<float>();
+  clearBuffers<double>();
+  clearBuffers<int>();
+  clearBuffers<unsigned int>();
+  clearBuffers<std::int64_t>();
+}
+
+void TileBufferPool::adviseHugePages(void* data, std::size_t bytes) {
+#ifdef MADV_HUGEPAGE
+  // Only whole huge pages within the buffer can be advised
+  auto begin = (reinterpret_cast<std::uintptr_t>(data) + s_huge_page_size - 1) & ~(s_huge_page_size - 1);
+  auto end = (reinterpret_cast<std::uintptr_t>(data) + bytes) & ~(s_huge_page_size - 1);
+  if (begin < end) {
+    madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+  }
+#else
+  (void)data;
+  (void)bytes;
+#endif
+}
+
+} /* namespace SourceXtractor */
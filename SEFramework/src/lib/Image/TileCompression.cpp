@@ -0,0 +1,229 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileCompression.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "SEFramework/Image/TileCompression.h"
+
+namespace SourceXtractor {
+
+namespace {
+
+enum Method : unsigned char {
+  STORED = 0,
+  SHUFFLED_LZ = 1
+};
+
+const std::size_t s_min_match = 4;
+const std::size_t s_max_offset = 65535;
+const int s_hash_bits = 13;
+
+inline std::uint32_t read32(const unsigned char* p) {
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline std::uint32_t hash32(std::uint32_t v) {
+  return (v * 2654435761U) >> (32 - s_hash_bits);
+}
+
+// Lengths that do not fit in the token nibble continue in bytes of 255, up to a last byte < 255
+void writeLength(std::vector<unsigned char>& out, std::size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<unsigned char>(length));
+}
+
+std::size_t readLength(const unsigned char*& in) {
+  std::size_t length = 0;
+  unsigned char b;
+  do {
+    b = *in++;
+    length += b;
+  } while (b == 255);
+  return length;
+}
+
+void writeSequence(std::vector<unsigned char>& out, const unsigned char* literals, std::size_t literal_length,
+                   std::size_t offset, std::size_t match_length) {
+  std::size_t match_code = match_length ? match_length - s_min_match : 0;
+  unsigned char token = static_cast<unsigned char>((std::min<std::size_t>(literal_length, 15) << 4) |
+                                                   std::min<std::size_t>(match_code, 15));
+  out.push_back(token);
+  if (literal_length >= 15) {
+    writeLength(out, literal_length - 15);
+  }
+  out.insert(out.end(), literals, literals + literal_length);
+  if (match_length) {
+    out.push_back(static_cast<unsigned char>(offset & 0xFF));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (match_code >= 15) {
+      writeLength(out, match_code - 15);
+    }
+  }
+}
+
+/**
+ * Greedy LZ77 with a single entry hash table. The stream is a sequence of
+ * [token][literal length][literals][offset][match length], the last sequence having no match.
+ */
+void compressLZ(const unsigned char* in, std::size_t size, std::vector<unsigned char>& out) {
+  std::vector<std::uint32_t> table(1 << s_hash_bits, 0);
+  const unsigned char* anchor = in;
+  std::size_t pos = 0;
+  // As in LZ4, the search moves faster over data that does not compress (i.e. the low bytes of noisy pixels)
+  std::size_t misses = 0;
+
+  while (size >= s_min_match && pos <= size - s_min_match) {
+    std::uint32_t sequence = read32(in + pos);
+    std::uint32_t& slot = table[hash32(sequence)];
+    std::size_t candidate = slot;
+    slot = static_cast<std::uint32_t>(pos);
+
+    if (candidate < pos && pos - candidate <= s_max_offset && read32(in + candidate) == sequence) {
+      std::size_t length = s_min_match;
+      while (pos + length < size && in[candidate + length] == in[pos + length]) {
+        ++length;
+      }
+      writeSequence(out, anchor, in + pos - anchor, pos - candidate, length);
+      pos += length;
+      anchor = in + pos;
+      misses = 0;
+    }
+    else {
+      pos += 1 + (misses++ >> 5);
+    }
+  }
+
+  writeSequence(out, anchor, in + size - anchor, 0, 0);
+}
+
+void decompressLZ(const unsigned char* in, const unsigned char* in_end, unsigned char* out, std::size_t size) {
+  unsigned char* op = out;
+  unsigned char* op_end = out + size;
+
+  while (in < in_end) {
+    unsigned char token = *in++;
+
+    std::size_t literal_length = token >> 4;
+    if (literal_length == 15) {
+      literal_length += readLength(in);
+    }
+    assert(op + literal_length <= op_end);
+    std::memcpy(op, in, literal_length);
+    op += literal_length;
+    in += literal_length;
+
+    if (in >= in_end) {
+      break;
+    }
+
+    std::size_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    std::size_t match_length = token & 0x0F;
+    if (match_length == 15) {
+      match_length += readLength(in);
+    }
+    match_length += s_min_match;
+
+    assert(offset > 0 && op - out >= static_cast<std::ptrdiff_t>(offset) && op + match_length <= op_end);
+    const unsigned char* match = op - offset;
+    if (offset >= match_length) {
+      std::memcpy(op, match, match_length);
+      op += match_length;
+    }
+    else {
+      // Overlapping match, i.e. a run
+      for (std::size_t i = 0; i < match_length; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+  assert(op == op_end);
+  (void)op_end;
+}
+
+}  // end anonymous namespace
+
+std::vector<unsigned char> compressTileData(const void* data, std::size_t element_size, std::size_t count) {
+  const std::size_t size = element_size * count;
+  auto bytes = static_cast<const unsigned char*>(data);
+  if (size == 0) {
+    return {STORED};
+  }
+
+  static thread_local std::vector<unsigned char> shuffled, buffer;
+  shuffled.resize(size);
+  for (std::size_t b = 0; b < element_size; ++b) {
+    unsigned char* plane = shuffled.data() + b * count;
+    for (std::size_t i = 0; i < count; ++i) {
+      plane[i] = bytes[i * element_size + b];
+    }
+  }
+
+  buffer.clear();
+  buffer.push_back(SHUFFLED_LZ);
+  compressLZ(shuffled.data(), size, buffer);
+
+  if (buffer.size() >= size + 1) {
+    std::vector<unsigned char> stored(size + 1);
+    stored[0] = STORED;
+    std::memcpy(stored.data() + 1, bytes, size);
+    return stored;
+  }
+  return std::vector<unsigned char>(buffer.begin(), buffer.end());
+}
+
+void decompressTileData(const std::vector<unsigned char>& compressed, std::size_t element_size, std::size_t count,
+                        void* output) {
+  const std::size_t size = element_size * count;
+  auto bytes = static_cast<unsigned char*>(output);
+  assert(!compressed.empty());
+  if (size == 0) {
+    return;
+  }
+
+  if (compressed[0] == STORED) {
+    assert(compressed.size() == size + 1);
+    std::memcpy(bytes, compressed.data() + 1, size);
+    return;
+  }
+
+  static thread_local std::vector<unsigned char> shuffled;
+  shuffled.resize(size);
+  decompressLZ(compressed.data() + 1, compressed.data() + compressed.size(), shuffled.data(), size);
+
+  for (std::size_t b = 0; b < element_size; ++b) {
+    const unsigned char* plane = shuffled.data() + b * count;
+    for (std::size_t i = 0; i < count; ++i) {
+      bytes[i * element_size + b] = plane[i];
+    }
+  }
+}
+
+} /* namespace SourceXtractor */
@@ -21,6 +21,12 @@
  *      Author: mschefer
  */
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "SEFramework/Image/TileBufferPool.h"
+#include "SEFramework/Image/TileCompression.h"
 #include "SEFramework/Image/TileManager.h"
 
 namespace SourceXtractor {
@@ -28,108 +34,266 @@ namespace SourceXtractor {
 static std::shared_ptr<TileManager> s_instance;
 static Elements::Logging s_tile_logger = Elements::Logging::getLogger("TileManager");
 
+// Each shard must be able to hold enough tiles for the LRU policy to be meaningful
+static const long s_min_tiles_per_shard = 16;
+static const size_t s_max_shards = 64;
+// Modified tiles are written back once they use this fraction of the memory limit. The threads evicting them
+// have to wait only if they reach twice as much, meaning the writes can not keep up.
+static const long s_write_back_fraction = 8;
+// Share of the memory limit set aside for recycling the buffers of the evicted tiles
+static const long s_buffer_pool_fraction = 16;
+// Number of Sweep instances alive on this thread
+static thread_local int s_sweep_depth = 0;
+
+// Closest multiple of the native size below the requested size, but at least the native size
+static int alignTileSize(int size, int native_size) {
+  if (native_size <= 0) {
+    return size;
+  }
+  return std::max(native_size, size / native_size * native_size);
+}
+
 bool TileKey::operator==(const TileKey& other) const {
   return m_source == other.m_source && m_tile_x == other.m_tile_x && m_tile_y == other.m_tile_y;
 }
 
 std::string TileKey::getRepr() const {
   std::ostringstream str;
-  str << m_source.get() << "[" << m_source->getRepr() << "] " << m_tile_x << "," << m_tile_y;
+  str << m_source << "[" << m_source->getRepr() << "] " << m_tile_x << "," << m_tile_y;
   return str.str();
 }
 
 
 TileManager::TileManager() : m_tile_width(256), m_tile_height(256),
-                             m_max_memory(100 * 1024L * 1024L), m_total_memory_used(0) {
+                             m_max_memory(100 * 1024L * 1024L), m_max_compressed_memory(0), m_read_ahead(0), m_streaming(false),
+                             m_read_ahead_busy(false), m_read_ahead_stop(false),
+                             m_memory_hits(0), m_compressed_hits(0), m_source_reads(0),
+                             m_write_back_busy(false), m_write_back_stop(false), m_dirty_memory(0) {
+  createShards();
+  m_write_back_thread = std::thread(&TileManager::writeBackLoop, this);
 }
 
 TileManager::~TileManager() {
-  saveAllTiles();
+  stopReadAhead();
+  stopWriteBack();
+  try {
+    saveAllTiles();
+  }
+  catch (const std::exception& e) {
+    s_tile_logger.error() << "Failed to save the image tiles: " << e.what();
+  }
 }
 
-void TileManager::setOptions(int tile_width, int tile_height, int max_memory) {
+void TileManager::setOptions(int tile_width, int tile_height, int max_memory, int read_ahead,
+                             int max_compressed_memory) {
   flush();
 
-  boost::lock_guard<boost::shared_mutex> wr_lock(m_mutex);
-  m_tile_width = tile_width;
-  m_tile_height = tile_height;
-  m_max_memory = max_memory * 1024L * 1024L;
+  {
+    // The write-back thread must not be going through the shards
+    boost::unique_lock<boost::mutex> lock(m_write_back_mutex);
+    m_write_back_idle.wait(lock, [this]() { return !m_write_back_busy; });
+
+    m_tile_width = tile_width;
+    m_tile_height = tile_height;
+    m_max_memory = max_memory * 1024L * 1024L;
+    m_max_compressed_memory = max_compressed_memory * 1024L * 1024L;
+    createShards();
+  }
+
+  m_read_ahead = read_ahead;
+  if (m_read_ahead > 0 && !m_read_ahead_thread.joinable()) {
+    m_read_ahead_stop = false;
+    m_read_ahead_thread = std::thread(&TileManager::readAheadLoop, this);
+  }
+  else if (m_read_ahead <= 0) {
+    stopReadAhead();
+  }
 }
 
 void TileManager::flush() {
+  // drop pending read-ahead requests, and wait for the one being served, or it could
+  // bring back tiles after the cache has been emptied
+  {
+    boost::unique_lock<boost::mutex> lock(m_read_ahead_mutex);
+    m_read_ahead_queue.clear();
+    m_read_ahead_idle.wait(lock, [this]() { return !m_read_ahead_busy; });
+  }
+
   // empty anything still stored in cache
   saveAllTiles();
 
-  boost::lock_guard<boost::shared_mutex> wr_lock(m_mutex);
-  m_tile_list.clear();
-  m_tile_map.clear();
-  m_total_memory_used = 0;
-}
+  for (auto& shard : m_shards) {
+    boost::lock_guard<boost::mutex> lock(shard->m_mutex);
+    shard->m_lru_list.clear();
+    shard->m_tile_map.clear();
+    shard->m_memory_used = 0;
+    shard->m_compressed_lru_list.clear();
+    shard->m_compressed_map.clear();
+    shard->m_compressed_memory_used = 0;
+    shard->m_evicted.clear();
+    shard->m_source_counters.clear();
+  }
 
-/*
- * boost::upgrade_lock can only be acquired by a single thread, even if none of them
- * ends needing an exclusive lock. Cache lookup must be done with a shared_lock instead
- * so multiples can retrieve from the cache at the same time.
- */
-std::shared_ptr<ImageTile> TileManager::tryTileFromCache(const TileKey& key) {
-  boost::shared_lock<boost::shared_mutex> shared_rd_lock(m_mutex);
+  auto stats = getStatistics();
+  long requests = stats.m_memory_hits + stats.m_compressed_hits + stats.m_source_reads;
+  if (requests > 0) {
+    s_tile_logger.info() << "Tile cache: " << requests << " requests, memory tier "
+                         << stats.m_memory_hits << " hits / " << requests - stats.m_memory_hits << " misses";
+    if (m_max_compressed_memory > 0) {
+      s_tile_logger.info() << "Tile cache: compressed tier " << stats.m_compressed_hits << " hits / "
+                           << stats.m_source_reads << " misses";
+    }
+  }
+  m_memory_hits = 0;
+  m_compressed_hits = 0;
+  m_source_reads = 0;
+
+  logSourceStatistics();
+  {
+    boost::lock_guard<boost::mutex> lock(m_counters_mutex);
+    m_source_counters.clear();
+  }
+  {
+    boost::lock_guard<boost::mutex> lock(m_source_mutexes_mutex);
+    m_source_mutexes.clear();
+  }
 
-  auto it = m_tile_map.find(key);
-  if (it != m_tile_map.end()) {
-#ifndef NDEBUG
-    s_tile_logger.debug() << "Cache hit " << key;
-#endif
-    return std::dynamic_pointer_cast<ImageTile>(it->second);
+  auto pool_stats = TileBufferPool::getStatistics();
+  if (pool_stats.m_allocated > 0) {
+    s_tile_logger.info() << "Tile buffers: " << pool_stats.m_reused << " reused, " << pool_stats.m_allocated
+                         << " allocated, " << pool_stats.m_discarded << " discarded, "
+                         << pool_stats.m_pooled_bytes / (1024 * 1024) << " MB pooled";
   }
-  return nullptr;
 }
 
 /*
- * If the mutex does not exist, we need an upgradable lock
+ * The number of shards is a power of two, as big as possible while still allowing each shard
+ * to keep a reasonable number of tiles within its share of the memory limit.
+ * We assume the worst case of 8 bytes per pixel.
  */
-std::shared_ptr<boost::mutex>& TileManager::getMutexForImageSource(const ImageSource *src_ptr) {
-  boost::upgrade_lock<boost::shared_mutex> upgrade_lock(m_mutex);
-  auto mit = m_mutex_map.find(src_ptr);
-  if (mit == m_mutex_map.end()) {
-    boost::upgrade_to_unique_lock<boost::shared_mutex> unique_lock(upgrade_lock);
-    mit = m_mutex_map.emplace(src_ptr, std::make_shared<boost::mutex>()).first;
+void TileManager::createShards() {
+  // The memory of the idle buffers kept by the pool is taken from the limit
+  long buffer_pool_memory = m_max_memory / s_buffer_pool_fraction;
+  long tile_memory = m_max_memory - buffer_pool_memory;
+  TileBufferPool::setMaxMemory(buffer_pool_memory);
+
+  long tile_size = static_cast<long>(m_tile_width) * m_tile_height * sizeof(double);
+  size_t nshards = 1;
+  while (nshards < s_max_shards &&
+         tile_memory / static_cast<long>(nshards * 2) >= tile_size * s_min_tiles_per_shard) {
+    nshards *= 2;
   }
-  return mit->second;
-}
 
-std::shared_ptr<ImageTile> TileManager::getTileForPixel(int x, int y,
-                                                        std::shared_ptr<const ImageSource> source) {
-  x = x / m_tile_width * m_tile_width;
-  y = y / m_tile_height * m_tile_height;
-  TileKey key{std::static_pointer_cast<const ImageSource>(source), x, y};
-
-  // Try from the cache, this can be done by multiple threads in parallel
-  auto tile = tryTileFromCache(key);
-  if (tile) {
-    return tile;
+  m_shards.clear();
+  for (size_t i = 0; i < nshards; ++i) {
+    m_shards.emplace_back(new Shard);
+    m_shards.back()->m_max_memory = tile_memory / static_cast<long>(nshards);
+    m_shards.back()->m_memory_used = 0;
+    m_shards.back()->m_max_compressed_memory = m_max_compressed_memory / static_cast<long>(nshards);
+    m_shards.back()->m_compressed_memory_used = 0;
   }
+}
 
-  // Cache miss, we need to ask the underlying source.
-  // First, we need a mutex only for that source, and that needs writing to the tile manager.
-  auto img_mutex = getMutexForImageSource(source.get());
+auto TileManager::getShard(const TileKey& key) -> Shard& {
+  return *m_shards[std::hash<TileKey>()(key) & (m_shards.size() - 1)];
+}
 
-  // Here we block access only to this specific image source
-  boost::lock_guard<boost::mutex> img_lock(*img_mutex);
+std::shared_ptr<ImageTile> TileManager::getTileForPixel(int x, int y,
+                                                        const std::shared_ptr<const ImageSource>& source) {
+  int tile_width = getTileWidth(*source);
+  int tile_height = getTileHeight(*source);
+  x = x / tile_width * tile_width;
+  y = y / tile_height * tile_height;
+  TileKey key{source.get(), x, y};
+  auto& shard = getShard(key);
+
+  boost::unique_lock<boost::mutex> lock(shard.m_mutex);
+  while (true) {
+    auto it = shard.m_tile_map.find(key);
+    if (it != shard.m_tile_map.end()) {
+#ifndef NDEBUG
+      s_tile_logger.debug() << "Cache hit " << key;
+#endif
+      shard.m_lru_list.splice(shard.m_lru_list.begin(), shard.m_lru_list, it->second.m_lru_position);
+      ++m_memory_hits;
+      ++it->second.m_counters->m_hits;
+      return it->second.m_tile;
+    }
+    // If another thread is already reading this tile, wait for it instead of reading it twice
+    if (shard.m_loading.count(key) == 0) {
+      break;
+    }
+    shard.m_tile_loaded.wait(lock);
+  }
 
-  // Try again from the cache, maybe someone put it there while we waited for the image lock
-  tile = tryTileFromCache(key);
-  if (tile) {
+  // A modified tile waiting to be written back is more recent than its source
+  auto dirty_it = shard.m_dirty_map.find(key);
+  if (dirty_it != shard.m_dirty_map.end()) {
+    auto tile = std::move(dirty_it->second.m_tile);
+    auto counters = std::move(dirty_it->second.m_counters);
+    m_dirty_memory -= tile->getTileMemorySize();
+    shard.m_dirty_map.erase(dirty_it);
+    ++m_memory_hits;
+    ++counters->m_hits;
+    addTile(shard, key, source, tile, std::move(counters));
+    removeExtraTiles(shard);
+    compressEvictedTiles(shard, lock);
+    lock.unlock();
+    throttleWriteBack();
     return tile;
   }
 
-  tile = source->getImageTile(x, y,
-                              std::min(m_tile_width, source->getWidth() - x),
-                              std::min(m_tile_height, source->getHeight() - y));
+  // If the tile is in the compressed tier, take it out: it is compressed again if it gets evicted again
+  CompressedTileEntry compressed;
+  bool is_compressed = false;
+  auto compressed_it = shard.m_compressed_map.find(key);
+  if (compressed_it != shard.m_compressed_map.end()) {
+    is_compressed = true;
+    shard.m_compressed_memory_used -= compressed_it->second.m_data.size();
+    shard.m_compressed_lru_list.erase(compressed_it->second.m_lru_position);
+    compressed = std::move(compressed_it->second);
+    shard.m_compressed_map.erase(compressed_it);
+  }
+
+  // Cache miss, we need to decompress the tile or ask the underlying source.
+  // This is done without holding the lock, so other tiles - even from the same source - can be
+  // retrieved or loaded meanwhile. Note that the source may depend on other buffered images.
+  std::shared_ptr<SourceCounters> counters;
+  if (!is_compressed) {
+    counters = getSourceCounters(shard, source);
+  }
+  shard.m_loading.insert(key);
+  lock.unlock();
+
+  std::shared_ptr<ImageTile> tile;
+  try {
+    if (is_compressed) {
+      tile = decompressTile(key, compressed);
+      counters = std::move(compressed.m_counters);
+      ++m_compressed_hits;
+      ++counters->m_hits;
+    }
+    else {
+      tile = readFromSource(*source, *counters, x, y,
+                            std::min(tile_width, source->getWidth() - x),
+                            std::min(tile_height, source->getHeight() - y));
+    }
+  }
+  catch (...) {
+    lock.lock();
+    shard.m_loading.erase(key);
+    shard.m_tile_loaded.notify_all();
+    throw;
+  }
 
-  // Here we need to acquire the mutex in write mode!
-  boost::lock_guard<boost::shared_mutex> wr_lock(m_mutex);
-  addTile(key, std::static_pointer_cast<ImageTile>(tile));
-  removeExtraTiles();
+  lock.lock();
+  shard.m_loading.erase(key);
+  addTile(shard, key, source, tile, std::move(counters));
+  removeExtraTiles(shard);
+  shard.m_tile_loaded.notify_all();
+  compressEvictedTiles(shard, lock);
+  lock.unlock();
+  throttleWriteBack();
   return tile;
 }
 
@@ -141,10 +305,40 @@ std::shared_ptr<TileManager> TileManager::getInstance() {
 }
 
 void TileManager::saveAllTiles() {
-  boost::lock_guard<boost::shared_mutex> wr_lock(m_mutex);
+  // Take the place of the write-back thread
+  {
+    boost::unique_lock<boost::mutex> lock(m_write_back_mutex);
+    m_write_back_idle.wait(lock, [this]() { return !m_write_back_busy; });
+    m_write_back_busy = true;
+    // The tiles that failed before are still there, and are written again below. If they fail again,
+    // that is what gets reported
+    m_write_back_error = nullptr;
+  }
 
-  for (auto tile_key : m_tile_list) {
-    m_tile_map.at(tile_key)->saveIfModified();
+  writeBack();
+
+  // Modified tiles still cached are written too, but they stay in the cache
+  std::vector<std::pair<TileKey, TileEntry>> modified;
+  for (auto& shard : m_shards) {
+    boost::lock_guard<boost::mutex> lock(shard->m_mutex);
+    for (auto& entry : shard->m_tile_map) {
+      if (entry.second.m_tile->isModified()) {
+        modified.emplace_back(entry);
+      }
+    }
+  }
+  writeTiles(modified);
+
+  std::exception_ptr error;
+  {
+    boost::lock_guard<boost::mutex> lock(m_write_back_mutex);
+    m_write_back_busy = false;
+    std::swap(error, m_write_back_error);
+    m_write_back_idle.notify_all();
+    m_write_back_queued.notify_all();
+  }
+  if (error) {
+    std::rethrow_exception(error);
   }
 }
 
@@ -156,36 +350,419 @@ int TileManager::getTileHeight() const {
   return m_tile_height;
 }
 
-void TileManager::removeTile(TileKey tile_key) {
+int TileManager::getTileWidth(const ImageSource& source) const {
+  return alignTileSize(m_tile_width, source.getNativeTileSize().first);
+}
+
+int TileManager::getTileHeight(const ImageSource& source) const {
+  // Wider tiles are made shorter, so the memory used by each stays about the same
+  long width = getTileWidth(source);
+  int height = static_cast<int>(std::max(1L, static_cast<long>(m_tile_width) * m_tile_height / width));
+  return alignTileSize(height, source.getNativeTileSize().second);
+}
+
+int TileManager::getReadAhead() const {
+  return m_read_ahead;
+}
+
+TileManager::Sweep::Sweep() {
+  ++s_sweep_depth;
+}
+
+TileManager::Sweep::~Sweep() {
+  --s_sweep_depth;
+}
+
+void TileManager::setStreaming(bool streaming) {
+  m_streaming = streaming;
+}
+
+bool TileManager::isStreaming() const {
+  return m_streaming;
+}
+
+bool TileManager::isSweeping() const {
+  return m_streaming && s_sweep_depth > 0;
+}
+
+std::shared_ptr<ImageTile> TileManager::readRegion(const std::shared_ptr<const ImageSource>& source,
+                                                   int x, int y, int width, int height) {
+  auto counters = getSourceCounters(*source);
+  return readFromSource(*source, *counters, x, y, width, height);
+}
+
+std::shared_ptr<ImageTile> TileManager::readFromSource(const ImageSource& source, SourceCounters& counters,
+                                                       int x, int y, int width, int height) {
+  // Sources that are not re-entrant are read by one thread at a time
+  boost::unique_lock<boost::mutex> source_lock;
+  if (!source.isReentrant()) {
+    source_lock = boost::unique_lock<boost::mutex>(*getMutexForImageSource(&source));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto tile = source.getImageTile(x, y, width, height);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  ++m_source_reads;
+  ++counters.m_misses;
+  counters.m_bytes_read += tile->getTileMemorySize();
+  counters.m_read_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  return tile;
+}
+
+std::shared_ptr<boost::mutex> TileManager::getMutexForImageSource(const ImageSource* source) {
+  boost::lock_guard<boost::mutex> lock(m_source_mutexes_mutex);
+  auto& source_mutex = m_source_mutexes[source];
+  if (!source_mutex) {
+    source_mutex = std::make_shared<boost::mutex>();
+  }
+  return source_mutex;
+}
+
+auto TileManager::getStatistics() const -> Statistics {
+  return Statistics{m_memory_hits, m_compressed_hits, m_source_reads};
+}
+
+auto TileManager::getSourceStatistics() const -> std::vector<SourceStatistics> {
+  std::vector<SourceStatistics> stats;
+  {
+    boost::lock_guard<boost::mutex> lock(m_counters_mutex);
+    for (auto& entry : m_source_counters) {
+      auto& counters = *entry.second;
+      stats.emplace_back(SourceStatistics{
+        entry.first, counters.m_hits, counters.m_misses, counters.m_evictions,
+        counters.m_bytes_read, counters.m_bytes_written, counters.m_read_nanoseconds * 1e-9
+      });
+    }
+  }
+  std::stable_sort(stats.begin(), stats.end(), [](const SourceStatistics& a, const SourceStatistics& b) {
+    return a.m_misses > b.m_misses;
+  });
+  return stats;
+}
+
+auto TileManager::getSourceCounters(const ImageSource& source) -> std::shared_ptr<SourceCounters> {
+  auto repr = source.getRepr();
+  boost::lock_guard<boost::mutex> lock(m_counters_mutex);
+  auto& counters = m_source_counters[repr];
+  if (!counters) {
+    counters = std::make_shared<SourceCounters>();
+  }
+  return counters;
+}
+
+auto TileManager::getSourceCounters(Shard& shard, const std::shared_ptr<const ImageSource>& source)
+    -> std::shared_ptr<SourceCounters> {
+  auto it = shard.m_source_counters.find(source.get());
+  // The address may belong to a source already gone, then the weak pointer is owned by another one
+  if (it != shard.m_source_counters.end() && !it->second.m_source.owner_before(source) &&
+      !source.owner_before(it->second.m_source)) {
+    return it->second.m_counters;
+  }
+  // Drop the dead sources here, this only happens once per source and shard
+  for (auto i = shard.m_source_counters.begin(); i != shard.m_source_counters.end();) {
+    if (i->second.m_source.expired()) {
+      i = shard.m_source_counters.erase(i);
+    }
+    else {
+      ++i;
+    }
+  }
+  auto counters = getSourceCounters(*source);
+  shard.m_source_counters[source.get()] = SourceCountersEntry{source, counters};
+  return counters;
+}
+
+void TileManager::logSourceStatistics() const {
+  auto stats = getSourceStatistics();
+  if (stats.empty()) {
+    return;
+  }
+
+  s_tile_logger.info() << std::setw(10) << "Hits" << std::setw(10) << "Misses" << std::setw(10) << "Evictions"
+                       << std::setw(10) << "Read MB" << std::setw(11) << "Written MB" << std::setw(10) << "Read s"
+                       << "  Source";
+  for (auto& s : stats) {
+    s_tile_logger.info() << std::setw(10) << s.m_hits << std::setw(10) << s.m_misses << std::setw(10) << s.m_evictions
+                         << std::fixed << std::setprecision(1)
+                         << std::setw(10) << s.m_bytes_read / (1024. * 1024.)
+                         << std::setw(11) << s.m_bytes_written / (1024. * 1024.)
+                         << std::setprecision(2) << std::setw(10) << s.m_read_time
+                         << "  " << s.m_repr;
+  }
+}
+
+void TileManager::queueReadAhead(std::function<void()> request) {
+  boost::lock_guard<boost::mutex> lock(m_read_ahead_mutex);
+  m_read_ahead_queue.emplace_back(std::move(request));
+  while (m_read_ahead_queue.size() > static_cast<size_t>(m_read_ahead)) {
+    m_read_ahead_queue.pop_front();
+  }
+  m_read_ahead_queued.notify_one();
+}
+
+void TileManager::readAheadLoop() {
+  boost::unique_lock<boost::mutex> lock(m_read_ahead_mutex);
+  while (true) {
+    m_read_ahead_queued.wait(lock, [this]() { return m_read_ahead_stop || !m_read_ahead_queue.empty(); });
+    if (m_read_ahead_stop) {
+      break;
+    }
+
+    auto request = std::move(m_read_ahead_queue.front());
+    m_read_ahead_queue.pop_front();
+    m_read_ahead_busy = true;
+    lock.unlock();
+
+    // If this fails, the caller will find the same error when it gets there
+    try {
+      request();
+    }
+    catch (const std::exception& e) {
+      s_tile_logger.debug() << "Read-ahead failed: " << e.what();
+    }
+    request = nullptr;
+
+    lock.lock();
+    m_read_ahead_busy = false;
+    m_read_ahead_idle.notify_all();
+  }
+}
+
+void TileManager::stopReadAhead() {
+  {
+    boost::lock_guard<boost::mutex> lock(m_read_ahead_mutex);
+    m_read_ahead_stop = true;
+    m_read_ahead_queue.clear();
+    m_read_ahead_queued.notify_all();
+  }
+  if (m_read_ahead_thread.joinable()) {
+    m_read_ahead_thread.join();
+  }
+}
+
+void TileManager::removeTile(Shard& shard, std::list<TileKey>::iterator lru_position) {
 #ifndef NDEBUG
-  s_tile_logger.debug() << "Cache eviction " << tile_key;
+  s_tile_logger.debug() << "Cache eviction " << *lru_position;
 #endif
 
-  auto& tile = m_tile_map.at(tile_key);
+  auto it = shard.m_tile_map.find(*lru_position);
+  assert(it != shard.m_tile_map.end());
 
-  tile->saveIfModified();
-  m_total_memory_used -= tile->getTileMemorySize();
+  long tile_size = it->second.m_tile->getTileMemorySize();
+  shard.m_memory_used -= tile_size;
+  ++it->second.m_counters->m_evictions;
 
-  m_tile_map.erase(tile_key);
+  if (it->second.m_tile->isModified()) {
+    // Written in the background, so the thread evicting the tile does not wait for it
+    m_dirty_memory += tile_size;
+    shard.m_dirty_map.emplace(it->first, std::move(it->second));
+  }
+  else if (shard.m_max_compressed_memory > 0) {
+    shard.m_evicted.emplace_back(it->first, std::move(it->second));
+  }
+  shard.m_tile_map.erase(it);
+  shard.m_lru_list.erase(lru_position);
 }
 
-void TileManager::removeExtraTiles() {
-  while (m_total_memory_used > m_max_memory) {
-    assert(m_tile_list.size() > 0);
-    auto tile_to_remove = m_tile_list.back();
-    removeTile(tile_to_remove);
-    m_tile_list.pop_back();
+void TileManager::removeExtraTiles(Shard& shard) {
+  while (shard.m_memory_used > shard.m_max_memory) {
+    assert(shard.m_lru_list.size() > 0);
+    removeTile(shard, std::prev(shard.m_lru_list.end()));
   }
 }
 
-void TileManager::addTile(TileKey key, std::shared_ptr<ImageTile> tile) {
+void TileManager::addTile(Shard& shard, const TileKey& key, const std::shared_ptr<const ImageSource>& source,
+                          std::shared_ptr<ImageTile> tile, std::shared_ptr<SourceCounters> counters) {
 #ifndef NDEBUG
   s_tile_logger.debug() << "Cache miss " << key;
 #endif
 
-  m_tile_map[key] = tile;
-  m_tile_list.push_front(key);
-  m_total_memory_used += tile->getTileMemorySize();
+  shard.m_lru_list.push_front(key);
+  shard.m_memory_used += tile->getTileMemorySize();
+  shard.m_tile_map.emplace(key, TileEntry{source, std::move(tile), shard.m_lru_list.begin(), std::move(counters)});
+}
+
+std::shared_ptr<ImageTile> TileManager::decompressTile(const TileKey& key, const CompressedTileEntry& entry) {
+  auto tile = ImageTile::create(entry.m_type, key.m_tile_x, key.m_tile_y, entry.m_width, entry.m_height,
+                                std::const_pointer_cast<ImageSource>(entry.m_source));
+  decompressTileData(entry.m_data, ImageTile::getTypeSize(entry.m_type),
+                     static_cast<size_t>(entry.m_width) * entry.m_height, tile->getDataPtr());
+  return tile;
+}
+
+void TileManager::compressEvictedTiles(Shard& shard, boost::unique_lock<boost::mutex>& lock) {
+  if (shard.m_evicted.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<TileKey, TileEntry>> evicted;
+  std::swap(evicted, shard.m_evicted);
+  lock.unlock();
+
+  std::vector<std::pair<TileKey, CompressedTileEntry>> compressed;
+  compressed.reserve(evicted.size());
+  for (auto& e : evicted) {
+    auto& tile = *e.second.m_tile;
+    compressed.emplace_back(e.first, CompressedTileEntry{
+      std::move(e.second.m_source), std::move(e.second.m_counters), tile.getType(), tile.getWidth(), tile.getHeight(),
+      compressTileData(tile.getDataPtr(), ImageTile::getTypeSize(tile.getType()),
+                       static_cast<size_t>(tile.getWidth()) * tile.getHeight()),
+      {}
+    });
+  }
+  evicted.clear();
+
+  lock.lock();
+  for (auto& c : compressed) {
+    // The tile may have been read again from its source meanwhile
+    if (shard.m_tile_map.count(c.first) || shard.m_loading.count(c.first) || shard.m_compressed_map.count(c.first)) {
+      continue;
+    }
+    shard.m_compressed_lru_list.push_front(c.first);
+    c.second.m_lru_position = shard.m_compressed_lru_list.begin();
+    shard.m_compressed_memory_used += c.second.m_data.size();
+    shard.m_compressed_map.emplace(c.first, std::move(c.second));
+  }
+  while (shard.m_compressed_memory_used > shard.m_max_compressed_memory) {
+    assert(shard.m_compressed_lru_list.size() > 0);
+    removeCompressedTile(shard, std::prev(shard.m_compressed_lru_list.end()));
+  }
+}
+
+void TileManager::removeCompressedTile(Shard& shard, std::list<TileKey>::iterator lru_position) {
+  auto it = shard.m_compressed_map.find(*lru_position);
+  assert(it != shard.m_compressed_map.end());
+
+  shard.m_compressed_memory_used -= it->second.m_data.size();
+  shard.m_compressed_map.erase(it);
+  shard.m_compressed_lru_list.erase(lru_position);
+}
+
+auto TileManager::writeTiles(std::vector<std::pair<TileKey, TileEntry>>& tiles)
+-> std::vector<std::pair<TileKey, TileEntry>>::iterator {
+  // Sort by source, then by row and column, so each source gets its tiles in file order
+  std::sort(tiles.begin(), tiles.end(), [](const std::pair<TileKey, TileEntry>& a, const std::pair<TileKey, TileEntry>& b) {
+    if (a.first.m_source != b.first.m_source) {
+      return std::less<const ImageSource*>()(a.first.m_source, b.first.m_source);
+    }
+    if (a.first.m_tile_y != b.first.m_tile_y) {
+      return a.first.m_tile_y < b.first.m_tile_y;
+    }
+    return a.first.m_tile_x < b.first.m_tile_x;
+  });
+
+  std::unordered_set<const ImageSource*> failed;
+  auto begin = tiles.begin();
+  while (begin != tiles.end()) {
+    auto end = std::find_if(begin, tiles.end(), [begin](const std::pair<TileKey, TileEntry>& e) {
+      return e.first.m_source != begin->first.m_source;
+    });
+
+    std::vector<std::shared_ptr<ImageTile>> batch;
+    for (auto i = begin; i != end; ++i) {
+      // Cleared before writing, so a modification done meanwhile is not lost
+      i->second.m_tile->setModified(false);
+      batch.emplace_back(i->second.m_tile);
+    }
+
+    try {
+      std::const_pointer_cast<ImageSource>(begin->second.m_source)->saveTiles(batch);
+      for (auto i = begin; i != end; ++i) {
+        i->second.m_counters->m_bytes_written += i->second.m_tile->getTileMemorySize();
+      }
+    }
+    catch (...) {
+      // Nothing is lost: the tiles are written again by the next attempt
+      for (auto i = begin; i != end; ++i) {
+        i->second.m_tile->setModified(true);
+      }
+      failed.insert(begin->first.m_source);
+      boost::lock_guard<boost::mutex> lock(m_write_back_mutex);
+      if (!m_write_back_error) {
+        m_write_back_error = std::current_exception();
+      }
+    }
+    begin = end;
+  }
+
+  return std::stable_partition(tiles.begin(), tiles.end(), [&failed](const std::pair<TileKey, TileEntry>& e) {
+    return failed.count(e.first.m_source) == 0;
+  });
+}
+
+void TileManager::writeBack() {
+  std::vector<std::pair<TileKey, TileEntry>> tiles;
+  for (auto& shard : m_shards) {
+    boost::lock_guard<boost::mutex> lock(shard->m_mutex);
+    for (auto& entry : shard->m_dirty_map) {
+      // Until written, requests for the tile wait as if it was being loaded
+      shard->m_loading.insert(entry.first);
+      tiles.emplace_back(entry.first, std::move(entry.second));
+    }
+    shard->m_dirty_map.clear();
+  }
+
+  auto failed = writeTiles(tiles);
+
+  for (auto i = tiles.begin(); i != tiles.end(); ++i) {
+    auto& shard = getShard(i->first);
+    boost::lock_guard<boost::mutex> lock(shard.m_mutex);
+    // The tiles that could not be written wait for the next attempt
+    if (i >= failed) {
+      shard.m_dirty_map.emplace(i->first, std::move(i->second));
+    }
+    else {
+      m_dirty_memory -= i->second.m_tile->getTileMemorySize();
+    }
+    shard.m_loading.erase(i->first);
+    shard.m_tile_loaded.notify_all();
+  }
+}
+
+void TileManager::writeBackLoop() {
+  boost::unique_lock<boost::mutex> lock(m_write_back_mutex);
+  while (true) {
+    m_write_back_queued.wait(lock, [this]() {
+      return m_write_back_stop ||
+             (!m_write_back_busy && !m_write_back_error && m_dirty_memory >= m_max_memory / s_write_back_fraction);
+    });
+    if (m_write_back_stop) {
+      break;
+    }
+
+    m_write_back_busy = true;
+    lock.unlock();
+    writeBack();
+    lock.lock();
+    m_write_back_busy = false;
+    m_write_back_idle.notify_all();
+  }
+}
+
+void TileManager::throttleWriteBack() {
+  long threshold = m_max_memory / s_write_back_fraction;
+  if (m_dirty_memory < threshold) {
+    return;
+  }
+
+  boost::unique_lock<boost::mutex> lock(m_write_back_mutex);
+  m_write_back_queued.notify_one();
+  m_write_back_idle.wait(lock, [this, threshold]() {
+    // If the writes are failing, there is no point waiting: the error is reported by saveAllTiles
+    return m_write_back_stop || m_write_back_error || m_dirty_memory < 2 * threshold;
+  });
+}
+
+void TileManager::stopWriteBack() {
+  {
+    boost::lock_guard<boost::mutex> lock(m_write_back_mutex);
+    m_write_back_stop = true;
+    m_write_back_queued.notify_all();
+    m_write_back_idle.notify_all();
+  }
+  if (m_write_back_thread.joinable()) {
+    m_write_back_thread.join();
+  }
 }
 
 }
@@ -0,0 +1,98 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <fstream>
+#include <boost/test/unit_test.hpp>
+#include "ElementsKernel/Temporary.h"
+#include "SEFramework/Convolution/ConvolutionProfile.h"
+
+using namespace SourceXtractor;
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ConvolutionProfile_test)
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( Uncalibrated_test ) {
+  ConvolutionProfile profile;
+  BOOST_CHECK(!profile.isCalibrated());
+  BOOST_CHECK(profile.select(256, 256, 5, 5) == ConvolutionProfile::Engine::DIRECT);
+  BOOST_CHECK(profile.select(256, 256, 7, 7) == ConvolutionProfile::Engine::DFT);
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( LoadSelect_test ) {
+  Elements::TempFile profile_file;
+  {
+    std::ofstream output(profile_file.path().native());
+    output << "# Convolution profile\n" << "cpu " << ConvolutionProfile::getCpuIdentifier() << "\n"
+           << "64 3 1 2\n"
+           << "64 15 3 2\n"
+           << "256 3 4 5\n"
+           << "256 15 9 5\n";
+  }
+
+  auto profile = ConvolutionProfile::load(profile_file.path().native());
+  BOOST_REQUIRE(profile);
+  BOOST_CHECK(profile->isCalibrated());
+
+  // Nearest measure
+  BOOST_CHECK(profile->select(50, 80, 3, 3) == ConvolutionProfile::Engine::DIRECT);
+  BOOST_CHECK(profile->select(64, 64, 13, 11) == ConvolutionProfile::Engine::DFT);
+  BOOST_CHECK(profile->select(300, 200, 4, 4) == ConvolutionProfile::Engine::DIRECT);
+  BOOST_CHECK(profile->select(1024, 1024, 31, 31) == ConvolutionProfile::Engine::DFT);
+
+  // Round trip
+  Elements::TempFile copy_file;
+  BOOST_CHECK(profile->save(copy_file.path().native()));
+  auto copy = ConvolutionProfile::load(copy_file.path().native());
+  BOOST_REQUIRE(copy);
+  BOOST_CHECK(copy->select(64, 64, 13, 11) == ConvolutionProfile::Engine::DFT);
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( Invalid_test ) {
+  Elements::TempFile profile_file;
+  BOOST_CHECK(!ConvolutionProfile::load(profile_file.path().native()));
+
+  // Calibrated on a different machine
+  {
+    std::ofstream output(profile_file.path().native());
+    output << "# Convolution profile\n" << "cpu Some other CPU\n" << "64 3 1 2\n";
+  }
+  BOOST_CHECK(!ConvolutionProfile::load(profile_file.path().native()));
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( Calibrate_test ) {
+  auto profile = ConvolutionProfile::calibrate({16, 32}, {3, 5, 33});
+  BOOST_CHECK(profile->isCalibrated());
+
+  Elements::TempFile profile_file;
+  BOOST_CHECK(profile->save(profile_file.path().native()));
+  BOOST_CHECK(ConvolutionProfile::load(profile_file.path().native()));
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+//----------------------------------------------------------------------------
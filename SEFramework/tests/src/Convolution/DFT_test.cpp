@@ -233,6 +233,34 @@ BOOST_AUTO_TEST_CASE(ConvolveGaussianOdd_test) {
 
 //----------------------------------------------------------------------------
 
+BOOST_FIXTURE_TEST_CASE ( ConvolveBatch_test, DFT_Fixture ) {
+  auto image = VectorImage<SeFloat>::create(5, 4, std::vector<float>{
+    0.0, 0.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0, 0.0,
+    0.0, 0.0, 0.0, 0.0, 2.0,
+    0.0, 0.0, 0.0, 0.0, 0.0,
+  });
+  auto mask = VectorImage<SeFloat>::create(5, 4, std::vector<float>{
+    1.0, 1.0, 1.0, 1.0, 1.0,
+    1.0, 1.0, 0.0, 1.0, 1.0,
+    1.0, 1.0, 1.0, 1.0, 1.0,
+    0.0, 1.0, 1.0, 1.0, 1.0,
+  });
+  auto expected_image = VectorImage<SeFloat>::create(*image);
+  auto expected_mask = VectorImage<SeFloat>::create(*mask);
+  dft.convolve(expected_image);
+  dft.convolve(expected_mask);
+
+  auto reference = dft.prepare(5, 4, 2);
+  auto context = dft.prepareLike(*reference);
+  dft.convolveBatch({image, mask}, context);
+
+  BOOST_CHECK(compareImages(expected_image, image, 1e-5, 1e-4));
+  BOOST_CHECK(compareImages(expected_mask, mask, 1e-5, 1e-4));
+}
+
+//----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
 
 //----------------------------------------------------------------------------
@@ -217,6 +217,89 @@ BOOST_AUTO_TEST_CASE(ConvolveGaussianOdd_test) {
 
 //----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(ConvolveSeparable_test) {
+  auto kernel = VectorImage<SeFloat>::create(5, 5);
+  std::vector<SeFloat> profile{1, 4, 6, 4, 1};
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 5; ++x) {
+      kernel->setValue(x, y, profile[x] * profile[y] / 256.);
+    }
+  }
+
+  auto image = VectorImage<SeFloat>::create(9, 7);
+  for (int y = 0; y < 7; ++y) {
+    for (int x = 0; x < 9; ++x) {
+      image->setValue(x, y, (x * 31 + y * 17) % 11);
+    }
+  }
+  auto expected = VectorImage<SeFloat>::create(*image);
+
+  DirectConvolution<SeFloat> separable(kernel);
+  DirectConvolution<SeFloat> full(kernel, 0);
+  separable.convolve(image);
+  full.convolve(expected);
+
+  BOOST_CHECK(compareImages(expected, image, 1e-5, 1e-4));
+}
+
+//----------------------------------------------------------------------------
+
+// Reference: full 2D kernel over a materialized padded copy
+template <typename TPadding, typename ...Args>
+static std::shared_ptr<VectorImage<SeFloat>> referenceConvolution(std::shared_ptr<VectorImage<SeFloat>> image,
+                                                                  std::shared_ptr<VectorImage<SeFloat>> kernel,
+                                                                  Args... padding_args) {
+  int kw = kernel->getWidth(), kh = kernel->getHeight();
+  auto padded = VectorImage<SeFloat>::create(
+    TPadding::create(image, image->getWidth() + kw - 1, image->getHeight() + kh - 1, padding_args...));
+  auto result = VectorImage<SeFloat>::create(image->getWidth(), image->getHeight());
+  for (int y = 0; y < result->getHeight(); ++y) {
+    for (int x = 0; x < result->getWidth(); ++x) {
+      SeFloat acc = 0;
+      for (int ky = 0; ky < kh; ++ky) {
+        for (int kx = 0; kx < kw; ++kx) {
+          acc += kernel->getValue(kw - kx - 1, kh - ky - 1) * padded->getValue(x + kx, y + ky);
+        }
+      }
+      result->setValue(x, y, acc);
+    }
+  }
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(ConvolveBorders_test) {
+  // Not separable, wider than a block of the direct kernel, and images smaller than the kernel
+  auto kernel = VectorImage<SeFloat>::create(7, 5);
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 7; ++x) {
+      kernel->setValue(x, y, (x * 13 + y * 7) % 5 - 1.5);
+    }
+  }
+
+  for (auto size : std::vector<std::pair<int, int>>{{150, 9}, {4, 3}, {6, 20}}) {
+    auto image = VectorImage<SeFloat>::create(size.first, size.second);
+    for (int y = 0; y < image->getHeight(); ++y) {
+      for (int x = 0; x < image->getWidth(); ++x) {
+        image->setValue(x, y, (x * 31 + y * 17) % 11);
+      }
+    }
+
+    auto reflected = VectorImage<SeFloat>::create(*image);
+    DirectConvolution<SeFloat> reflect_convolution(kernel);
+    reflect_convolution.convolve(reflected);
+    auto expected = referenceConvolution<PaddedImage<SeFloat, Reflect101Coordinates>>(image, kernel);
+    BOOST_CHECK(compareImages(expected, reflected, 1e-5, 1e-4));
+
+    auto zero_padded = VectorImage<SeFloat>::create(*image);
+    DirectConvolution<SeFloat, PaddedImage<SeFloat>> zero_convolution(kernel);
+    zero_convolution.convolve(zero_padded);
+    expected = referenceConvolution<PaddedImage<SeFloat>>(image, kernel);
+    BOOST_CHECK(compareImages(expected, zero_padded, 1e-5, 1e-4));
+  }
+}
+
+//----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
 
 //----------------------------------------------------------------------------
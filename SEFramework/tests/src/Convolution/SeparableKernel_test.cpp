@@ -0,0 +1,128 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "SEUtils/TestUtils.h"
+#include "SEFramework/Convolution/SeparableKernel.h"
+#include "SEFramework/Image/VectorImage.h"
+
+using namespace SourceXtractor;
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (SeparableKernel_test)
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( RankOne_test ) {
+  auto kernel = VectorImage<SeFloat>::create(5, 3, std::vector<SeFloat>{
+    1, 4, 6, 4, 1,
+    2, 8, 12, 8, 2,
+    1, 4, 6, 4, 1,
+  });
+
+  auto separable = SeparableKernel<SeFloat>::decompose(*kernel, 1e-6);
+  BOOST_REQUIRE(separable);
+  BOOST_CHECK_EQUAL(separable->getRank(), 1);
+  BOOST_CHECK_LT(separable->getError(), 1e-6);
+
+  // A single pixel gives back the kernel
+  std::vector<SeFloat> in(9 * 5, 0.);
+  in[4 + 2 * 9] = 1.;
+  auto out = VectorImage<SeFloat>::create(5, 3);
+  separable->correlate(in.data(), 9, 5, out->getData().data());
+
+  auto expected = VectorImage<SeFloat>::create(5, 3, std::vector<SeFloat>{
+    1, 4, 6, 4, 1,
+    2, 8, 12, 8, 2,
+    1, 4, 6, 4, 1,
+  });
+  auto mirrored = VectorImage<SeFloat>::create(5, 3);
+  for (int y = 0; y < 3; ++y) {
+    for (int x = 0; x < 5; ++x) {
+      mirrored->setValue(x, y, expected->getValue(4 - x, 2 - y));
+    }
+  }
+  BOOST_CHECK(compareImages(mirrored, out, 1e-5, 1e-4));
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( RankTwo_test ) {
+  // Sum of two outer products, as a difference of Gaussians would be
+  auto kernel = VectorImage<SeFloat>::create(5, 5);
+  std::vector<SeFloat> a{1, 4, 6, 4, 1}, b{0, 1, 2, 1, 0};
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 5; ++x) {
+      kernel->setValue(x, y, a[x] * a[y] - 4 * b[x] * b[y]);
+    }
+  }
+
+  BOOST_CHECK(!SeparableKernel<SeFloat>::decompose(*kernel, 1e-6, 1));
+
+  auto separable = SeparableKernel<SeFloat>::decompose(*kernel, 1e-6);
+  BOOST_REQUIRE(separable);
+  BOOST_CHECK_EQUAL(separable->getRank(), 2);
+
+  // Random input, compared with the full 2D kernel
+  std::vector<SeFloat> in(12 * 10);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = (i * 7919) % 13;
+  }
+  auto out = VectorImage<SeFloat>::create(8, 6);
+  separable->correlate(in.data(), 12, 10, out->getData().data());
+
+  auto expected = VectorImage<SeFloat>::create(8, 6);
+  for (int y = 0; y < 6; ++y) {
+    for (int x = 0; x < 8; ++x) {
+      SeFloat acc = 0;
+      for (int ky = 0; ky < 5; ++ky) {
+        for (int kx = 0; kx < 5; ++kx) {
+          acc += kernel->getValue(kx, ky) * in[x + kx + (y + ky) * 12];
+        }
+      }
+      expected->setValue(x, y, acc);
+    }
+  }
+  BOOST_CHECK(compareImages(expected, out, 1e-3, 1e-4));
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE ( NotSeparable_test ) {
+  auto kernel = VectorImage<SeFloat>::create(3, 3, std::vector<SeFloat>{
+    1, 0, 0,
+    0, 1, 0,
+    0, 0, 1,
+  });
+  BOOST_CHECK(!SeparableKernel<SeFloat>::decompose(*kernel, 1e-4));
+
+  // Rank 2, but two 1D passes cost as much as the full 3x3 kernel
+  auto rank2 = VectorImage<SeFloat>::create(3, 3, std::vector<SeFloat>{
+    1, 2, 3,
+    4, 5, 6,
+    7, 8, 9,
+  });
+  BOOST_CHECK(!SeparableKernel<SeFloat>::decompose(*rank2, 1e-4));
+  BOOST_CHECK(!SeparableKernel<SeFloat>::decompose(*rank2, 0));
+}
+
+//----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+//----------------------------------------------------------------------------
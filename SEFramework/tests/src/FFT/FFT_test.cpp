@@ -20,11 +20,13 @@
  * @author Alejandro Alvarez Ayllon
  */
 
+#include "ElementsKernel/Temporary.h"
 #include "SEFramework/FFT/FFT.h"
 #include "SEFramework/FFT/FFTHelper.h"
 #include "SEFramework/Image/VectorImage.h"
 #include "SEUtils/TestUtils.h"
 #include <boost/test/unit_test.hpp>
+#include <cstdint>
 #include <numeric>
 
 using namespace SourceXtractor;
@@ -36,7 +38,7 @@ BOOST_AUTO_TEST_SUITE(FFT_test)
 //-----------------------------------------------------------------------------
 
 BOOST_AUTO_TEST_CASE(FFT_float_symmetric_float_test) {
-  std::vector<float> scratch;
+  FFT<float>::work_area_t scratch;
   auto               fwd_plan = FFT<float>::createForwardPlan(4, 4, scratch);
   auto               inv_plan = FFT<float>::createInversePlan(4, 4, scratch);
 
@@ -62,7 +64,7 @@ BOOST_AUTO_TEST_CASE(FFT_float_symmetric_float_test) {
 //-----------------------------------------------------------------------------
 
 BOOST_AUTO_TEST_CASE(FFT_float_symmetric_double_test) {
-  std::vector<double> scratch;
+  FFT<double>::work_area_t scratch;
   auto               fwd_plan = FFT<double>::createForwardPlan(4, 4, scratch);
   auto               inv_plan = FFT<double>::createInversePlan(4, 4, scratch);
 
@@ -87,4 +89,41 @@ BOOST_AUTO_TEST_CASE(FFT_float_symmetric_double_test) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE(FFT_wisdom_test) {
+  Elements::TempFile wisdom_path("FFT_test_wisdom_%%%%%%");
+
+  // Measure a size not used by any other test, so it ends in the wisdom of both precisions
+  fftSetPlanningRigor(FFTW_MEASURE);
+  BOOST_CHECK_EQUAL(fftGetPlanningRigor(), FFTW_MEASURE);
+  FFT<float>::work_area_t float_scratch;
+  FFT<double>::work_area_t double_scratch;
+  FFT<float>::createForwardPlan(12, 10, float_scratch);
+  FFT<double>::createForwardPlan(12, 10, double_scratch);
+  fftSetPlanningRigor(FFTW_ESTIMATE);
+
+  BOOST_CHECK(fftExportWisdom(wisdom_path.path().native()));
+  BOOST_CHECK(fftImportWisdom(wisdom_path.path().native()));
+
+  BOOST_CHECK(!fftImportWisdom(wisdom_path.path().native() + ".missing"));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(FFT_work_area_pool_test) {
+  auto work_area = FFT<float>::acquireWorkArea(100);
+  BOOST_CHECK_EQUAL(work_area->size(), 100);
+  BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(work_area->data()) % 16, 0);
+
+  // Released areas are reused only for the same size
+  auto data = work_area->data();
+  FFT<float>::releaseWorkArea(std::move(work_area));
+  auto other = FFT<float>::acquireWorkArea(50);
+  BOOST_CHECK_EQUAL(other->size(), 50);
+  BOOST_CHECK_NE(other->data(), data);
+  work_area = FFT<float>::acquireWorkArea(100);
+  BOOST_CHECK_EQUAL(work_area->data(), data);
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsFile_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <fstream>
+#include <iterator>
+
+#include "ElementsKernel/Temporary.h"
+#include <ElementsKernel/Auxiliary.h>
+
+#include "SEFramework/FITS/FitsFile.h"
+
+using namespace SourceXtractor;
+
+struct FitsFileFixture {
+  std::string mhdu_path;
+  Elements::TempDir temp_dir;
+
+  FitsFileFixture() {
+    mhdu_path = Elements::getAuxiliaryPath("multiple_hdu.fits").native();
+  }
+
+  ~FitsFileFixture() {
+    FitsFile::setHeaderCacheDirectory({});
+  }
+
+  static std::string getExtName(FitsFile& file, int hdu) {
+    return boost::trim_copy(boost::get<std::string>(file.getHDUHeaders(hdu).at("EXTNAME").m_value));
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FitsFile_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(headers_test, FitsFileFixture) {
+  FitsFile file(mhdu_path, false);
+  BOOST_CHECK(file.getImageHdus() == std::vector<int>({2, 4}));
+  BOOST_CHECK_EQUAL(getExtName(file, 4), "IMAGE2");
+  BOOST_CHECK_EQUAL(getExtName(file, 2), "COMPRESSED_IMAGE");
+  BOOST_CHECK_EQUAL(getExtName(file, 3), "TABLE");
+  BOOST_CHECK_THROW(file.getHDUHeaders(5), std::out_of_range);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(header_cache_test, FitsFileFixture) {
+  auto fits_path = temp_dir.path() / "multiple_hdu.fits";
+  auto cache_dir = temp_dir.path() / "cache";
+  boost::filesystem::copy_file(mhdu_path, fits_path);
+  FitsFile::setHeaderCacheDirectory(cache_dir);
+
+  {
+    FitsFile file(fits_path, false);
+    BOOST_CHECK_EQUAL(getExtName(file, 4), "IMAGE2");
+  }
+
+  // Tamper with the cache to know where the headers come from
+  boost::filesystem::directory_iterator cache_file(cache_dir);
+  BOOST_REQUIRE(cache_file != boost::filesystem::directory_iterator());
+  std::string content;
+  {
+    std::ifstream in(cache_file->path().native());
+    content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  boost::replace_all(content, "IMAGE2", "CACHED");
+  {
+    std::ofstream out(cache_file->path().native());
+    out << content;
+  }
+
+  {
+    FitsFile file(fits_path, false);
+    BOOST_CHECK(file.getImageHdus() == std::vector<int>({2, 4}));
+    BOOST_CHECK_EQUAL(getExtName(file, 4), "CACHED");
+    BOOST_CHECK_EQUAL(getExtName(file, 2), "COMPRESSED_IMAGE");
+  }
+
+  // Once the file is modified, the cache is ignored
+  boost::filesystem::last_write_time(fits_path, boost::filesystem::last_write_time(fits_path) + 10);
+  {
+    FitsFile file(fits_path, false);
+    BOOST_CHECK_EQUAL(getExtName(file, 4), "IMAGE2");
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
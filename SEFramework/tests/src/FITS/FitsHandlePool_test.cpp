@@ -0,0 +1,115 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FitsHandlePool_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+#include <ElementsKernel/Auxiliary.h>
+#include <ElementsKernel/Exception.h>
+
+#include "SEFramework/FITS/FitsHandlePool.h"
+
+using namespace SourceXtractor;
+
+struct FitsHandlePoolFixture {
+  std::string mhdu_path, primary_path;
+
+  FitsHandlePoolFixture() {
+    mhdu_path = Elements::getAuxiliaryPath("multiple_hdu.fits").native();
+    primary_path = Elements::getAuxiliaryPath("with_primary.fits").native();
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(FitsHandlePool_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(reuse_test, FitsHandlePoolFixture) {
+  auto pool = std::make_shared<FitsHandlePool>(4);
+
+  int first_fd;
+  {
+    auto first = pool->acquire(mhdu_path);
+    auto second = pool->acquire(mhdu_path);
+    BOOST_REQUIRE(first);
+    BOOST_REQUIRE(second);
+    // Used at the same time, so they must be independent
+    BOOST_CHECK_NE(first->getDescriptor(), second->getDescriptor());
+    BOOST_CHECK_EQUAL(pool->getOpenHandles(), 2);
+    first_fd = first->getDescriptor();
+  }
+
+  // Released handles are kept open, and the most recently released is reused first
+  BOOST_CHECK_EQUAL(pool->getOpenHandles(), 2);
+  auto again = pool->acquire(mhdu_path);
+  BOOST_REQUIRE(again);
+  BOOST_CHECK_EQUAL(again->getDescriptor(), first_fd);
+  BOOST_CHECK_EQUAL(pool->getOpenHandles(), 2);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(limit_test, FitsHandlePoolFixture) {
+  auto pool = std::make_shared<FitsHandlePool>(1);
+
+  {
+    auto handle = pool->acquire(mhdu_path);
+    BOOST_REQUIRE(handle);
+    // No room left while the only handle is in use
+    BOOST_CHECK(!pool->acquire(mhdu_path));
+    BOOST_CHECK(!pool->acquire(primary_path));
+  }
+
+  // The idle handle of the other file is closed to make room
+  auto handle = pool->acquire(primary_path);
+  BOOST_CHECK(handle);
+  BOOST_CHECK_EQUAL(pool->getOpenHandles(), 1);
+
+  pool->setMaxHandles(0);
+  BOOST_CHECK(!pool->acquire(mhdu_path));
+  handle.reset();
+  BOOST_CHECK_EQUAL(pool->getOpenHandles(), 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(read_test, FitsHandlePoolFixture) {
+  auto pool = std::make_shared<FitsHandlePool>(2);
+
+  auto handle = pool->acquire(mhdu_path);
+  BOOST_REQUIRE(handle);
+  char signature[6];
+  handle->read(0, sizeof(signature), signature);
+  BOOST_CHECK_EQUAL(std::string(signature, sizeof(signature)), "SIMPLE");
+
+  // Past the end of the file
+  BOOST_CHECK_THROW(handle->read(1L << 40, sizeof(signature), signature), Elements::Exception);
+
+  BOOST_CHECK(!pool->acquire("/does/not/exist.fits"));
+  BOOST_CHECK_EQUAL(pool->getOpenHandles(), 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
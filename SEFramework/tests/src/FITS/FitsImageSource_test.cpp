@@ -21,6 +21,11 @@
  */
 
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
 
 #include "ElementsKernel/Temporary.h"
 #include <ElementsKernel/Auxiliary.h>
@@ -162,6 +167,130 @@ BOOST_FIXTURE_TEST_CASE(open_write_close_append, FitsImageSourceFixture) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_FIXTURE_TEST_CASE(concurrent_read_test, FitsImageSourceFixture) {
+  const int size = 200;
+  {
+    auto image_source = std::make_shared<FitsImageSource>(temp_path.path().native(),
+        size, size, ImageTile::FloatImage);
+    auto image = WriteableBufferedImage<float>::create(image_source);
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        image->setValue(x, y, static_cast<float>(x + y * size));
+      }
+    }
+  }
+  TileManager::getInstance()->flush();
+
+  // The FileManager keeps the file open while the tiles are read concurrently
+  auto img_src = std::make_shared<FitsImageSource>(temp_path.path().native(), 0, ImageTile::FloatImage);
+  auto handler = FileManager::getDefault()->getFileHandler(temp_path.path().native());
+
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&img_src, &errors, t, size]() {
+      for (int i = 0; i < 50; ++i) {
+        int x = (t * 13 + i) % (size - 20), y = (t * 50 + i * 7) % (size - 10);
+        auto tile = img_src->getImageTile(x, y, 20, 10);
+        for (int ty = y; ty < y + 10; ++ty) {
+          for (int tx = x; tx < x + 20; ++tx) {
+            if (tile->getValue<float>(tx, ty) != static_cast<float>(tx + ty * size)) {
+              ++errors;
+            }
+          }
+        }
+      }
+    });
+  }
+
+  std::vector<float> row(size);
+  for (int y = 0; y < size; ++y) {
+    auto acc = handler->getAccessor<FitsFile>();
+    long first_pixel[2] = {1, y + 1};
+    int status = 0;
+    fits_read_pix(acc->m_fd.getFitsFilePtr(), TFLOAT, first_pixel, size, nullptr, row.data(), nullptr, &status);
+    BOOST_CHECK_EQUAL(status, 0);
+    BOOST_CHECK_EQUAL(row[y], static_cast<float>(y + y * size));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK_EQUAL(errors, 0);
+  BOOST_CHECK_GT(FitsHandlePool::getInstance()->getOpenHandles(), 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(rice_compressed_read_test, FitsImageSourceFixture) {
+  const int width = 100, height = 60;
+  std::vector<short> shorts(width * height);
+  std::vector<float> floats(width * height);
+  for (int i = 0; i < width * height; ++i) {
+    shorts[i] = static_cast<short>((i * 37) % 2000 - 1000);
+    floats[i] = std::sin(i * 0.01f) * 100.f;
+  }
+  // The tile with a null pixel is decoded by cfitsio
+  floats[12 * width + 34] = std::numeric_limits<float>::quiet_NaN();
+
+  int status = 0;
+  fitsfile *fptr = nullptr;
+  long naxes[2] = {width, height};
+  long tile_dim[2] = {16, 8};
+  fits_create_file(&fptr, ("!" + temp_path.path().native()).c_str(), &status);
+  fits_create_img(fptr, BYTE_IMG, 0, nullptr, &status);
+  fits_set_compression_type(fptr, RICE_1, &status);
+  fits_set_tile_dim(fptr, 2, tile_dim, &status);
+  fits_create_img(fptr, SHORT_IMG, 2, naxes, &status);
+  fits_write_img(fptr, TSHORT, 1, shorts.size(), shorts.data(), &status);
+  fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status);
+  fits_write_img(fptr, TFLOAT, 1, floats.size(), floats.data(), &status);
+  fits_close_file(fptr, &status);
+  BOOST_REQUIRE_EQUAL(status, 0);
+
+  auto same = [](float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); };
+
+  for (int hdu : {2, 3}) {
+    FitsHandlePool::getInstance()->closeIdle();
+    auto img_src = std::make_shared<FitsImageSource>(temp_path.path().native(), hdu, ImageTile::FloatImage);
+    BOOST_CHECK_EQUAL(img_src->getNativeTileSize().first, 16);
+    BOOST_CHECK_EQUAL(img_src->getNativeTileSize().second, 8);
+
+    // As decoded by cfitsio
+    std::vector<float> expected(width * height);
+    {
+      auto handler = FileManager::getDefault()->getFileHandler(temp_path.path().native());
+      auto acc = handler->getAccessor<FitsFile>();
+      int hdu_type = 0;
+      fits_movabs_hdu(acc->m_fd.getFitsFilePtr(), hdu, &hdu_type, &status);
+      fits_read_img(acc->m_fd.getFitsFilePtr(), TFLOAT, 1, expected.size(), nullptr, expected.data(), nullptr,
+                    &status);
+      BOOST_REQUIRE_EQUAL(status, 0);
+    }
+
+    // Whole image, and a region across several compression tiles
+    int regions[2][4] = {{0, 0, width, height}, {5, 3, 30, 20}};
+    for (auto& region : regions) {
+      auto tile = img_src->getImageTile(region[0], region[1], region[2], region[3]);
+      int errors = 0;
+      for (int y = region[1]; y < region[1] + region[3]; ++y) {
+        for (int x = region[0]; x < region[0] + region[2]; ++x) {
+          if (!same(tile->getValue<float>(x, y), expected[x + y * width])) {
+            ++errors;
+          }
+        }
+      }
+      BOOST_CHECK_EQUAL(errors, 0);
+    }
+
+    // The tiles were read through the pool
+    BOOST_CHECK_GT(FitsHandlePool::getInstance()->getOpenHandles(), 0);
+  }
+  FitsHandlePool::getInstance()->closeIdle();
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END()
 
 //-----------------------------------------------------------------------------
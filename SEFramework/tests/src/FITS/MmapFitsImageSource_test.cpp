@@ -0,0 +1,122 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/**
+ * @file tests/src/MmapFitsImageSource_test.cpp
+ * @date 10/17/2026
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Temporary.h"
+#include <ElementsKernel/Auxiliary.h>
+
+#include "SEFramework/Image/WriteableBufferedImage.h"
+#include "SEFramework/Image/ImageChunk.h"
+#include "SEFramework/FITS/MmapFitsImage.h"
+
+using namespace SourceXtractor;
+
+struct MmapFitsImageSourceFixture {
+  std::string mhdu_path, primary_path;
+  Elements::TempFile temp_path;
+
+  MmapFitsImageSourceFixture() : temp_path("MmapFitsImageSource_test_%%%%%%.fits") {
+    mhdu_path = Elements::getAuxiliaryPath("multiple_hdu.fits").native();
+    primary_path = Elements::getAuxiliaryPath("with_primary.fits").native();
+  }
+
+  template <typename T>
+  void writeImage(ImageTile::ImageType image_type, int width, int height) {
+    auto image_source = std::make_shared<FitsImageSource>(temp_path.path().native(), width, height, image_type);
+    auto image = WriteableBufferedImage<T>::create(image_source);
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        image->setValue(x, y, static_cast<T>(x - y * 3));
+      }
+    }
+    TileManager::getInstance()->flush();
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(MmapFitsImageSource_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(primary_test, MmapFitsImageSourceFixture) {
+  auto img_src = std::make_shared<MmapFitsImageSource>(primary_path, 0, ImageTile::FloatImage);
+  BOOST_CHECK_EQUAL(img_src->getHeight(), 1);
+  BOOST_CHECK_EQUAL(img_src->getWidth(), 1);
+  BOOST_CHECK_CLOSE(img_src->getImageTile(0, 0, 1, 1)->getValue<SeFloat>(0, 0), 1024.44f, 1e-8);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(float_chunk_test, MmapFitsImageSourceFixture) {
+  writeImage<float>(ImageTile::FloatImage, 67, 45);
+
+  auto image = MmapFitsImage<float>::create(
+    std::make_shared<MmapFitsImageSource>(temp_path.path().native(), 1, ImageTile::FloatImage));
+  BOOST_CHECK_EQUAL(image->getWidth(), 67);
+  BOOST_CHECK_EQUAL(image->getHeight(), 45);
+
+  auto chunk = image->getChunk(5, 7, 40, 30);
+  for (int y = 0; y < 30; ++y) {
+    for (int x = 0; x < 40; ++x) {
+      BOOST_CHECK_EQUAL(chunk->getValue(x, y), static_cast<float>(x + 5 - (y + 7) * 3));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(convert_type_test, MmapFitsImageSourceFixture) {
+  writeImage<int>(ImageTile::IntImage, 20, 10);
+
+  auto img_src = std::make_shared<MmapFitsImageSource>(temp_path.path().native(), 1, ImageTile::DoubleImage);
+  auto tile = img_src->getImageTile(2, 3, 10, 5);
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 10; ++x) {
+      BOOST_CHECK_EQUAL(tile->getValue<double>(x, y), x + 2 - (y + 3) * 3);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(compressed_fallback_test, MmapFitsImageSourceFixture) {
+  BOOST_CHECK_THROW(std::make_shared<MmapFitsImageSource>(mhdu_path, 1, ImageTile::FloatImage), Elements::Exception);
+
+  auto image = openFitsImage<float>(std::make_shared<FitsImageSource>(mhdu_path, 0, ImageTile::FloatImage));
+  BOOST_CHECK(std::dynamic_pointer_cast<BufferedImage<float>>(image) != nullptr);
+  BOOST_CHECK_CLOSE(image->getChunk(0, 0, 1, 1)->getValue(0, 0), 256.2f, 1e-8);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(uncompressed_mapped_test, MmapFitsImageSourceFixture) {
+  auto image = openFitsImage<float>(std::make_shared<FitsImageSource>(primary_path, 0, ImageTile::FloatImage));
+  BOOST_CHECK(std::dynamic_pointer_cast<MmapFitsImage<float>>(image) != nullptr);
+  BOOST_CHECK_CLOSE(image->getChunk(0, 0, 1, 1)->getValue(0, 0), 1024.44f, 1e-8);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//-----------------------------------------------------------------------------
@@ -228,5 +228,22 @@ BOOST_FIXTURE_TEST_CASE(ChunkCrossMultipleXY_test, BufferedImageFixture) {
 
 //-----------------------------------------------------------------------------
 
+/**
+ * A chunk within a single tile is a view over it, and it must stay valid
+ * even if the tile is dropped from the cache
+ */
+BOOST_FIXTURE_TEST_CASE(ChunkOutlivesCache_test, BufferedImageFixture) {
+  auto image = BufferedImage<SeFloat>::create(m_img_source);
+
+  auto tile5 = image->getChunk(3, 2, 1, 2);
+  TileManager::getInstance()->flush();
+  BOOST_CHECK(compareImages(VectorImage<SeFloat>::create(1, 2, std::vector<SeFloat>{5, 5}), tile5));
+
+  auto subchunk = tile5->getChunk(0, 1, 1, 1);
+  BOOST_CHECK_EQUAL(subchunk->getValue(0, 0), 5);
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
 
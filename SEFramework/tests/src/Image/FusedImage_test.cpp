@@ -0,0 +1,107 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FusedImage_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+#include "SEFramework/Image/FunctionalImage.h"
+#include "SEFramework/Image/MaskedImage.h"
+#include "SEFramework/Image/ProcessedImage.h"
+#include "SEFramework/Image/ThresholdedImage.h"
+#include "SEFramework/Image/VectorImage.h"
+
+#include "SEUtils/TestUtils.h"
+
+using namespace SourceXtractor;
+
+struct FusedImageFixture {
+  std::shared_ptr<VectorImage<SeFloat>> m_image, m_background, m_variance;
+
+  FusedImageFixture() {
+    m_image = VectorImage<SeFloat>::create(4, 3, std::vector<SeFloat>{
+      1, 2, 3, 4,
+      5, 6, 7, 8,
+      9, 10, 11, 12,
+    });
+    m_background = VectorImage<SeFloat>::create(4, 3, std::vector<SeFloat>{
+      1, 1, 1, 1,
+      2, 2, 2, 2,
+      3, 3, 3, 3,
+    });
+    m_variance = VectorImage<SeFloat>::create(4, 3, std::vector<SeFloat>{
+      1, 1, 4, 4,
+      1, 1, 4, 4,
+      9, 9, 16, 16,
+    });
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (FusedImage_test)
+
+//-----------------------------------------------------------------------------
+
+/**
+ * A chain of fused images must give the same result as evaluating each step on its own
+ */
+BOOST_FIXTURE_TEST_CASE (Chain_test, FusedImageFixture) {
+  auto subtracted = SubtractImage<SeFloat>::create(m_image, m_background);
+  auto thresholded = ThresholdedImage<SeFloat>::create(subtracted, m_variance, 2);
+  auto mask = FunctionalImage<SeFloat>::create(m_variance, [](int, int, SeFloat v) -> SeFloat {
+    return v > 8;
+  });
+  auto masked = MaskedImage<SeFloat, SeFloat, std::equal_to>::create(thresholded, mask, -1, 1);
+
+  auto expected = VectorImage<SeFloat>::create(4, 3, std::vector<SeFloat>{
+    -2, -1, -2, -1,
+     1,  2,  1,  2,
+    -1, -1, -1, -1,
+  });
+  BOOST_CHECK(compareImages(expected, masked));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE (SubChunk_test, FusedImageFixture) {
+  auto snr = SnrImage<SeFloat>::create(m_image, m_variance);
+  auto chunk = snr->getChunk(1, 1, 3, 2);
+
+  auto expected = VectorImage<SeFloat>::create(3, 2, std::vector<SeFloat>{
+    6, 3.5, 4,
+    10. / 3., 11. / 4., 3,
+  });
+  BOOST_CHECK(compareImages(expected, chunk));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE (EvaluateNonFused_test, FusedImageFixture) {
+  std::vector<SeFloat> output(4);
+  evaluateImage<SeFloat>(*m_image, 2, 1, 2, 2, output.data());
+  BOOST_CHECK_EQUAL(output[0], 7);
+  BOOST_CHECK_EQUAL(output[1], 8);
+  BOOST_CHECK_EQUAL(output[2], 11);
+  BOOST_CHECK_EQUAL(output[3], 12);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
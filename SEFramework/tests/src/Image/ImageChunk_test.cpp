@@ -62,4 +62,34 @@ BOOST_AUTO_TEST_CASE( example_test ) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE( row_span_test ) {
+
+  auto image = VectorImage<int>::create(20, 30);
+  for (int y = 0; y < 30; ++y) {
+    for (int x = 0; x < 20; ++x) {
+      image->setValue(x, y, x + y * 100);
+    }
+  }
+
+  auto chunk = image->getChunk(3, 2, 10, 12)->getChunk(1, 1, 5, 4);
+  BOOST_CHECK_EQUAL(chunk->getStride(), 20);
+
+  for (int y = 0; y < chunk->getHeight(); ++y) {
+    const int* row = chunk->getRowSpan(y);
+    for (int x = 0; x < chunk->getWidth(); ++x) {
+      BOOST_CHECK_EQUAL(row[x], chunk->getValue(x, y));
+    }
+  }
+
+  std::vector<int> rows;
+  image->forEachRow(4, 3, 5, 4, [&rows](int y, const int* row) {
+    BOOST_CHECK_EQUAL(row[0], 4 + y * 100);
+    BOOST_CHECK_EQUAL(row[4], 8 + y * 100);
+    rows.push_back(y);
+  });
+  BOOST_CHECK(rows == std::vector<int>({3, 4, 5, 6}));
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,117 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileBufferPool_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "SEFramework/Image/ImageTile.h"
+#include "SEFramework/Image/TileBufferPool.h"
+
+using namespace SourceXtractor;
+
+struct TileBufferPoolFixture {
+  long m_max_memory;
+
+  TileBufferPoolFixture() : m_max_memory(TileBufferPool::getMaxMemory()) {
+    TileBufferPool::clear();
+    TileBufferPool::setMaxMemory(1024 * 1024);
+  }
+
+  ~TileBufferPoolFixture() {
+    TileBufferPool::clear();
+    TileBufferPool::setMaxMemory(m_max_memory);
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_SUITE (TileBufferPool_test, TileBufferPoolFixture)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Reuse_test) {
+  auto before = TileBufferPool::getStatistics();
+
+  auto buffer = TileBufferPool::acquire<float>(1000);
+  BOOST_CHECK_EQUAL(buffer.size(), 1000);
+  auto data = buffer.data();
+  TileBufferPool::release(std::move(buffer));
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 1000 * sizeof(float));
+
+  // Different type or size
+  auto other_type = TileBufferPool::acquire<double>(1000);
+  auto other_size = TileBufferPool::acquire<float>(999);
+
+  auto same = TileBufferPool::acquire<float>(1000);
+  BOOST_CHECK_EQUAL(same.data(), data);
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 0);
+
+  auto after = TileBufferPool::getStatistics();
+  BOOST_CHECK_EQUAL(after.m_allocated - before.m_allocated, 3);
+  BOOST_CHECK_EQUAL(after.m_reused - before.m_reused, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Full_test) {
+  auto before = TileBufferPool::getStatistics();
+
+  auto first = TileBufferPool::acquire<int>(200 * 1024);
+  auto second = TileBufferPool::acquire<int>(200 * 1024);
+  TileBufferPool::release(std::move(first));
+  TileBufferPool::release(std::move(second));
+
+  auto after = TileBufferPool::getStatistics();
+  BOOST_CHECK_EQUAL(after.m_discarded - before.m_discarded, 1);
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 200 * 1024 * sizeof(int));
+
+  TileBufferPool::clear();
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Tile_test) {
+  void* data;
+  {
+    auto tile = ImageTile::create(ImageTile::FloatImage, 0, 0, 64, 64);
+    data = tile->getDataPtr();
+  }
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 64 * 64 * sizeof(float));
+
+  auto tile = ImageTile::create(ImageTile::FloatImage, 64, 0, 64, 64);
+  BOOST_CHECK_EQUAL(tile->getDataPtr(), data);
+
+  // While its pixels are referenced, the buffer of a tile is not recycled
+  std::shared_ptr<VectorImage<float>> pixels;
+  {
+    auto other = std::dynamic_pointer_cast<ImageTileWithType<float>>(
+      ImageTile::create(ImageTile::FloatImage, 0, 64, 64, 64));
+    other->setValue(3, 66, 42.f);
+    pixels = other->getImage();
+  }
+  BOOST_CHECK_EQUAL(TileBufferPool::getPooledMemory(), 0);
+  BOOST_CHECK_EQUAL(pixels->getValue(3, 2), 42.f);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
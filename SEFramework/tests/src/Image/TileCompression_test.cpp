@@ -0,0 +1,93 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileCompression_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include <boost/test/unit_test.hpp>
+#include "SEFramework/Image/TileCompression.h"
+
+using namespace SourceXtractor;
+
+template <typename T>
+static std::vector<T> roundTrip(const std::vector<T>& data, std::size_t& compressed_size) {
+  auto compressed = compressTileData(data.data(), sizeof(T), data.size());
+  compressed_size = compressed.size();
+  std::vector<T> restored(data.size());
+  decompressTileData(compressed, sizeof(T), restored.size(), restored.data());
+  return restored;
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (TileCompression_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Constant_test) {
+  std::vector<float> data(256 * 256, 42.f);
+  std::size_t compressed_size;
+  BOOST_CHECK(roundTrip(data, compressed_size) == data);
+  BOOST_CHECK_LT(compressed_size, data.size() * sizeof(float) / 100);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Smooth_test) {
+  std::vector<float> data(256 * 256);
+  std::mt19937 gen(0);
+  std::normal_distribution<float> noise(0, 0.01);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    data[i] = 1000.f + 50.f * std::sin(i * 0.001f) + noise(gen);
+  }
+  std::size_t compressed_size;
+  BOOST_CHECK(roundTrip(data, compressed_size) == data);
+  BOOST_CHECK_LT(compressed_size, data.size() * sizeof(float));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Random_test) {
+  std::vector<std::int64_t> data(100 * 37);
+  std::mt19937_64 gen(0);
+  for (auto& v : data) {
+    v = gen();
+  }
+  std::size_t compressed_size;
+  BOOST_CHECK(roundTrip(data, compressed_size) == data);
+  BOOST_CHECK_LE(compressed_size, data.size() * sizeof(std::int64_t) + 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Small_test) {
+  for (std::size_t size = 0; size < 10; ++size) {
+    std::vector<double> data(size, 3.);
+    std::size_t compressed_size;
+    BOOST_CHECK(roundTrip(data, compressed_size) == data);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,544 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * TileManager_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+#include "SEFramework/Image/WriteableBufferedImage.h"
+#include "SEFramework/Image/TileManager.h"
+
+using namespace SourceXtractor;
+
+/**
+ * Image source that generates empty tiles, counting how many times it has been asked for one
+ */
+class CountingImageSource : public ImageSource {
+public:
+  CountingImageSource(int width, int height, int delay_ms = 0, bool reentrant = true)
+    : m_width(width), m_height(height), m_delay_ms(delay_ms), m_tile_count(0), m_native_tile_size(0, 0),
+      m_reentrant(reentrant), m_active(0), m_max_active(0) {}
+
+  virtual ~CountingImageSource() = default;
+
+  std::string getRepr() const override {
+    return "CountingImageSource";
+  }
+
+  void saveTile(ImageTile&) override {
+    assert(false);
+  }
+
+  int getWidth() const override {
+    return m_width;
+  }
+
+  int getHeight() const override {
+    return m_height;
+  }
+
+  std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const override {
+    ++m_tile_count;
+    int active = ++m_active;
+    int max_active = m_max_active;
+    while (active > max_active && !m_max_active.compare_exchange_weak(max_active, active));
+    if (m_delay_ms > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(m_delay_ms));
+    }
+    --m_active;
+    return ImageTile::create(ImageTile::FloatImage, x, y, width, height);
+  }
+
+  ImageTile::ImageType getType() const override {
+    return ImageTile::FloatImage;
+  }
+
+  std::pair<int, int> getNativeTileSize() const override {
+    return m_native_tile_size;
+  }
+
+  bool isReentrant() const override {
+    return m_reentrant;
+  }
+
+  int m_width, m_height, m_delay_ms;
+  mutable std::atomic<int> m_tile_count;
+  std::pair<int, int> m_native_tile_size;
+  bool m_reentrant;
+  // Number of getImageTile calls running, and the most seen at once
+  mutable std::atomic<int> m_active, m_max_active;
+};
+
+/**
+ * Image source keeping its pixels in memory, recording the batches of tiles saved
+ */
+class StoringImageSource : public ImageSource, public std::enable_shared_from_this<ImageSource> {
+public:
+  StoringImageSource(int width, int height, int save_delay_ms = 0)
+    : m_width(width), m_height(height), m_save_delay_ms(save_delay_ms), m_fail_saves(false),
+      m_pixels(width * height, 0.f) {}
+
+  virtual ~StoringImageSource() = default;
+
+  std::string getRepr() const override {
+    return "StoringImageSource";
+  }
+
+  void saveTile(ImageTile& tile) override {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    for (int y = tile.getPosY(); y < tile.getPosY() + tile.getHeight(); ++y) {
+      for (int x = tile.getPosX(); x < tile.getPosX() + tile.getWidth(); ++x) {
+        m_pixels[x + y * m_width] = tile.getValue<float>(x, y);
+      }
+    }
+  }
+
+  void saveTiles(const std::vector<std::shared_ptr<ImageTile>>& tiles) override {
+    if (m_save_delay_ms > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(m_save_delay_ms));
+    }
+    if (m_fail_saves) {
+      throw std::runtime_error("Failed to save the tiles");
+    }
+    std::vector<std::pair<int, int>> positions;
+    for (auto& tile : tiles) {
+      saveTile(*tile);
+      positions.emplace_back(tile->getPosX(), tile->getPosY());
+    }
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_batches.emplace_back(std::move(positions));
+  }
+
+  int getWidth() const override {
+    return m_width;
+  }
+
+  int getHeight() const override {
+    return m_height;
+  }
+
+  std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const override {
+    auto tile = ImageTile::create(ImageTile::FloatImage, x, y, width, height,
+                                  std::const_pointer_cast<ImageSource>(shared_from_this()));
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    for (int iy = y; iy < y + height; ++iy) {
+      for (int ix = x; ix < x + width; ++ix) {
+        tile->setValue(ix, iy, m_pixels[ix + iy * m_width]);
+      }
+    }
+    return tile;
+  }
+
+  ImageTile::ImageType getType() const override {
+    return ImageTile::FloatImage;
+  }
+
+  int m_width, m_height, m_save_delay_ms;
+  std::atomic<bool> m_fail_saves;
+  mutable boost::mutex m_mutex;
+  std::vector<float> m_pixels;
+  std::vector<std::vector<std::pair<int, int>>> m_batches;
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (TileManager_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (CacheHit_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  auto source = std::make_shared<CountingImageSource>(8, 8);
+
+  auto tile = tile_manager->getTileForPixel(1, 1, source);
+  BOOST_CHECK_EQUAL(tile->getPosX(), 0);
+  BOOST_CHECK_EQUAL(tile->getPosY(), 0);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 1);
+
+  auto same = tile_manager->getTileForPixel(3, 2, source);
+  BOOST_CHECK_EQUAL(tile, same);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 1);
+
+  auto other = tile_manager->getTileForPixel(5, 7, source);
+  BOOST_CHECK_EQUAL(other->getPosX(), 4);
+  BOOST_CHECK_EQUAL(other->getPosY(), 4);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 2);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * With room for only two tiles, a hit must refresh the recency of the tile
+ * so the *other* one is evicted
+ */
+BOOST_AUTO_TEST_CASE (LeastRecentlyUsed_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  // 512x512 float tiles use 1 MiB each, so two fit once the share of the buffer pool is set aside
+  tile_manager->setOptions(512, 512, 3);
+  auto source = std::make_shared<CountingImageSource>(512 * 3, 512);
+
+  tile_manager->getTileForPixel(0, 0, source);
+  tile_manager->getTileForPixel(512, 0, source);
+  tile_manager->getTileForPixel(0, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 2);
+
+  // Evicts the second tile
+  tile_manager->getTileForPixel(1024, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 3);
+
+  tile_manager->getTileForPixel(0, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 3);
+  tile_manager->getTileForPixel(512, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 4);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (Flush_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  auto source = std::make_shared<CountingImageSource>(8, 8);
+
+  tile_manager->getTileForPixel(0, 0, source);
+  tile_manager->flush();
+  tile_manager->getTileForPixel(0, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 2);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Concurrent misses on the same tile must read it only once
+ */
+BOOST_AUTO_TEST_CASE (ConcurrentMiss_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  auto source = std::make_shared<CountingImageSource>(8, 8, 50);
+
+  std::vector<std::thread> threads;
+  std::vector<std::shared_ptr<ImageTile>> tiles(8);
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    threads.emplace_back([&tiles, &tile_manager, &source, i]() {
+      tiles[i] = tile_manager->getTileForPixel(i % 4, 0, source);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  BOOST_CHECK_EQUAL(source->m_tile_count, 1);
+  for (auto& tile : tiles) {
+    BOOST_CHECK_EQUAL(tile, tiles.front());
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Different tiles of a re-entrant source are read concurrently, those of any other source one at a time
+ */
+BOOST_AUTO_TEST_CASE (NonReentrantSource_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+
+  for (bool reentrant : {true, false}) {
+    auto source = std::make_shared<CountingImageSource>(16, 4, 50, reentrant);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&tile_manager, &source, i]() {
+        tile_manager->getTileForPixel(i * 4, 0, source);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    BOOST_CHECK_EQUAL(source->m_tile_count, 4);
+    if (reentrant) {
+      BOOST_CHECK_GT(source->m_max_active, 1);
+    }
+    else {
+      BOOST_CHECK_EQUAL(source->m_max_active, 1);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * A hinted region must end in the cache without the caller asking for it
+ */
+BOOST_AUTO_TEST_CASE (ReadAhead_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1, 2);
+  BOOST_CHECK_EQUAL(tile_manager->getReadAhead(), 2);
+
+  auto source = std::make_shared<CountingImageSource>(8, 8);
+  auto image = BufferedImage<SeFloat>::create(source, tile_manager);
+
+  tile_manager->prefetch(image, 0, 4, 8, 4);
+  for (int i = 0; i < 100 && source->m_tile_count < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  BOOST_CHECK_EQUAL(source->m_tile_count, 2);
+
+  image->getChunk(0, 4, 8, 4);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 2);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * An evicted tile must be restored from the compressed tier, not read again
+ */
+BOOST_AUTO_TEST_CASE (CompressedTier_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  // 512x512 float tiles use 1 MiB each, so two fit once the share of the buffer pool is set aside
+  tile_manager->setOptions(512, 512, 3, 0, 2);
+  auto source = std::make_shared<CountingImageSource>(512 * 3, 512);
+
+  auto tile = tile_manager->getTileForPixel(0, 0, source);
+  auto data = static_cast<float*>(tile->getDataPtr());
+  for (int i = 0; i < 512 * 512; ++i) {
+    data[i] = (i % 512) * 0.25f;
+  }
+  tile.reset();
+
+  tile_manager->getTileForPixel(512, 0, source);
+  // Evicts the first tile
+  tile_manager->getTileForPixel(1024, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 3);
+
+  tile = tile_manager->getTileForPixel(0, 0, source);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 3);
+  BOOST_CHECK_EQUAL(tile->getPosX(), 0);
+  BOOST_CHECK_EQUAL(tile->getWidth(), 512);
+  BOOST_CHECK_EQUAL(tile->getValue<float>(511, 3), 127.75f);
+  BOOST_CHECK_EQUAL(tile->getValue<float>(10, 500), 2.5f);
+
+  auto stats = tile_manager->getStatistics();
+  BOOST_CHECK_EQUAL(stats.m_memory_hits, 0);
+  BOOST_CHECK_EQUAL(stats.m_compressed_hits, 1);
+  BOOST_CHECK_EQUAL(stats.m_source_reads, 3);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Modified tiles are saved in a single batch, in row order
+ */
+BOOST_AUTO_TEST_CASE (SaveBatch_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  auto source = std::make_shared<StoringImageSource>(12, 8);
+  auto image = WriteableBufferedImage<float>::create(source, tile_manager);
+
+  image->setValue(9, 5, 1.f);
+  image->setValue(1, 6, 2.f);
+  image->setValue(5, 1, 3.f);
+  tile_manager->saveAllTiles();
+
+  BOOST_REQUIRE_EQUAL(source->m_batches.size(), 1);
+  std::vector<std::pair<int, int>> expected{{4, 0}, {0, 4}, {8, 4}};
+  BOOST_CHECK(source->m_batches.front() == expected);
+  BOOST_CHECK_EQUAL(source->m_pixels[9 + 5 * 12], 1.f);
+  BOOST_CHECK_EQUAL(source->m_pixels[1 + 6 * 12], 2.f);
+  BOOST_CHECK_EQUAL(source->m_pixels[5 + 1 * 12], 3.f);
+
+  // Nothing left to save
+  tile_manager->saveAllTiles();
+  BOOST_CHECK_EQUAL(source->m_batches.size(), 1);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Modified tiles evicted, whether written back yet or not, must be read back with their modifications
+ */
+BOOST_AUTO_TEST_CASE (WriteBack_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  // 512x512 float tiles use 1 MiB each, so only one fits
+  tile_manager->setOptions(512, 512, 2);
+  auto source = std::make_shared<StoringImageSource>(512 * 4, 512, 20);
+  auto image = WriteableBufferedImage<float>::create(source, tile_manager);
+
+  for (int i = 0; i < 4; ++i) {
+    image->setValue(i * 512 + 7, 3, i + 1.f);
+  }
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(image->getChunk(i * 512 + 7, 3, 1, 1)->getValue(0, 0), i + 1.f);
+  }
+
+  tile_manager->saveAllTiles();
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(source->m_pixels[i * 512 + 7 + 3 * 512 * 4], i + 1.f);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Modified tiles that can not be written must be kept, cached or evicted, until a later attempt succeeds
+ */
+BOOST_AUTO_TEST_CASE (FailedWrite_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(512, 512, 2);
+  auto source = std::make_shared<StoringImageSource>(512 * 4, 512);
+  auto image = WriteableBufferedImage<float>::create(source, tile_manager);
+
+  source->m_fail_saves = true;
+  for (int i = 0; i < 4; ++i) {
+    image->setValue(i * 512 + 7, 3, i + 1.f);
+  }
+  BOOST_CHECK_THROW(tile_manager->saveAllTiles(), std::runtime_error);
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(image->getChunk(i * 512 + 7, 3, 1, 1)->getValue(0, 0), i + 1.f);
+  }
+
+  source->m_fail_saves = false;
+  tile_manager->saveAllTiles();
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(source->m_pixels[i * 512 + 7 + 3 * 512 * 4], i + 1.f);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (SourceStatistics_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(512, 512, 3);
+  // Both have the same representation, so they are counted together
+  auto source_a = std::make_shared<CountingImageSource>(512 * 2, 512);
+  auto source_b = std::make_shared<CountingImageSource>(512, 512);
+  auto storing = std::make_shared<StoringImageSource>(512, 512);
+
+  tile_manager->getTileForPixel(0, 0, source_a);
+  tile_manager->getTileForPixel(512, 0, source_a);
+  tile_manager->getTileForPixel(0, 0, source_a);
+  // Evicts the second tile of the first source
+  tile_manager->getTileForPixel(0, 0, source_b);
+
+  auto image = WriteableBufferedImage<float>::create(storing, tile_manager);
+  image->setValue(0, 0, 1.f);
+  image.reset();
+  tile_manager->saveAllTiles();
+
+  auto stats = tile_manager->getSourceStatistics();
+  BOOST_REQUIRE_EQUAL(stats.size(), 2);
+
+  BOOST_CHECK_EQUAL(stats[0].m_repr, "CountingImageSource");
+  BOOST_CHECK_EQUAL(stats[0].m_hits, 1);
+  BOOST_CHECK_EQUAL(stats[0].m_misses, 3);
+  BOOST_CHECK_EQUAL(stats[0].m_evictions, 2);
+  BOOST_CHECK_EQUAL(stats[0].m_bytes_read, 3 * 1024 * 1024);
+  BOOST_CHECK_EQUAL(stats[0].m_bytes_written, 0);
+  BOOST_CHECK_GE(stats[0].m_read_time, 0.);
+
+  BOOST_CHECK_EQUAL(stats[1].m_repr, "StoringImageSource");
+  BOOST_CHECK_EQUAL(stats[1].m_misses, 1);
+  BOOST_CHECK_EQUAL(stats[1].m_bytes_written, 1024 * 1024);
+
+  tile_manager->flush();
+  BOOST_CHECK(tile_manager->getSourceStatistics().empty());
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Tiles must be made of whole compression tiles, so none is decompressed twice
+ */
+BOOST_AUTO_TEST_CASE (NativeTileSize_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  // One compression tile every three rows, as fpack does by default
+  auto source = std::make_shared<CountingImageSource>(12, 12);
+  source->m_native_tile_size = {12, 3};
+
+  BOOST_CHECK_EQUAL(tile_manager->getTileWidth(*source), 12);
+  BOOST_CHECK_EQUAL(tile_manager->getTileHeight(*source), 3);
+
+  auto tile = tile_manager->getTileForPixel(5, 7, source);
+  BOOST_CHECK_EQUAL(tile->getPosX(), 0);
+  BOOST_CHECK_EQUAL(tile->getPosY(), 6);
+  BOOST_CHECK_EQUAL(tile->getWidth(), 12);
+  BOOST_CHECK_EQUAL(tile->getHeight(), 3);
+
+  auto same = tile_manager->getTileForPixel(11, 8, source);
+  BOOST_CHECK_EQUAL(tile, same);
+  BOOST_CHECK_EQUAL(source->m_tile_count, 1);
+
+  // Sources without compression tiles keep the configured size
+  auto plain = std::make_shared<CountingImageSource>(12, 12);
+  BOOST_CHECK_EQUAL(tile_manager->getTileWidth(*plain), 4);
+  BOOST_CHECK_EQUAL(tile_manager->getTileHeight(*plain), 4);
+}
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Inside a sweep, a streaming TileManager reads the chunks straight from the source, without caching them
+ */
+BOOST_AUTO_TEST_CASE (Sweep_test) {
+  auto tile_manager = std::make_shared<TileManager>();
+  tile_manager->setOptions(4, 4, 1);
+  auto source = std::make_shared<StoringImageSource>(8, 8);
+  for (int i = 0; i < 64; ++i) {
+    source->m_pixels[i] = i;
+  }
+  auto image = BufferedImage<SeFloat>::create(source, tile_manager);
+
+  // Without the streaming enabled, the sweep makes no difference
+  {
+    TileManager::Sweep sweep;
+    BOOST_CHECK(!tile_manager->isSweeping());
+  }
+
+  tile_manager->setStreaming(true);
+  BOOST_CHECK(!tile_manager->isSweeping());
+  {
+    TileManager::Sweep sweep;
+    BOOST_CHECK(tile_manager->isSweeping());
+
+    auto chunk = image->getChunk(1, 2, 6, 5);
+    for (int y = 0; y < 5; ++y) {
+      for (int x = 0; x < 6; ++x) {
+        BOOST_CHECK_EQUAL(chunk->getValue(x, y), (x + 1) + (y + 2) * 8);
+      }
+    }
+    BOOST_CHECK_EQUAL(tile_manager->getStatistics().m_source_reads, 1);
+  }
+  BOOST_CHECK(!tile_manager->isSweeping());
+
+  // Nothing was cached, so the tiles are read again once out of the sweep
+  image->getChunk(1, 2, 6, 5);
+  auto stats = tile_manager->getStatistics();
+  BOOST_CHECK_EQUAL(stats.m_source_reads, 5);
+  BOOST_CHECK_EQUAL(stats.m_memory_hits, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -25,6 +25,7 @@
 #define _SEIMPLEMENTATION_BACKGROUND_BACKGROUNDANALYZERFACTORY_H_
 
 #include "Configuration/Configuration.h"
+#include "AlexandriaKernel/ThreadPool.h"
 
 #include "SEImplementation/Configuration/SE2BackgroundConfig.h"
 #include "SEImplementation/Configuration/WeightImageConfig.h"
@@ -43,13 +44,26 @@ public:
   std::shared_ptr<BackgroundAnalyzer> createBackgroundAnalyzer() const;
   std::shared_ptr<BackgroundAnalyzer> createBackgroundAnalyzer(WeightImageConfig::WeightType weight_type) const;
 
+  /**
+   * Same, but the models are kept in the background cache directory, if any, and reused by later runs
+   * @param pixels_id
+   *    Identifies the pixels whose background is analyzed, see CachedBackgroundAnalyzer::identifyPixels.
+   *    Nothing is cached if empty
+   */
+  std::shared_ptr<BackgroundAnalyzer> createBackgroundAnalyzer(WeightImageConfig::WeightType weight_type,
+                                                               const std::string& pixels_id) const;
+
   void initialize(const UserValues& args) override;
 
 private:
   std::vector<int> m_cell_size;
   std::vector<int> m_smoothing_box;
   bool m_legacy;
+  bool m_materialize;
+  std::string m_cache_directory;
+  std::uintmax_t m_cache_size;
   WeightImageConfig::WeightType m_weight_type;
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
 };
 
 }
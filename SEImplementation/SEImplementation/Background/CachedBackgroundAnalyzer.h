@@ -0,0 +1,99 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * CachedBackgroundAnalyzer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEIMPLEMENTATION_BACKGROUND_CACHEDBACKGROUNDANALYZER_H_
+#define _SEIMPLEMENTATION_BACKGROUND_CACHEDBACKGROUNDANALYZER_H_
+
+#include <cstdint>
+
+#include <boost/filesystem/path.hpp>
+
+#include "AlexandriaKernel/ThreadPool.h"
+
+#include "SEFramework/Background/BackgroundAnalyzer.h"
+
+namespace SourceXtractor {
+
+/**
+ * Keeps the models of another analyzer in a directory, so later runs over the same pixels reuse them
+ * instead of analyzing the background again.
+ *
+ * A model is stored as a FITS file with the level and the variance maps at full resolution, found by
+ * a key made of the pixels identifier, the parameters of the analysis and the variance threshold.
+ *
+ * Reading a model refreshes its modification time. When the models in the directory exceed the maximum size,
+ * the ones not used for the longest time are removed after a new one is written.
+ */
+class CachedBackgroundAnalyzer : public BackgroundAnalyzer {
+public:
+
+  /**
+   * @param analyzer
+   *    Computes the models not found in the cache
+   * @param cache_directory
+   *    Where the models are kept. Created if it does not exist
+   * @param key
+   *    Identifies the pixels and the parameters of the analysis, see identifyPixels
+   * @param max_cache_size
+   *    Bytes kept in the directory, unlimited if 0
+   * @param thread_pool
+   *    Used to write the maps of new models, if set
+   */
+  CachedBackgroundAnalyzer(std::shared_ptr<BackgroundAnalyzer> analyzer, const boost::filesystem::path& cache_directory,
+                           const std::string& key, std::uintmax_t max_cache_size = 0,
+                           const std::shared_ptr<Euclid::ThreadPool>& thread_pool = nullptr);
+
+  virtual ~CachedBackgroundAnalyzer() = default;
+
+  BackgroundModel analyzeBackground(
+      std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map,
+      std::shared_ptr<Image<unsigned char>> mask, WeightImage::PixelType variance_threshold) const override;
+
+  /**
+   * Identifies the pixels whose background is analyzed: the content of the image and weight files (path, size
+   * and modification time), and how they are scaled.
+   * @return
+   *    An empty string if any of them is not a regular file (i.e. cfitsio extended syntax), so it can not be cached
+   */
+  static std::string identifyPixels(const std::string& image_path, int image_hdu, double flux_scale,
+                                    const std::string& weight_path, int weight_hdu, double weight_scaling,
+                                    bool weight_absolute);
+
+private:
+  std::unique_ptr<BackgroundModel> readCache(const boost::filesystem::path& cache_path, const std::string& key,
+                                             int width, int height) const;
+
+  void writeCache(const boost::filesystem::path& cache_path, const std::string& key,
+                  const BackgroundModel& model) const;
+
+  void evictCache(const boost::filesystem::path& cache_path) const;
+
+  std::shared_ptr<BackgroundAnalyzer> m_analyzer;
+  boost::filesystem::path m_cache_directory;
+  std::string m_key;
+  std::uintmax_t m_max_cache_size;
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
+};
+
+} // end of namespace SourceXtractor
+
+#endif // _SEIMPLEMENTATION_BACKGROUND_CACHEDBACKGROUNDANALYZER_H_
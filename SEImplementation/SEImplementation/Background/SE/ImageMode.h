@@ -18,7 +18,12 @@
 #ifndef SOURCEXTRACTORPLUSPLUS_IMAGEMODE_H
 #define SOURCEXTRACTORPLUSPLUS_IMAGEMODE_H
 
+#include <atomic>
+
+#include "AlexandriaKernel/ThreadPool.h"
+
 #include "SEFramework/Image/Image.h"
+#include "SEFramework/Image/ImageChunk.h"
 #include "SEFramework/Image/VectorImage.h"
 
 namespace SourceXtractor {
@@ -64,11 +69,15 @@ public:
    *    Relative tolerance used to test for convergence around the median
    * @param max_iter
    *    Maximum number of iterations
+   * @param thread_pool
+   *    If given, the rows of cells are processed concurrently on this pool.
+   *    The result does not depend on the number of threads.
    */
   ImageMode(const std::shared_ptr<Image<T>>& image, const std::shared_ptr<Image<T>>& variance,
             int cell_w, int cell_h,
             T invalid_value, T kappa1 = 2, T kappa2 = 5, T kappa3 = 3,
-            T rtol = 1e-4, size_t max_iter = 100);
+            T rtol = 1e-4, size_t max_iter = 100,
+            const std::shared_ptr<Euclid::ThreadPool>& thread_pool = nullptr);
 
   /**
    * Destructor
@@ -110,7 +119,10 @@ private:
   size_t m_max_iter;
 
   std::tuple<T, T> getBackGuess(const std::vector<T> &data) const;
-  void processCell(const Image<T>& img, int x, int y, VectorImage<T>& out_mode, VectorImage<T>& out_sigma) const;
+  /// Computes the cell (x, y) from the band of pixels covering its row of cells
+  void processCell(const ImageChunk<T>& band, int x, int y, VectorImage<T>& out_mode, VectorImage<T>& out_sigma,
+                   std::vector<T>& buffer) const;
+  void processRows(const Image<T>& image, const Image<T>* variance, std::atomic<int>& next_row) const;
 };
 
 extern template
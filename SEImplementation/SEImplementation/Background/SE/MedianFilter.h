@@ -18,8 +18,16 @@
 #ifndef SOURCEXTRACTORPLUSPLUS_MEDIANFILTER_H
 #define SOURCEXTRACTORPLUSPLUS_MEDIANFILTER_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "AlexandriaKernel/ThreadPool.h"
 #include "SEFramework/Image/VectorImage.h"
 #include "SEFramework/Image/WriteableImage.h"
+#include "SEImplementation/Background/Utils.h"
 
 namespace SourceXtractor {
 
@@ -35,6 +43,10 @@ namespace SourceXtractor {
  *  replaced also by the median of the variances contained within the box.
  *
  *  There is no padding. At the edges whe box size is *symmetrically* clipped to the number of available pixels.
+ *
+ *  The pixel values are replaced by their rank among the distinct values of the image, so the box can be
+ *  kept as a histogram of ranks that is updated column by column while it slides along a row, and the median
+ *  is selected from the histogram. The rows are filtered concurrently if a thread pool is given.
  */
 template<typename T>
 class MedianFilter {
@@ -43,8 +55,11 @@ public:
    * Constructor
    * @param box_width
    * @param box_height
+   * @param thread_pool
+   *    If not null, the rows are distributed between the calling thread and the pool
    */
-  MedianFilter(int box_width, int box_height) : m_box_width(box_width), m_box_height(box_height) {
+  MedianFilter(int box_width, int box_height, std::shared_ptr<Euclid::ThreadPool> thread_pool = nullptr)
+    : m_box_width(box_width), m_box_height(box_height), m_thread_pool(std::move(thread_pool)) {
   }
 
   /**
@@ -52,7 +67,8 @@ public:
    * @param box
    *    A two dimensional array where the first value corresponds to the width, and the second to the height.
    */
-  MedianFilter(const std::array<int, 2>& box) : MedianFilter(box[0], box[1]) {
+  MedianFilter(const std::array<int, 2>& box, std::shared_ptr<Euclid::ThreadPool> thread_pool = nullptr)
+    : MedianFilter(box[0], box[1], std::move(thread_pool)) {
   }
 
   /**
@@ -75,40 +91,123 @@ public:
     auto out_img = VectorImage<T>::create(image.getWidth(), image.getHeight());
     auto out_var = VectorImage<T>::create(image.getWidth(), image.getHeight());
 
-    for (int y = 0; y < image.getHeight(); ++y) {
-      for (int x = 0; x < image.getWidth(); ++x) {
-        auto box = getBox(image, x, y);
-        auto median = getMedian(box);
-        auto value = image.getValue(x, y);
-        if (std::abs(median - value) >= threshold) {
-          out_img->setValue(x, y, median);
-          auto var_box = getBox(variance, x, y);
-          out_var->setValue(x, y, getMedian(var_box));
-        }
-        else {
-          out_img->setValue(x, y, value);
-          out_var->setValue(x, y, variance.getValue(x, y));
-        }
+    Ranks img_ranks(image), var_ranks(variance);
+
+    // Each row is written only by the thread filtering it
+    std::atomic<int> next_row(0);
+    runOnThreadPool(m_thread_pool, image.getHeight(), [&]() {
+      RankHistogram img_histo(img_ranks.m_values.size()), var_histo(var_ranks.m_values.size());
+      for (int y = next_row++; y < image.getHeight(); y = next_row++) {
+        filterRow(image, variance, threshold, y, img_ranks, var_ranks, img_histo, var_histo, *out_img, *out_var);
       }
-    }
+    });
 
     return std::make_pair(out_img, out_var);
   }
 
 private:
   int m_box_width, m_box_height;
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
 
-  /**
-   * Convenience method to compute the median of a vector
-   * @param data
-   *    The vector on which to compute the median. *It will be modified*.
-   */
-  static T getMedian(std::vector<T>& data) {
-    std::sort(data.begin(), data.end());
-    auto nitems = data.size();
+  /// Distinct values of an image, sorted, and the rank of each pixel among them
+  struct Ranks {
+    explicit Ranks(const VectorImage<T>& img) : m_values(img.getData()), m_width(img.getWidth()) {
+      std::sort(m_values.begin(), m_values.end());
+      m_values.erase(std::unique(m_values.begin(), m_values.end()), m_values.end());
+      m_ranks.reserve(img.getData().size());
+      for (auto v : img.getData()) {
+        m_ranks.emplace_back(std::lower_bound(m_values.begin(), m_values.end(), v) - m_values.begin());
+      }
+    }
+
+    int getRank(int x, int y) const {
+      return m_ranks[x + y * m_width];
+    }
+
+    std::vector<T> m_values;
+    std::vector<int> m_ranks;
+    int m_width;
+  };
+
+  /// Number of pixels per rank within the box, as a Fenwick tree so both updates and selections are logarithmic
+  class RankHistogram {
+  public:
+    explicit RankHistogram(size_t nranks) : m_tree(nranks + 1), m_top(1) {
+      while (m_top * 2 <= nranks) {
+        m_top *= 2;
+      }
+    }
+
+    void clear() {
+      std::fill(m_tree.begin(), m_tree.end(), 0);
+    }
+
+    void add(int rank, int count) {
+      for (size_t i = rank + 1; i < m_tree.size(); i += i & (~i + 1)) {
+        m_tree[i] += count;
+      }
+    }
+
+    /// Rank of the k-th pixel, starting from 0, in increasing order
+    int select(int k) const {
+      size_t pos = 0;
+      for (size_t step = m_top; step > 0; step /= 2) {
+        if (pos + step < m_tree.size() && m_tree[pos + step] <= k) {
+          pos += step;
+          k -= m_tree[pos];
+        }
+      }
+      return pos;
+    }
+
+  private:
+    std::vector<int> m_tree;
+    size_t m_top;
+  };
+
+  static T getMedian(const Ranks& ranks, const RankHistogram& histo, int nitems) {
     if (nitems % 2 == 1)
-      return data[nitems / 2];
-    return (data[nitems / 2] + data[nitems / 2 - 1]) / 2;
+      return ranks.m_values[histo.select(nitems / 2)];
+    return (ranks.m_values[histo.select(nitems / 2)] + ranks.m_values[histo.select(nitems / 2 - 1)]) / 2;
+  }
+
+  void filterRow(const VectorImage<T>& image, const VectorImage<T>& variance, T threshold, int y,
+                 const Ranks& img_ranks, const Ranks& var_ranks, RankHistogram& img_histo, RankHistogram& var_histo,
+                 VectorImage<T>& out_img, VectorImage<T>& out_var) const {
+    int hh = clip(y, m_box_height, image.getHeight());
+    img_histo.clear();
+    var_histo.clear();
+
+    auto update_column = [&](int x, int count) {
+      for (int iy = y - hh; iy <= y + hh; ++iy) {
+        img_histo.add(img_ranks.getRank(x, iy), count);
+        var_histo.add(var_ranks.getRank(x, iy), count);
+      }
+    };
+
+    // Both ends of the box only move forward along the row, even where it is clipped
+    int first = 0, last = 0;
+    for (int x = 0; x < image.getWidth(); ++x) {
+      int hw = clip(x, m_box_width, image.getWidth());
+      for (; last <= x + hw; ++last) {
+        update_column(last, 1);
+      }
+      for (; first < x - hw; ++first) {
+        update_column(first, -1);
+      }
+
+      int nitems = (2 * hw + 1) * (2 * hh + 1);
+      auto median = getMedian(img_ranks, img_histo, nitems);
+      auto value = image.getValue(x, y);
+      if (std::abs(median - value) >= threshold) {
+        out_img.setValue(x, y, median);
+        out_var.setValue(x, y, getMedian(var_ranks, var_histo, nitems));
+      }
+      else {
+        out_img.setValue(x, y, value);
+        out_var.setValue(x, y, variance.getValue(x, y));
+      }
+    }
   }
 
   /**
@@ -124,29 +223,8 @@ private:
    *    As many pixels as could be read safely from the image, up to box_size
    */
   static int clip(int position, int box_size, int image_size) {
-    box_size /= 2;
-    if (box_size > position)
-      return position;
-    if (box_size > image_size - position - 1)
-      return image_size - position - 1;
-    return box_size;
-  }
-
-  /**
-   * Get the pixel values contained within a box centered at x,y
-   */
-  std::vector<T> getBox(const VectorImage<T>& img, int x, int y) const {
-    int hw = clip(x, m_box_width, img.getWidth());
-    int hh = clip(y, m_box_height, img.getHeight());
-    std::vector<T> data;
-    auto inserter = std::back_inserter(data);
-    for (int iy = -hh; iy < hh + 1; ++iy) {
-      for (int ix = -hw; ix < hw + 1; ++ix) {
-        *inserter = img.getValue(x + ix, y + iy);
-        ++inserter;
-      }
-    }
-    return data;
+    // Boxes larger than the image must be clipped on both sides
+    return std::min({box_size / 2, position, image_size - position - 1});
   }
 };
 
@@ -18,6 +18,8 @@
 #ifndef SOURCEXTRACTORPLUSPLUS_SEBACKGROUNDLEVELANALYZER_H
 #define SOURCEXTRACTORPLUSPLUS_SEBACKGROUNDLEVELANALYZER_H
 
+#include "AlexandriaKernel/ThreadPool.h"
+
 #include "SEFramework/Frame/Frame.h"
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Background/BackgroundAnalyzer.h"
@@ -28,7 +30,9 @@ namespace SourceXtractor {
 class SEBackgroundLevelAnalyzer : public BackgroundAnalyzer {
 public:
   SEBackgroundLevelAnalyzer(const std::vector<int>& cell_size, const std::vector<int>& smoothing_box,
-                            const WeightImageConfig::WeightType weight_type);
+                            const WeightImageConfig::WeightType weight_type,
+                            const std::shared_ptr<Euclid::ThreadPool>& thread_pool = nullptr,
+                            bool materialize = false);
 
   virtual ~SEBackgroundLevelAnalyzer() = default;
 
@@ -41,6 +45,12 @@ private:
   std::array<int, 2> m_smoothing_box;
 
   WeightImageConfig::WeightType m_weight_type;
+
+  // Processes the background cells concurrently, if set
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
+
+  // Compute the full resolution background once, instead of interpolating it on demand
+  bool m_materialize;
 };
 
 } // end of namespace SourceXtractor
@@ -39,6 +39,8 @@ public:
 
   //void fillInData(const PIXTYPE* cellData, const size_t ndata);
   void addDatum(const PIXTYPE& pixVal);
+  // same as addDatum for each value, skipping those whose weight is not below the threshold
+  void addData(const PIXTYPE* pixVals, const size_t ndata, const PIXTYPE* weights=NULL, const PIXTYPE weightThresh=BIG);
   
   void getBackGuessMod(PIXTYPE& bckVal, PIXTYPE& sigmaVal);
   void getBackGuess(PIXTYPE& bckVal, PIXTYPE& sigmaVal);
@@ -24,6 +24,8 @@
 #ifndef _SEIMPLEMENTATION_BACKGROUND_SE2BACKGROUNDANALYZER_H_
 #define _SEIMPLEMENTATION_BACKGROUND_SE2BACKGROUNDANALYZER_H_
 
+#include "AlexandriaKernel/ThreadPool.h"
+
 #include "SEFramework/Frame/Frame.h"
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Background/BackgroundAnalyzer.h"
@@ -36,7 +38,9 @@ class SE2BackgroundLevelAnalyzer : public BackgroundAnalyzer {
 public:
 
   SE2BackgroundLevelAnalyzer(const std::vector<int>& cell_size, const std::vector<int>& smoothing_box,
-                             const WeightImageConfig::WeightType weight_type);
+                             const WeightImageConfig::WeightType weight_type,
+                             const std::shared_ptr<Euclid::ThreadPool>& thread_pool = nullptr,
+                             bool materialize = false);
 
   virtual ~SE2BackgroundLevelAnalyzer() = default;
 
@@ -52,6 +56,12 @@ private:
   std::array<int, 2> m_smoothing_box;
 
   WeightImageConfig::WeightType m_weight_type;
+
+  // Processes the background cells concurrently, if set
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
+
+  // Compute the full resolution background once, instead of interpolating it on demand
+  bool m_materialize;
 };
 
 }
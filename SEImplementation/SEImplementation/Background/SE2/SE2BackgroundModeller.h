@@ -29,6 +29,7 @@
 #include <memory>
 #include <boost/filesystem.hpp>
 #include "fitsio.h"
+#include "AlexandriaKernel/ThreadPool.h"
 #include "SEFramework/Image/Image.h"
 #include "SEImplementation/Background/SE2/BackgroundDefine.h"
 #include "SEImplementation/Background/SE2/TypedSplineModelWrapper.h"
@@ -38,7 +39,7 @@ namespace SourceXtractor {
 class SE2BackgroundModeller {
 
 public:
-  SE2BackgroundModeller(std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map=nullptr, std::shared_ptr<Image<unsigned char>> mask=nullptr, const unsigned char mask_type_flag=0x0001);
+  SE2BackgroundModeller(std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map=nullptr, std::shared_ptr<Image<unsigned char>> mask=nullptr, const unsigned char mask_type_flag=0x0001, const std::shared_ptr<Euclid::ThreadPool>& thread_pool=nullptr);
   virtual ~SE2BackgroundModeller();
 
   void createSE2Models(std::shared_ptr<TypedSplineModelWrapper<SeFloat>> &bckPtr, std::shared_ptr<TypedSplineModelWrapper<SeFloat>> &sigPtr, PIXTYPE &sigFac, const size_t *bckCellSize,  const WeightImage::PixelType varianceThreshold,  const size_t *filterBoxSize, const float &filterThreshold=0.0);
@@ -69,6 +70,8 @@ private:
 
   bool itsHasVariance=false;
   bool itsHasMask=false;
+  // the background cells are processed concurrently on this pool, if set
+  std::shared_ptr<Euclid::ThreadPool> itsThreadPool=nullptr;
   //
   PIXTYPE* itsWhtMeanVals=NULL;
   //
@@ -25,6 +25,7 @@
 #ifndef SPLINEMODEL_H
 #define	SPLINEMODEL_H
 
+#include <vector>
 #include <boost/filesystem.hpp>
 #include "SEImplementation/Background/SE2/BackgroundDefine.h"
 
@@ -42,7 +43,8 @@ public:
   void gridToFits(boost::filesystem::path& fitsName, const bool overwrite=true);
   void toFits(boost::filesystem::path& fitsName, const bool overwrite=true);
   PIXTYPE  getValue(size_t x, size_t y);
-  //void splineLine(PIXTYPE *line, const size_t y, const size_t xStart, const size_t width);
+  /// Evaluates the pixels [xStart, xStart+width) of the row y into line. Safe to call from several threads
+  void splineLine(PIXTYPE *line, const size_t y, const size_t xStart, const size_t width) const;
   PIXTYPE& getMedian();
   PIXTYPE * getData();
   PIXTYPE * getDeriv();
@@ -51,10 +53,11 @@ public:
   size_t*  getNaxes();
   size_t  getNGridPoints();
 private:
-  void splineLine(PIXTYPE *line, const size_t y, const size_t xStart, const size_t width);
   PIXTYPE* makeSplineDeriv(const size_t* nGrid, PIXTYPE* gridData);
   PIXTYPE* loadModelFromFits(const boost::filesystem::path);
   PIXTYPE  computeMedian(PIXTYPE* gridData, const size_t nGridPoints);
+  void makeLineCoefficients();
+  static void makeSplineDerivX(const PIXTYPE* node, PIXTYPE* dnode, const int nbx);
 
   size_t itsNaxes[2]={0,0};         // dimension of the image for which the spline was done
   size_t itsGridCellSize[2]={0,0};  // mesh size in x/y of the spline
@@ -64,6 +67,15 @@ private:
   PIXTYPE* itsGridData=NULL;
   PIXTYPE* itsDerivData=NULL;
 
+  // 2nd derivatives along x of the rows of itsGridData and itsDerivData. The x-derivatives
+  // of a row interpolated along y are the same interpolation of these
+  std::vector<PIXTYPE> itsGridDerivX;
+  std::vector<PIXTYPE> itsDerivDerivX;
+
+  // for every pixel of a row, the index of the node to its left and the distance to it
+  std::vector<int> itsXNode;
+  std::vector<PIXTYPE> itsXDx;
+
   PIXTYPE* itsBackLine=NULL;
   size_t itsBackLineY=-1;
 
@@ -25,6 +25,8 @@
 #ifndef TYPEDSPLINEMODELWRAPPER_H
 #define	TYPEDSPLINEMODELWRAPPER_H
 
+#include <algorithm>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include "SEFramework/Image/ImageSource.h"
 #include "SEImplementation/Background/SE2/SplineModel.h"
@@ -77,14 +79,13 @@ public:
 
   std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const override {
     auto tile = ImageTile::create(ImageTile::getTypeValue(T()), x, y, width, height);
-    // Splines are calculated and cached per row. We fill
-    // the tile with the Y axis on the outer loop, so we can
-    // benefit from that caching
-    // @see SplineModel::getValue
+    // The spline is evaluated one row at a time, and only over the columns of the tile
+    // @see SplineModel::splineLine
+    auto data = static_cast<T*>(tile->getDataPtr());
+    std::vector<PIXTYPE> line(width);
     for (auto j = y; j < y + height; ++j) {
-      for (auto i = x; i < x + width; ++i) {
-        tile->setValue(i, j, getValue(i, j));
-      }
+      m_spline_model->splineLine(line.data(), (size_t)j, (size_t)x, (size_t)width);
+      std::copy(line.begin(), line.end(), data + static_cast<std::size_t>(j - y) * width);
     }
     return tile;
   }
@@ -101,6 +102,11 @@ public:
     return ImageTile::getTypeValue(T());
   }
 
+  /// SplineModel::splineLine does not touch the line cached by SplineModel::getValue
+  bool isReentrant() const override {
+    return true;
+  }
+
 private:
   TypedSplineModelWrapper(const size_t* naxes, const size_t* gridCellSize, const size_t* nGrid, PIXTYPE* gridData){
     m_spline_model = new SplineModel(naxes, gridCellSize, nGrid, gridData);
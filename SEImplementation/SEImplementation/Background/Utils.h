@@ -18,12 +18,107 @@
 #ifndef _SEIMPLEMENTATION_BACKGROUND_UTILS_H_
 #define _SEIMPLEMENTATION_BACKGROUND_UTILS_H_
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AlexandriaKernel/ThreadPool.h"
 #include "ElementsKernel/Logging.h"         // for Logging::LogMessageStream, etc
+#include "SEFramework/Image/ImageSource.h"
 
 namespace SourceXtractor {
 
 static Elements::Logging bck_model_logger = Elements::Logging::getLogger("BackgroundModel");
 
+/**
+ * Runs the worker on up to max_workers threads: the calling one, plus as many helpers queued on the thread pool,
+ * if any, as the pool has threads. The workers are expected to share the work between them (i.e. through an
+ * atomic counter), so the calling thread alone finishes it if the pool is busy.
+ * Returns once the calling thread and the helpers that did start are done, rethrowing the first exception raised
+ * by any of them. The helpers still waiting in the queue by then do nothing when they are dequeued.
+ */
+inline void runOnThreadPool(const std::shared_ptr<Euclid::ThreadPool>& thread_pool, int max_workers,
+                            const std::function<void()>& worker) {
+  // Shared with the helpers, which may be dequeued after this function returns
+  struct State {
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    int m_running = 0;
+    bool m_closed = false;
+    std::exception_ptr m_error;
+  };
+  auto state = std::make_shared<State>();
+
+  auto run = [&worker](State& st) {
+    try {
+      worker();
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(st.m_mutex);
+      if (!st.m_error) {
+        st.m_error = std::current_exception();
+      }
+    }
+  };
+
+  if (thread_pool) {
+    int nhelpers = std::min<int>(thread_pool->activeThreads(), max_workers - 1);
+    for (int i = 0; i < nhelpers; ++i) {
+      thread_pool->submit([state, run]() {
+        {
+          std::lock_guard<std::mutex> lock(state->m_mutex);
+          // The caller is gone, and so is the worker
+          if (state->m_closed) {
+            return;
+          }
+          ++state->m_running;
+        }
+        run(*state);
+        std::lock_guard<std::mutex> lock(state->m_mutex);
+        --state->m_running;
+        state->m_done.notify_all();
+      });
+    }
+  }
+
+  run(*state);
+
+  // The helpers running refer to the caller's frame, so they must be done before leaving
+  std::unique_lock<std::mutex> lock(state->m_mutex);
+  state->m_closed = true;
+  state->m_done.wait(lock, [&state]() { return state->m_running == 0; });
+  if (state->m_error) {
+    std::rethrow_exception(state->m_error);
+  }
+}
+
+/**
+ * Median of the values, found by selection instead of sorting them. The values are reordered.
+ * For an even number of values, it is the mean of the two in the middle.
+ */
+template<typename T>
+T selectMedian(std::vector<T>& data) {
+  auto middle = data.begin() + data.size() / 2;
+  std::nth_element(data.begin(), middle, data.end());
+  if (data.size() % 2 == 1) {
+    return *middle;
+  }
+  // nth_element leaves the lower half before the middle, in any order
+  return (*middle + *std::max_element(data.begin(), middle)) / 2;
+}
+
+/**
+ * Evaluates the whole source once, in bands of rows computed concurrently, into a temporary FITS file
+ * and returns the latter. Reading the pixels back through the tile cache is cheaper than evaluating
+ * an interpolated model again each time one of its tiles is evicted.
+ */
+std::shared_ptr<ImageSource> materializeImageSource(const std::shared_ptr<ImageSource>& source,
+                                                    const std::shared_ptr<Euclid::ThreadPool>& thread_pool);
+
 } // end of namespace SourceXtractor
 
 #endif // _SEIMPLEMENTATION_BACKGROUND_UTILS_H_
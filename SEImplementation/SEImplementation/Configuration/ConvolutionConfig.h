@@ -0,0 +1,62 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * ConvolutionConfig.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEIMPLEMENTATION_CONFIGURATION_CONVOLUTIONCONFIG_H_
+#define _SEIMPLEMENTATION_CONFIGURATION_CONVOLUTIONCONFIG_H_
+
+#include "Configuration/Configuration.h"
+
+namespace SourceXtractor {
+
+/**
+ * Selection between the direct and the DFT convolutions of the PSF.
+ * When enabled, the ConvolutionProfile is loaded from its file, or calibrated, when initialized.
+ * It depends on FFTConfig, so the DFT is timed with the requested planning.
+ */
+class ConvolutionConfig : public Euclid::Configuration::Configuration {
+public:
+  ConvolutionConfig(long manager_id);
+
+  virtual ~ConvolutionConfig() = default;
+
+  std::map<std::string, OptionDescriptionList> getProgramOptions() override;
+
+  void initialize(const UserValues& args) override;
+
+  bool isAutoTuned() const {
+    return m_autotune;
+  }
+
+  // file where the calibration is kept between runs, empty if it is not kept
+  const std::string& getProfilePath() const {
+    return m_profile_path;
+  }
+
+private:
+  bool m_autotune;
+  std::string m_profile_path;
+};
+
+}
+
+
+#endif /* _SEIMPLEMENTATION_CONFIGURATION_CONVOLUTIONCONFIG_H_ */
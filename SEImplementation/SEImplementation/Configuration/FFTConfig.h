@@ -0,0 +1,73 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FFTConfig.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef _SEIMPLEMENTATION_CONFIGURATION_FFTCONFIG_H_
+#define _SEIMPLEMENTATION_CONFIGURATION_FFTCONFIG_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Configuration/Configuration.h"
+
+namespace SourceXtractor {
+
+/**
+ * Planning of the Fourier transforms used by the convolutions.
+ * The rigor is applied, the wisdom imported and the requested sizes planned when initialized. Exporting the
+ * wisdom at the end of the run is left to the program.
+ */
+class FFTConfig : public Euclid::Configuration::Configuration {
+public:
+  FFTConfig(long manager_id);
+
+  virtual ~FFTConfig() = default;
+
+  std::map<std::string, OptionDescriptionList> getProgramOptions() override;
+
+  void initialize(const UserValues& args) override;
+
+  // FFTW_ESTIMATE, FFTW_MEASURE or FFTW_PATIENT
+  unsigned getPlanningRigor() const {
+    return m_planning_rigor;
+  }
+
+  // file where the wisdom is kept between runs, empty if it is not kept
+  const std::string& getWisdomPath() const {
+    return m_wisdom_path;
+  }
+
+  // width and height planned during the configuration, already rounded by fftRoundDimension
+  const std::vector<std::pair<int, int>>& getPreplannedSizes() const {
+    return m_preplanned_sizes;
+  }
+
+private:
+  unsigned m_planning_rigor;
+  std::string m_wisdom_path;
+  std::vector<std::pair<int, int>> m_preplanned_sizes;
+};
+
+}
+
+
+#endif /* _SEIMPLEMENTATION_CONFIGURATION_FFTCONFIG_H_ */
@@ -61,6 +61,10 @@ public:
     int m_image_hdu;
     int m_psf_hdu;
     int m_weight_hdu;
+
+    std::string m_weight_path;
+    double m_flux_scale;
+    double m_weight_scaling;
   };
 
   MeasurementImageConfig(long manager_id);
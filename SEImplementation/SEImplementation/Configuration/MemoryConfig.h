@@ -47,9 +47,39 @@ public:
     return m_tile_size;
   }
 
+  // number of tiles (or rows of tiles) to read ahead during segmentation
+  int getTileReadAhead() const {
+    return m_read_ahead;
+  }
+
+  // maximum memory allocated to the evicted ImageTiles kept compressed in megabytes
+  int getTileMaxCompressedMemory() const {
+    return m_max_compressed_memory;
+  }
+
+  // whether the tile buffers are advised to use transparent huge pages
+  bool getTileHugePages() const {
+    return m_huge_pages;
+  }
+
+  // maximum number of read-only handles kept open on the FITS files, for concurrent tile reads
+  int getFitsReadHandles() const {
+    return m_fits_read_handles;
+  }
+
+  // whether the background and segmentation passes bypass the tiles cache
+  bool getTileStreaming() const {
+    return m_streaming;
+  }
+
 private:
   int m_max_memory;
   int m_tile_size;
+  int m_read_ahead;
+  int m_max_compressed_memory;
+  bool m_huge_pages;
+  int m_fits_read_handles;
+  bool m_streaming;
 };
 
 
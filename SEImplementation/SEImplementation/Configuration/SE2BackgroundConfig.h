@@ -22,6 +22,8 @@
 #ifndef _SEIMPLEMENTATION_SE2BACKGROUNDCONFIG_H
 #define _SEIMPLEMENTATION_SE2BACKGROUNDCONFIG_H
 
+#include <cstdint>
+
 #include "Configuration/Configuration.h"
 #include "SEFramework/Image/Image.h"
 
@@ -51,10 +53,27 @@ public:
     return m_legacy;
   }
 
+  bool materialize() const {
+    return m_materialize;
+  }
+
+  /// Empty if the background models are not cached
+  const std::string& getCacheDirectory() const {
+    return m_cache_directory;
+  }
+
+  /// Bytes the background models may take in the cache directory, unlimited if 0
+  std::uintmax_t getCacheSize() const {
+    return m_cache_size;
+  }
+
 private:
   std::vector<int> m_cell_size;
   std::vector<int> m_smoothing_box;
   bool m_legacy;
+  bool m_materialize;
+  std::string m_cache_directory;
+  std::uintmax_t m_cache_size;
 
 };
 
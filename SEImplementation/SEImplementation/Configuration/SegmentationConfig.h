@@ -85,6 +85,7 @@ private:
 
   int m_lutz_window_size;
   int m_bfs_max_delta;
+  double m_separable_tolerance;
 }; /* End of SegmentationConfig class */
 
 } /* namespace SourceXtractor */
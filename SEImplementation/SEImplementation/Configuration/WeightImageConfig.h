@@ -51,6 +51,14 @@ public:
     return m_weight_image;
   }
 
+  const std::string& getWeightImagePath() const {
+    return m_weight_image_path;
+  }
+
+  WeightImage::PixelType getWeightScaling() const {
+    return m_weight_scaling;
+  }
+
   WeightType getWeightType() const {
     return m_weight_type;
   }
@@ -72,6 +80,7 @@ public:
 private:
 
   std::shared_ptr<WeightImage> m_weight_image;
+  std::string m_weight_image_path;
   WeightType m_weight_type;
   bool m_absolute_weight;
   WeightImage::PixelType m_weight_scaling;
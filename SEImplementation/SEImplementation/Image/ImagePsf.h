@@ -30,6 +30,7 @@
 #include "SEFramework/Image/VectorImage.h"
 #include "SEFramework/Image/ProcessedImage.h"
 #include "SEFramework/Convolution/Convolution.h"
+#include "SEFramework/Convolution/ConvolutionProfile.h"
 
 
 namespace SourceXtractor {
@@ -37,11 +38,12 @@ namespace SourceXtractor {
 class ImagePsf: public DFTConvolution<SeFloat, PaddedImage<SeFloat, Reflect101Coordinates>> {
 private:
   typedef DFTConvolution<SeFloat, PaddedImage<SeFloat, Reflect101Coordinates>> base_t;
+  typedef DirectConvolution<SeFloat, PaddedImage<SeFloat, Reflect101Coordinates>> direct_t;
 
 public:
 
   ImagePsf(double pixel_scale, std::shared_ptr<const VectorImage<SeFloat>> image)
-          : base_t{image}, m_pixel_scale{pixel_scale} {
+          : base_t{image}, m_pixel_scale{pixel_scale}, m_profile{ConvolutionProfile::getInstance()} {
     if (image->getWidth() != image->getHeight()) {
       throw Elements::Exception() << "PSF kernel must be square but was "
                                   << image->getWidth() << " x " << image->getHeight();
@@ -50,6 +52,10 @@ public:
       throw Elements::Exception() << "PSF kernel must have odd size, but got "
                                   << image->getWidth();
     }
+    // Only a calibrated profile can prefer the direct convolution. Same separable tolerance as the calibration
+    if (m_profile->isCalibrated()) {
+      m_direct = std::make_shared<direct_t>(image, 0);
+    }
   }
 
   virtual ~ImagePsf() = default;
@@ -66,8 +72,68 @@ public:
     return VectorImage<SeFloat>::create(*MultiplyImage<SourceXtractor::SeFloat>::create(getKernel(), scale));
   }
 
+  /**
+   * Prepares the DFT context, unless the calibrated ConvolutionProfile prefers the direct convolution
+   * for this size. In that case, the context is null.
+   * @param batch
+   *    Number of images of this size the context convolves at once. See convolveBatch
+   */
+  std::unique_ptr<ConvolutionContext> prepare(const std::shared_ptr<const Image<SeFloat>>& model_ptr,
+                                              int batch = 1) const {
+    if (useDirect(*model_ptr)) {
+      return nullptr;
+    }
+    return base_t::prepare(model_ptr->getWidth(), model_ptr->getHeight(), batch);
+  }
+
+  template <typename ...Args>
+  void convolve(std::shared_ptr<WriteableImage<SeFloat>> image_ptr,
+                std::unique_ptr<ConvolutionContext>& context, Args... padding_args) const {
+    if (!context) {
+      m_direct->convolve(image_ptr, padding_args...);
+      return;
+    }
+    base_t::convolve(image_ptr, context, padding_args...);
+  }
+
+  /**
+   * Convolve images of the same size with a context prepared for that many, so they are transformed
+   * by a single FFTW plan
+   */
+  template <typename ImageType>
+  void convolveBatch(const std::vector<ImageType>& images, std::unique_ptr<ConvolutionContext>& context) const {
+    std::vector<std::shared_ptr<WriteableImage<SeFloat>>> batch(images.begin(), images.end());
+    if (!context) {
+      for (auto& image : batch) {
+        m_direct->convolve(image);
+      }
+      return;
+    }
+    base_t::convolveBatch(batch, context);
+  }
+
+  template <typename ...Args>
+  void convolve(std::shared_ptr<WriteableImage<SeFloat>> image_ptr, Args... padding_args) const {
+    if (useDirect(*image_ptr)) {
+      m_direct->convolve(image_ptr, padding_args...);
+      return;
+    }
+    base_t::convolve(image_ptr, padding_args...);
+  }
+
 private:
   double m_pixel_scale;
+  // Taken at construction, so the convolutions do not lock the global instance
+  std::shared_ptr<const ConvolutionProfile> m_profile;
+  // Null unless the profile is calibrated
+  std::shared_ptr<const direct_t> m_direct;
+
+  // Without calibration, the PSF is always convolved by DFT
+  bool useDirect(const Image<SeFloat>& image) const {
+    return m_profile->isCalibrated() &&
+           m_profile->select(image.getWidth(), image.getHeight(), getWidth(), getHeight()) ==
+           ConvolutionProfile::Engine::DIRECT;
+  }
 
 };
 
@@ -82,6 +148,7 @@ template<>
 struct PsfTraits<SourceXtractor::ImagePsf> {
   using context_t = typename std::unique_ptr<SourceXtractor::ImagePsf::ConvolutionContext>;
   static constexpr bool has_context = true;
+  static constexpr bool has_batch = true;
 };
 
 } // end of ModelFitting
@@ -24,7 +24,9 @@
 #ifndef _SEIMPLEMENTATION_SEGMENTATION_BACKGROUNDCONVOLUTION_H_
 #define _SEIMPLEMENTATION_SEGMENTATION_BACKGROUNDCONVOLUTION_H_
 
+#include "AlexandriaKernel/ThreadPool.h"
 #include "SEUtils/Types.h"
+#include "SEFramework/Convolution/SeparableKernel.h"
 #include "SEFramework/Image/VectorImage.h"
 #include "SEFramework/Frame/Frame.h"
 
@@ -36,11 +38,28 @@ namespace SourceXtractor {
 class BackgroundConvolution : public DetectionImageFrame::ImageFilter {
 
 public:
-  BackgroundConvolution(std::shared_ptr<Image<SeFloat>> convolution_filter, bool must_normalize)
-    : m_convolution_filter(VectorImage<SeFloat>::create(*convolution_filter)) {
+  /**
+   * @param separable_tolerance
+   *    Relative error allowed when decomposing the filter into 1D passes. 0 always applies the full 2D filter
+   */
+  BackgroundConvolution(std::shared_ptr<Image<SeFloat>> convolution_filter, bool must_normalize,
+                        double separable_tolerance = 0)
+    : m_convolution_filter(VectorImage<SeFloat>::create(*convolution_filter)),
+      m_separable_tolerance(separable_tolerance) {
     if (must_normalize) {
       normalize();
     }
+    m_separable = SeparableKernel<SeFloat>::decompose(*m_convolution_filter, m_separable_tolerance);
+  }
+
+  /// The decomposition of the filter in 1D passes, nullptr if it is not separable within the tolerance
+  std::shared_ptr<const SeparableKernel<SeFloat>> getSeparableKernel() const {
+    return m_separable;
+  }
+
+  /// Thread pool used to convolve concurrently the tiles of large regions (i.e. the bands of a sweep)
+  void setThreadPool(std::shared_ptr<Euclid::ThreadPool> thread_pool) {
+    m_thread_pool = std::move(thread_pool);
   }
 
   std::shared_ptr<DetectionImage>
@@ -51,6 +70,9 @@ private:
   void normalize();
 
   std::shared_ptr<VectorImage<SeFloat>> m_convolution_filter;
+  double m_separable_tolerance;
+  std::shared_ptr<const SeparableKernel<SeFloat>> m_separable;
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
 };
 
 }
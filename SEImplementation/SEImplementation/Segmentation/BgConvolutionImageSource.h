@@ -25,6 +25,7 @@
 #ifndef _SEIMPLEMENTATION_SEGMENTATION_BGCONVOLUTIONIMAGESOURCE_H_
 #define _SEIMPLEMENTATION_SEGMENTATION_BGCONVOLUTIONIMAGESOURCE_H_
 
+#include "SEFramework/Convolution/SeparableKernel.h"
 #include "SEFramework/Image/MirrorImage.h"
 #include "SEFramework/Image/VectorImage.h"
 #include "SEFramework/Image/ProcessingImageSource.h"
@@ -34,12 +35,14 @@ namespace SourceXtractor {
 /**
  * Implement an image source using direct convolution of the filter over the image.
  * This approach is normally faster for small kernels
+ * If the kernel is separable within the tolerance, the masked image and the mask are convolved as 1D passes
  */
 class BgConvolutionImageSource : public ProcessingImageSource<DetectionImage::PixelType> {
 public:
   BgConvolutionImageSource(std::shared_ptr<Image<DetectionImage::PixelType>> image,
                            std::shared_ptr<DetectionImage> variance, SeFloat threshold,
-                           std::shared_ptr<VectorImage<SeFloat>> kernel);
+                           std::shared_ptr<VectorImage<SeFloat>> kernel,
+                           double separable_tolerance = 0);
 
 protected:
 
@@ -52,7 +55,12 @@ protected:
 private:
   std::shared_ptr<DetectionImage> m_variance;
   SeFloat m_threshold;
+  void generateSeparableTile(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
+                             ImageTileWithType<DetectionImage::PixelType>& tile,
+                             int start_x, int start_y, int width, int height) const;
+
   std::shared_ptr<VectorImage<SeFloat>> m_kernel;
+  std::shared_ptr<const SeparableKernel<SeFloat>> m_separable;
 };
 
 } // end namespace SourceXtractor
@@ -25,6 +25,10 @@
 #ifndef _SEIMPLEMENTATION_SEGMENTATION_BGDFTCONVOLUTIONIMAGESOURCE_H_
 #define _SEIMPLEMENTATION_SEGMENTATION_BGDFTCONVOLUTIONIMAGESOURCE_H_
 
+#include <map>
+#include <mutex>
+
+#include "AlexandriaKernel/ThreadPool.h"
 #include "SEFramework/Convolution/DFT.h"
 #include "SEFramework/Image/PaddedImage.h"
 #include "SEFramework/Image/VectorImage.h"
@@ -34,12 +38,21 @@ namespace SourceXtractor {
 /**
  * Implement an image source using direct convolution of the filter over the image.
  * This approach is normally faster for big kernels
+ *
+ * Each tile is convolved from the block of the image covering it plus the margins the kernel needs,
+ * which are discarded afterwards (overlap-save). The transform of the kernel is computed once per block size,
+ * and the contexts holding the work areas are kept for the next tiles of the same size.
+ * The masked image and the mask are transformed together, as a batch.
+ * Regions larger than a tile of the TileManager, read during a sweep, are split into tiles, and single tiles
+ * in halves along each axis if they are large enough. The blocks are convolved concurrently on the thread pool,
+ * if any.
  */
 class BgDFTConvolutionImageSource : public ProcessingImageSource<DetectionImage::PixelType> {
 public:
   BgDFTConvolutionImageSource(std::shared_ptr<Image<DetectionImage::PixelType>> image,
                               std::shared_ptr<DetectionImage> variance, SeFloat threshold,
-                              std::shared_ptr<VectorImage<SeFloat>> kernel);
+                              std::shared_ptr<VectorImage<SeFloat>> kernel,
+                              std::shared_ptr<Euclid::ThreadPool> thread_pool = nullptr);
 
 protected:
 
@@ -56,9 +69,33 @@ protected:
                     int start_x, int start_y, int width, int height) const override;
 
 private:
+  using ContextPtr = std::unique_ptr<ConvolutionType::ConvolutionContext>;
+
+  /// Size of the blocks a region is split into, along one axis
+  int getBlockSize(int size, int tile_size) const;
+
+  void convolveBlock(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
+                     ImageTileWithType<DetectionImage::PixelType>& tile,
+                     int start_x, int start_y, int width, int height) const;
+
+  /// Takes an idle context for blocks of the given size, or prepares a new one
+  ContextPtr acquireContext(int width, int height) const;
+
+  /// Gives back the context, for the next blocks of the same size
+  void releaseContext(int width, int height, ContextPtr context) const;
+
+  // Tiles are split in halves only if these are at least this size
+  static const int s_min_block_size = 64;
+
   std::shared_ptr<DetectionImage> m_variance;
   DetectionImage::PixelType m_threshold;
   ConvolutionType m_convolution;
+  std::shared_ptr<Euclid::ThreadPool> m_thread_pool;
+
+  mutable std::mutex m_contexts_mutex;
+  // The first context prepared for each size, from which the others share the kernel transform
+  mutable std::map<std::pair<int, int>, ContextPtr> m_reference_contexts;
+  mutable std::map<std::pair<int, int>, std::vector<ContextPtr>> m_idle_contexts;
 };
 
 } // end namespace SourceXtractor
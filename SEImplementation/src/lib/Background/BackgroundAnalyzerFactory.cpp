@@ -22,11 +22,15 @@
  */
 
 
+#include <sstream>
+
 #include "SEImplementation/Background/BackgroundAnalyzerFactory.h"
 
+#include "SEImplementation/Background/CachedBackgroundAnalyzer.h"
 #include "SEImplementation/Background/SimpleBackgroundAnalyzer.h"
 #include "SEImplementation/Background/SE/SEBackgroundLevelAnalyzer.h"
 #include "SEImplementation/Background/SE2/SE2BackgroundLevelAnalyzer.h"
+#include "SEImplementation/Configuration/MultiThreadingConfig.h"
 
 namespace SourceXtractor {
 
@@ -39,18 +43,42 @@ std::shared_ptr<BackgroundAnalyzer> BackgroundAnalyzerFactory::createBackgroundA
   // make a SE2 background if cell size and smoothing box are given
   if (m_cell_size.size() > 0 && m_smoothing_box.size() > 0) {
     if (m_legacy)
-      return std::make_shared<SE2BackgroundLevelAnalyzer>(m_cell_size, m_smoothing_box, weight_type);
+      return std::make_shared<SE2BackgroundLevelAnalyzer>(m_cell_size, m_smoothing_box, weight_type, m_thread_pool,
+                                                          m_materialize);
     else
-      return std::make_shared<SEBackgroundLevelAnalyzer>(m_cell_size, m_smoothing_box, weight_type);
+      return std::make_shared<SEBackgroundLevelAnalyzer>(m_cell_size, m_smoothing_box, weight_type, m_thread_pool,
+                                                         m_materialize);
   } else {
     // make a simple background
     return std::make_shared<SimpleBackgroundAnalyzer>();
   }
 }
 
-BackgroundAnalyzerFactory::BackgroundAnalyzerFactory(long manager_id) : Configuration(manager_id),  m_legacy(false) {
+std::shared_ptr<BackgroundAnalyzer> BackgroundAnalyzerFactory::createBackgroundAnalyzer(
+    WeightImageConfig::WeightType weight_type, const std::string& pixels_id) const {
+  auto analyzer = createBackgroundAnalyzer(weight_type);
+  if (m_cache_directory.empty() || pixels_id.empty() || m_cell_size.empty() || m_smoothing_box.empty()) {
+    return analyzer;
+  }
+
+  std::ostringstream key;
+  key << pixels_id << "; " << (m_legacy ? "SE2" : "SE") << " cell";
+  for (auto v : m_cell_size) {
+    key << ' ' << v;
+  }
+  key << " box";
+  for (auto v : m_smoothing_box) {
+    key << ' ' << v;
+  }
+  key << " weight type " << static_cast<int>(weight_type);
+  return std::make_shared<CachedBackgroundAnalyzer>(analyzer, m_cache_directory, key.str(), m_cache_size,
+                                                    m_thread_pool);
+}
+
+BackgroundAnalyzerFactory::BackgroundAnalyzerFactory(long manager_id) : Configuration(manager_id),  m_legacy(false), m_materialize(false), m_cache_size(0) {
   declareDependency<SE2BackgroundConfig>();
   declareDependency<WeightImageConfig>();
+  declareDependency<MultiThreadingConfig>();
 }
 
 void BackgroundAnalyzerFactory::initialize(const UserValues&) {
@@ -59,7 +87,11 @@ void BackgroundAnalyzerFactory::initialize(const UserValues&) {
   m_cell_size = se2background_config.getCellSize();
   m_smoothing_box = se2background_config.getSmoothingBox();
   m_legacy = se2background_config.useLegacy();
+  m_materialize = se2background_config.materialize();
+  m_cache_directory = se2background_config.getCacheDirectory();
+  m_cache_size = se2background_config.getCacheSize();
   m_weight_type = weight_image_config.getWeightType();
+  m_thread_pool = getDependency<MultiThreadingConfig>().getThreadPool();
 }
 
 }
@@ -0,0 +1,321 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * CachedBackgroundAnalyzer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <ctime>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+#include <fitsio.h>
+
+#include "ElementsKernel/Exception.h"
+#include "SEFramework/Image/BufferedImage.h"
+#include "SEFramework/FITS/FitsImageSource.h"
+#include "SEImplementation/Background/Utils.h"
+#include "SEImplementation/Background/CachedBackgroundAnalyzer.h"
+
+namespace SourceXtractor {
+
+// Rows written at once, for about 4 MB of single precision pixels
+static const int CACHE_BAND_PIXELS = 1 << 20;
+
+// Increase when the content of the cached models changes
+static const std::string CACHE_VERSION {"1"};
+
+CachedBackgroundAnalyzer::CachedBackgroundAnalyzer(std::shared_ptr<BackgroundAnalyzer> analyzer,
+                                                   const boost::filesystem::path& cache_directory,
+                                                   const std::string& key, std::uintmax_t max_cache_size,
+                                                   const std::shared_ptr<Euclid::ThreadPool>& thread_pool)
+  : m_analyzer(analyzer), m_cache_directory(cache_directory), m_key(key), m_max_cache_size(max_cache_size),
+    m_thread_pool(thread_pool) {
+}
+
+// Models read by this process, that must not be evicted as their files may be opened again
+static std::mutex s_used_mutex;
+static std::set<boost::filesystem::path> s_used_paths;
+
+static std::string getFileStamp(const std::string& path, int hdu) {
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_regular_file(path, ec)) {
+    return {};
+  }
+  auto canonical = boost::filesystem::canonical(path, ec);
+  if (ec) {
+    return {};
+  }
+  auto size = boost::filesystem::file_size(canonical, ec);
+  if (ec) {
+    return {};
+  }
+  auto mtime = boost::filesystem::last_write_time(canonical, ec);
+  if (ec) {
+    return {};
+  }
+
+  std::ostringstream stamp;
+  stamp << canonical.native() << '[' << hdu << "] " << size << ' ' << mtime;
+  return stamp.str();
+}
+
+std::string CachedBackgroundAnalyzer::identifyPixels(const std::string& image_path, int image_hdu, double flux_scale,
+                                                     const std::string& weight_path, int weight_hdu,
+                                                     double weight_scaling, bool weight_absolute) {
+  auto image_stamp = getFileStamp(image_path, image_hdu);
+  if (image_stamp.empty()) {
+    return {};
+  }
+
+  std::ostringstream pixels;
+  pixels << std::setprecision(17) << image_stamp << " x " << flux_scale;
+  if (!weight_path.empty()) {
+    auto weight_stamp = getFileStamp(weight_path, weight_hdu);
+    if (weight_stamp.empty()) {
+      return {};
+    }
+    pixels << "; weight " << weight_stamp << " x " << weight_scaling << (weight_absolute ? " absolute" : "");
+  }
+  return pixels.str();
+}
+
+BackgroundModel CachedBackgroundAnalyzer::analyzeBackground(
+    std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map,
+    std::shared_ptr<Image<unsigned char>> mask, WeightImage::PixelType variance_threshold) const {
+  std::ostringstream key;
+  key << "v" << CACHE_VERSION << "; " << m_key << "; " << image->getWidth() << 'x' << image->getHeight()
+      << "; threshold " << std::setprecision(9) << variance_threshold;
+
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(key.str()) << ".fits";
+  auto cache_path = m_cache_directory / name.str();
+
+  auto cached = readCache(cache_path, key.str(), image->getWidth(), image->getHeight());
+  if (cached) {
+    bck_model_logger.info() << "Background for image: " << image->getRepr() << " read from " << cache_path;
+    return *cached;
+  }
+
+  auto model = m_analyzer->analyzeBackground(image, variance_map, mask, variance_threshold);
+  try {
+    writeCache(cache_path, key.str(), model);
+  }
+  catch (const std::exception& e) {
+    bck_model_logger.warn() << "Could not cache the background of " << image->getRepr() << ": " << e.what();
+    return model;
+  }
+
+  // Read back from the file, rather than evaluating the model again
+  cached = readCache(cache_path, key.str(), image->getWidth(), image->getHeight());
+  return cached ? *cached : model;
+}
+
+std::unique_ptr<BackgroundModel> CachedBackgroundAnalyzer::readCache(const boost::filesystem::path& cache_path,
+                                                                     const std::string& key,
+                                                                     int width, int height) const {
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_regular_file(cache_path, ec)) {
+    return nullptr;
+  }
+
+  fitsfile* fptr = nullptr;
+  int status = 0;
+  char* stored_key = nullptr;
+  float scaling = 0, median_rms = 0;
+  int naxis = 0, bitpix = 0, hdu_type = 0;
+  long naxes[2] = {0, 0};
+  long variance_naxes[2] = {0, 0};
+
+  fits_open_file(&fptr, cache_path.native().c_str(), READONLY, &status);
+  fits_read_key_longstr(fptr, "BCKKEY", &stored_key, nullptr, &status);
+  fits_read_key(fptr, TFLOAT, "BCKSCALE", &scaling, nullptr, &status);
+  fits_read_key(fptr, TFLOAT, "BCKRMS", &median_rms, nullptr, &status);
+  fits_get_img_param(fptr, 2, &bitpix, &naxis, naxes, &status);
+  fits_movabs_hdu(fptr, 2, &hdu_type, &status);
+  fits_get_img_param(fptr, 2, &bitpix, &naxis, variance_naxes, &status);
+
+  // A hash collision, or a file left behind by an older version
+  bool match = (status == 0 && stored_key && key == stored_key &&
+                naxes[0] == width && naxes[1] == height &&
+                variance_naxes[0] == width && variance_naxes[1] == height);
+
+  if (stored_key) {
+    int free_status = 0;
+    fits_free_memory(stored_key, &free_status);
+  }
+  if (fptr) {
+    int close_status = 0;
+    fits_close_file(fptr, &close_status);
+  }
+  if (!match) {
+    return nullptr;
+  }
+
+  // The modification time tells the eviction when the model was last used
+  boost::filesystem::last_write_time(cache_path, std::time(nullptr), ec);
+  {
+    std::lock_guard<std::mutex> lock(s_used_mutex);
+    s_used_paths.insert(cache_path);
+  }
+
+  auto level = BufferedImage<SeFloat>::create(
+    std::make_shared<FitsImageSource>(cache_path.native(), 1, ImageTile::FloatImage));
+  auto variance = BufferedImage<SeFloat>::create(
+    std::make_shared<FitsImageSource>(cache_path.native(), 2, ImageTile::FloatImage));
+  return std::unique_ptr<BackgroundModel>(new BackgroundModel(level, variance, scaling, median_rms));
+}
+
+static void writeRows(fitsfile* fptr, const Image<SeFloat>& image,
+                      const std::shared_ptr<Euclid::ThreadPool>& thread_pool, int& status) {
+  if (status) {
+    return;
+  }
+  int width = image.getWidth();
+  int height = image.getHeight();
+  int band_height = std::max(1, std::min(height, CACHE_BAND_PIXELS / std::max(width, 1)));
+  int nbands = (height + band_height - 1) / band_height;
+  std::atomic<int> next_row(0);
+  std::mutex fits_mutex;
+
+  // The pixels are computed concurrently, then written one band at a time
+  runOnThreadPool(thread_pool, nbands, [&]() {
+    std::vector<SeFloat> pixels;
+    int y;
+    while ((y = next_row.fetch_add(band_height)) < height) {
+      int rows = std::min(band_height, height - y);
+      pixels.resize(static_cast<size_t>(width) * rows);
+      image.forEachRow(0, y, width, rows, [&pixels, width, y](int row_y, const SeFloat* row) {
+        std::copy(row, row + width, pixels.begin() + static_cast<size_t>(row_y - y) * width);
+      });
+
+      std::lock_guard<std::mutex> lock(fits_mutex);
+      long fpixel[2] = {1, y + 1};
+      fits_write_pix(fptr, TFLOAT, fpixel, pixels.size(), pixels.data(), &status);
+    }
+  });
+}
+
+void CachedBackgroundAnalyzer::writeCache(const boost::filesystem::path& cache_path, const std::string& key,
+                                          const BackgroundModel& model) const {
+  boost::filesystem::create_directories(m_cache_directory);
+
+  // Written under another name first, so other runs never see half a model
+  auto tmp_path = cache_path;
+  tmp_path += boost::filesystem::unique_path(".%%%%%%%%.tmp");
+
+  auto level = model.getLevelMap();
+  auto variance = model.getVarianceMap();
+  long naxes[2] = {level->getWidth(), level->getHeight()};
+  float scaling = model.getScalingFactor();
+  float median_rms = model.getMedianRms();
+
+  fitsfile* fptr = nullptr;
+  int status = 0;
+  fits_create_file(&fptr, tmp_path.native().c_str(), &status);
+  fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status);
+  fits_write_key_longwarn(fptr, &status);
+  fits_write_key_longstr(fptr, "BCKKEY", key.c_str(), "Background cache key", &status);
+  fits_write_key(fptr, TFLOAT, "BCKSCALE", &scaling, "Scaling factor of the weight map", &status);
+  fits_write_key(fptr, TFLOAT, "BCKRMS", &median_rms, "Median RMS of the background", &status);
+
+  int close_status = 0;
+  boost::system::error_code ec;
+  try {
+    writeRows(fptr, *level, m_thread_pool, status);
+    fits_create_img(fptr, FLOAT_IMG, 2, naxes, &status);
+    writeRows(fptr, *variance, m_thread_pool, status);
+  }
+  catch (...) {
+    fits_close_file(fptr, &close_status);
+    boost::filesystem::remove(tmp_path, ec);
+    throw;
+  }
+
+  if (fptr) {
+    fits_close_file(fptr, &close_status);
+  }
+  if (status || close_status) {
+    char err_txt[31];
+    fits_get_errstatus(status ? status : close_status, err_txt);
+    boost::filesystem::remove(tmp_path, ec);
+    throw Elements::Exception() << "Couldn't write " << tmp_path << " (" << err_txt << ")";
+  }
+
+  boost::filesystem::rename(tmp_path, cache_path);
+  if (m_max_cache_size > 0) {
+    evictCache(cache_path);
+  }
+}
+
+void CachedBackgroundAnalyzer::evictCache(const boost::filesystem::path& cache_path) const {
+  struct CachedFile {
+    boost::filesystem::path m_path;
+    std::time_t m_time;
+    std::uintmax_t m_size;
+  };
+
+  boost::system::error_code ec;
+  std::vector<CachedFile> files;
+  std::uintmax_t total_size = 0;
+  for (boost::filesystem::directory_iterator it(m_cache_directory, ec), end; !ec && it != end; it.increment(ec)) {
+    // Another run may remove files meanwhile
+    boost::system::error_code file_ec;
+    auto& path = it->path();
+    if (path.extension() != ".fits" || !boost::filesystem::is_regular_file(path, file_ec)) {
+      continue;
+    }
+    auto size = boost::filesystem::file_size(path, file_ec);
+    auto time = boost::filesystem::last_write_time(path, file_ec);
+    if (file_ec) {
+      continue;
+    }
+    total_size += size;
+    files.emplace_back(CachedFile{path, time, size});
+  }
+  if (total_size <= m_max_cache_size) {
+    return;
+  }
+
+  // Least recently used first
+  std::sort(files.begin(), files.end(), [](const CachedFile& a, const CachedFile& b) {
+    return a.m_time < b.m_time;
+  });
+
+  std::lock_guard<std::mutex> lock(s_used_mutex);
+  for (auto& file : files) {
+    if (total_size <= m_max_cache_size) {
+      break;
+    }
+    if (file.m_path == cache_path || s_used_paths.count(file.m_path)) {
+      continue;
+    }
+    if (boost::filesystem::remove(file.m_path, ec)) {
+      bck_model_logger.debug() << "Removed " << file.m_path << " from the background cache";
+      total_size -= file.m_size;
+    }
+  }
+}
+
+} // end of namespace SourceXtractor
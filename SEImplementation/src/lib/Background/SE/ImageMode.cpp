@@ -18,6 +18,8 @@
 #include <Histogram/Histogram.h> // From Alexandria
 
 #include "SEFramework/Image/ImageChunk.h"
+#include "SEFramework/Image/TileManager.h"
+#include "SEImplementation/Background/Utils.h"
 #include "SEImplementation/Background/SE/ImageMode.h"
 #include "SEImplementation/Background/SE/KappaSigmaBinning.h"
 
@@ -30,7 +32,8 @@ template<typename T>
 ImageMode<T>::ImageMode(const std::shared_ptr<Image<T>>& image, const std::shared_ptr<Image<T>>& variance,
                         int cell_w, int cell_h,
                         T invalid_value, T kappa1, T kappa2, T kappa3,
-                        T rtol, size_t max_iter): m_image(image),
+                        T rtol, size_t max_iter,
+                        const std::shared_ptr<Euclid::ThreadPool>& thread_pool): m_image(image),
                                                             m_cell_w(cell_w), m_cell_h(cell_h),
                                                             m_invalid(invalid_value),
                                                             m_kappa1(kappa1), m_kappa2(kappa2), m_kappa3(kappa3),
@@ -48,21 +51,14 @@ ImageMode<T>::ImageMode(const std::shared_ptr<Image<T>>& image, const std::share
   if (variance) {
     m_var_mode = VectorImage<T>::create(hist_width.quot, hist_height.quot);
     m_var_sigma = VectorImage<T>::create(hist_width.quot, hist_height.quot);
-
-    for (int y = 0; y < m_mode->getHeight(); ++y) {
-      for (int x = 0; x < m_mode->getWidth(); ++x) {
-        processCell(*image, x, y, *m_mode, *m_sigma);
-        processCell(*variance, x, y, *m_var_mode, *m_var_sigma);
-      }
-    }
-  }
-  else {
-    for (int y = 0; y < m_mode->getHeight(); ++y) {
-      for (int x = 0; x < m_mode->getWidth(); ++x) {
-        processCell(*image, x, y, *m_mode, *m_sigma);
-      }
-    }
   }
+
+  // Each cell is written only by the thread processing its row, so the output does not depend
+  // on the scheduling
+  std::atomic<int> next_row(0);
+  runOnThreadPool(thread_pool, m_mode->getHeight(), [this, &image, &variance, &next_row]() {
+    processRows(*image, variance.get(), next_row);
+  });
 }
 
 template<typename T>
@@ -87,6 +83,7 @@ std::shared_ptr<VectorImage<T>> ImageMode<T>::getVarianceSigmaImage() const {
 
 template<typename T>
 std::tuple<T, T> ImageMode<T>::getBackGuess(const std::vector<T>& data) const {
+  // Built for each cell: the binning derives its edges from the cell statistics, and a Histogram can not be refilled
   Histogram<double, int64_t> histo(data.begin(), data.end(), KappaSigmaBinning<double>(m_kappa1, m_kappa2));
 
   auto ref_bin = histo.getBinEdges(0);
@@ -121,18 +118,46 @@ std::tuple<T, T> ImageMode<T>::getBackGuess(const std::vector<T>& data) const {
 }
 
 template<typename T>
-void ImageMode<T>::processCell(const Image<T>& img, int x, int y,
-                               VectorImage<T>& out_mode, VectorImage<T>& out_sigma) const {
+void ImageMode<T>::processRows(const Image<T>& image, const Image<T>* variance, std::atomic<int>& next_row) const {
+  // The buffer of pixel values is reused for all the cells processed by this thread
+  std::vector<T> buffer;
+  buffer.reserve(m_cell_w * m_cell_h);
+
+  // Each row of cells is read as one band spanning the whole width, so the image is visited once, top to bottom.
+  // With the streaming enabled, the bands are not kept in the tile cache
+  TileManager::Sweep sweep;
+
+  for (int y = next_row++; y < m_mode->getHeight(); y = next_row++) {
+    int off_y = y * m_cell_h;
+    int h = std::min(m_cell_h, image.getHeight() - off_y);
+
+    auto band = image.getChunk(0, off_y, image.getWidth(), h);
+    for (int x = 0; x < m_mode->getWidth(); ++x) {
+      processCell(*band, x, y, *m_mode, *m_sigma, buffer);
+    }
+    band.reset();
+
+    if (variance) {
+      auto var_band = variance->getChunk(0, off_y, variance->getWidth(), h);
+      for (int x = 0; x < m_mode->getWidth(); ++x) {
+        processCell(*var_band, x, y, *m_var_mode, *m_var_sigma, buffer);
+      }
+    }
+  }
+}
+
+template<typename T>
+void ImageMode<T>::processCell(const ImageChunk<T>& band, int x, int y,
+                               VectorImage<T>& out_mode, VectorImage<T>& out_sigma,
+                               std::vector<T>& filtered) const {
   int off_x = x * m_cell_w;
-  int off_y = y * m_cell_h;
-  int w = std::min(m_cell_w, img.getWidth() - off_x);
-  int h = std::min(m_cell_h, img.getHeight() - off_y);
+  int w = std::min(m_cell_w, band.getWidth() - off_x);
+  int h = band.getHeight();
 
-  auto img_chunk_ptr = img.getChunk(off_x, off_y, w, h);
+  auto img_chunk_ptr = band.getChunk(off_x, 0, w, h);
   auto& img_chunk = *img_chunk_ptr;
 
-  std::vector<T> filtered;
-  filtered.reserve(w * h);
+  filtered.clear();
 
   for (int y = 0; y < h; ++y) {
     for (int x = 0; x < w; ++x) {
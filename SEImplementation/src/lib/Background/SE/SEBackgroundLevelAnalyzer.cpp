@@ -31,8 +31,10 @@ namespace SourceXtractor {
 
 SEBackgroundLevelAnalyzer::SEBackgroundLevelAnalyzer(const std::vector<int>& cell_size,
                                                      const std::vector<int>& smoothing_box,
-                                                     const WeightImageConfig::WeightType weight_type)
-  : m_weight_type(weight_type) {
+                                                     const WeightImageConfig::WeightType weight_type,
+                                                     const std::shared_ptr<Euclid::ThreadPool>& thread_pool,
+                                                     bool materialize)
+  : m_weight_type(weight_type), m_thread_pool(thread_pool), m_materialize(materialize) {
   assert(cell_size.size() > 0 && cell_size.size() < 3);
   assert(smoothing_box.size() > 0 && smoothing_box.size() < 3);
   m_cell_size[0] = cell_size.front();
@@ -59,21 +61,12 @@ static float computeScaling(const std::shared_ptr<VectorImage<DetectionImage::Pi
     }
   }
 
-  std::sort(ratios.begin(), ratios.end());
-  if (ratios.size() % 2 == 1) {
-    return ratios[ratios.size() / 2];
-  }
-  return (ratios[ratios.size() / 2] + ratios[ratios.size() / 2 - 1]) / 2;
+  return selectMedian(ratios);
 }
 
 static float getMedian(const VectorImage<DetectionImage::PixelType>& img) {
   auto v = img.getData();
-  std::sort(v.begin(), v.end());
-  auto nitems = v.size();
-  if (nitems % 2 == 1) {
-    return v[nitems / 2];
-  }
-  return (v[nitems / 2] + v[nitems / 2 - 1]) / 2;
+  return selectMedian(v);
 }
 
 BackgroundModel SEBackgroundLevelAnalyzer::analyzeBackground(
@@ -114,7 +107,8 @@ BackgroundModel SEBackgroundLevelAnalyzer::analyzeBackground(
   }
 
   // Create histogram model for the image
-  ImageMode<DetectionImage::PixelType> histo(image, variance_map, m_cell_size[0], m_cell_size[1], mask_value, 2, 5, 3);
+  ImageMode<DetectionImage::PixelType> histo(image, variance_map, m_cell_size[0], m_cell_size[1], mask_value, 2, 5, 3,
+                                             1e-4, 100, m_thread_pool);
   auto mode = histo.getModeImage();
   auto var = histo.getSigmaImage();
 
@@ -124,7 +118,7 @@ BackgroundModel SEBackgroundLevelAnalyzer::analyzeBackground(
   var = ReplaceUndef<WeightImage::PixelType>(*var, mask_value);
 
   // Smooth with the smooth_box (median filtering)
-  std::tie(mode, var) = MedianFilter<DetectionImage::PixelType>(m_smoothing_box)(*mode, *var);
+  std::tie(mode, var) = MedianFilter<DetectionImage::PixelType>(m_smoothing_box, m_thread_pool)(*mode, *var);
   auto median = getMedian(*mode);
   auto median_sigma = getMedian(*var);
 
@@ -139,17 +133,20 @@ BackgroundModel SEBackgroundLevelAnalyzer::analyzeBackground(
     // Interpolate missing values
     weight = ReplaceUndef<DetectionImage::PixelType>(*weight, mask_value);
     // Smooth with the smooth_box (median filtering)
-    std::tie(weight, weight_var) = MedianFilter<WeightImage::PixelType>(m_smoothing_box)(*weight, *weight_var);
+    std::tie(weight, weight_var) = MedianFilter<WeightImage::PixelType>(m_smoothing_box, m_thread_pool)(
+      *weight, *weight_var);
     // Compute scaling
     scaling = computeScaling(var, weight);
     // Transform RMS to variance
     final_var = MultiplyImage<DetectionImage::PixelType>::create(var, var);
-    final_var = BufferedImage<DetectionImage::PixelType>::create(
-      std::make_shared<ScaledImageSource<DetectionImage::PixelType>>(
-        final_var, image->getWidth(), image->getHeight(),
-        ScaledImageSource<DetectionImage::PixelType>::InterpolationType::BICUBIC
-      )
+    std::shared_ptr<ImageSource> var_source = std::make_shared<ScaledImageSource<DetectionImage::PixelType>>(
+      final_var, image->getWidth(), image->getHeight(),
+      ScaledImageSource<DetectionImage::PixelType>::InterpolationType::BICUBIC
     );
+    if (m_materialize) {
+      var_source = materializeImageSource(var_source, m_thread_pool);
+    }
+    final_var = BufferedImage<DetectionImage::PixelType>::create(var_source);
   }
   else {
     final_var = ConstantImage<DetectionImage::PixelType>::create(image->getWidth(), image->getHeight(),
@@ -159,12 +156,14 @@ BackgroundModel SEBackgroundLevelAnalyzer::analyzeBackground(
   bck_model_logger.info() << "Background for image: " << image->getRepr() << " median: " << median
                           << " rms: " << median_sigma << "!";
 
-  final_bg = BufferedImage<DetectionImage::PixelType>::create(
-    std::make_shared<ScaledImageSource<DetectionImage::PixelType>>(
-      mode, image->getWidth(), image->getHeight(),
-      ScaledImageSource<DetectionImage::PixelType>::InterpolationType::BICUBIC
-    )
+  std::shared_ptr<ImageSource> bg_source = std::make_shared<ScaledImageSource<DetectionImage::PixelType>>(
+    mode, image->getWidth(), image->getHeight(),
+    ScaledImageSource<DetectionImage::PixelType>::InterpolationType::BICUBIC
   );
+  if (m_materialize) {
+    bg_source = materializeImageSource(bg_source, m_thread_pool);
+  }
+  final_bg = BufferedImage<DetectionImage::PixelType>::create(bg_source);
 
   return BackgroundModel(final_bg, final_var, scaling, median_sigma);
 }
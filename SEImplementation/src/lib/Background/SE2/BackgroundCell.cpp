@@ -63,8 +63,6 @@ BackgroundCell::~BackgroundCell()
 
 void BackgroundCell::getBackgroundValues(PIXTYPE& meanVal, PIXTYPE& sigmaVal)
 {
-  PIXTYPE pixVal=0.0;
-
   meanVal  = itsHisto->itsMean;
   sigmaVal = itsHisto->itsSigma;
 
@@ -73,15 +71,8 @@ void BackgroundCell::getBackgroundValues(PIXTYPE& meanVal, PIXTYPE& sigmaVal)
     return;
   }
 
-  // go over the data
-  for (size_t index=0; index<itsNdata; index++) {
-
-    // take the current value
-    pixVal = itsCellData[index];
-
-    // add to the histogram
-    itsHisto->addDatum(pixVal);
-  }
+  // add the data to the histogram
+  itsHisto->addData(itsCellData, itsNdata);
 
   // determine the mean value and sigma
   itsHisto->getBackGuess(meanVal, sigmaVal);
@@ -91,9 +82,6 @@ void BackgroundCell::getBackgroundValues(PIXTYPE& meanVal, PIXTYPE& sigmaVal)
 
 void BackgroundCell::getBackgroundValues(PIXTYPE& meanVal, PIXTYPE& sigmaVal, PIXTYPE& whtMeanVal, PIXTYPE& whtSigmaVal)
 {
-  PIXTYPE pixVal=0.0;
-  PIXTYPE whtVal=0.0;
-
   // transfer all mean ans sigma values
   meanVal  = itsHisto->itsMean;
   sigmaVal = itsHisto->itsSigma;
@@ -108,30 +96,13 @@ void BackgroundCell::getBackgroundValues(PIXTYPE& meanVal, PIXTYPE& sigmaVal, PI
   }
 
   if (itsHasWeight){
-
-    // go over the data
-    for (size_t index=0; index<itsNdata; index++) {
-
-      // take the current values
-      pixVal = itsCellData[index];
-      whtVal = itsCellWeight[index];
-      if (whtVal<itsWeightThresh){
-        // add to the histograms
-        itsHisto->addDatum(pixVal);
-        itsWeightHisto->addDatum(whtVal);
-     }
-    }
+    // add the data with a weight below the threshold to the histograms
+    itsHisto->addData(itsCellData, itsNdata, itsCellWeight, itsWeightThresh);
+    itsWeightHisto->addData(itsCellWeight, itsNdata, itsCellWeight, itsWeightThresh);
   }
   else {
-    // go over the data
-    for (size_t index=0; index<itsNdata; index++) {
-
-      // take the current value
-      pixVal = itsCellData[index];
-
-      // add to the histogram
-      itsHisto->addDatum(pixVal);
-    }
+    // add the data to the histogram
+    itsHisto->addData(itsCellData, itsNdata);
   }
 
   // determine the mean value and sigma
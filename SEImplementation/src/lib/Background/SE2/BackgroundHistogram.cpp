@@ -22,6 +22,7 @@
  * Revision: $Revision$
  * Author:   $Author$
  */
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include "SEImplementation/Background/SE2/BackgroundDefine.h"
@@ -105,6 +106,39 @@ void BackgroundHistogram::addDatum(const PIXTYPE& pixVal)
   return;
 }
 
+void BackgroundHistogram::addData(const PIXTYPE* pixVals, const size_t ndata, const PIXTYPE* weights, const PIXTYPE weightThresh)
+{
+  // the bin indices of a block of values are computed first, in a loop
+  // the compiler can vectorize, and only then are the bins enhanced
+  static const size_t blockSize=256;
+  int histIndex[blockSize];
+  const PIXTYPE qscale = (PIXTYPE)itsQscale;
+  const PIXTYPE cste   = (PIXTYPE)itsCste;
+
+  for (size_t start=0; start<ndata; start+=blockSize)
+  {
+    size_t nblock = std::min(blockSize, ndata-start);
+    const PIXTYPE* block = pixVals+start;
+
+    for (size_t index=0; index<nblock; index++)
+      histIndex[index] = (int)(block[index]/qscale + cste);
+
+    if (weights)
+    {
+      const PIXTYPE* blockWeights = weights+start;
+      for (size_t index=0; index<nblock; index++)
+        if (!(blockWeights[index]<weightThresh))
+          histIndex[index] = -1;
+    }
+
+    for (size_t index=0; index<nblock; index++)
+      if (histIndex[index]>=0 && histIndex[index]<(int)itsNLevels)
+        itsHisto[histIndex[index]]++;
+  }
+
+  return;
+}
+
 void BackgroundHistogram::getBackGuessMod(PIXTYPE& bckVal, PIXTYPE& sigmaVal)
 {
   int   *histo, *hilow, *hihigh, *histot;
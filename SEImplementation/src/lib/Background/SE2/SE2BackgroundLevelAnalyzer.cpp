@@ -43,8 +43,10 @@ namespace SourceXtractor {
 
 SE2BackgroundLevelAnalyzer::SE2BackgroundLevelAnalyzer(const std::vector<int>& cell_size,
                                                        const std::vector<int>& smoothing_box,
-                                                       const WeightImageConfig::WeightType weight_type)
-  : m_weight_type(weight_type)
+                                                       const WeightImageConfig::WeightType weight_type,
+                                                       const std::shared_ptr<Euclid::ThreadPool>& thread_pool,
+                                                       bool materialize)
+  : m_weight_type(weight_type), m_thread_pool(thread_pool), m_materialize(materialize)
 {
   assert(cell_size.size() > 0 && cell_size.size() <= 2);
   assert(smoothing_box.size() > 0 && smoothing_box.size() <= 2);
@@ -95,7 +97,7 @@ BackgroundModel SE2BackgroundLevelAnalyzer::analyzeBackground(
 }
 
 BackgroundModel SE2BackgroundLevelAnalyzer::fromSE2Modeller(std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map, std::shared_ptr<Image<unsigned char>> mask, WeightImage::PixelType variance_threshold, SeFloat &bck_median, SeFloat &var_median) const {
-  std::shared_ptr<SE2BackgroundModeller> bck_modeller(new SE2BackgroundModeller(image, variance_map, mask, 0x0001));
+  std::shared_ptr<SE2BackgroundModeller> bck_modeller(new SE2BackgroundModeller(image, variance_map, mask, 0x0001, m_thread_pool));
   std::shared_ptr<TypedSplineModelWrapper<SeFloat>> splModelBckPtr;
   std::shared_ptr<TypedSplineModelWrapper<SeFloat>> splModelVarPtr;
 
@@ -117,20 +119,28 @@ BackgroundModel SE2BackgroundLevelAnalyzer::fromSE2Modeller(std::shared_ptr<Dete
   bck_model_logger.debug() << "\tMedian variance value: " << medianVariance;
   bck_model_logger.debug() << "\tScaling value: "<< sigFac;
 
+  std::shared_ptr<ImageSource> bck_source = splModelBckPtr, var_source = splModelVarPtr;
+  if (m_materialize) {
+    bck_source = materializeImageSource(bck_source, m_thread_pool);
+  }
+
   // check for the weight type
   if (m_weight_type == WeightImageConfig::WeightType::WEIGHT_TYPE_NONE) {
     bck_model_logger.debug() << "\tConstant variance image at value: "<< splModelVarPtr->getMedian();
     // create a background model using the splines and the variance with a constant image from the median value
-    return BackgroundModel(BufferedImage<SeFloat>::create(splModelBckPtr),
+    return BackgroundModel(BufferedImage<SeFloat>::create(bck_source),
                            ConstantImage<SeFloat>::create(image->getWidth(), image->getHeight(), splModelVarPtr->getMedian()),
                            99999, std::sqrt(medianVariance));
   }
   else {
     bck_model_logger.debug() << "\tVariable background and variance.";
+    if (m_materialize) {
+      var_source = materializeImageSource(var_source, m_thread_pool);
+    }
     // return the variable background model
     return BackgroundModel(
-        BufferedImage<SeFloat>::create(splModelBckPtr),
-        BufferedImage<SeFloat>::create(splModelVarPtr),
+        BufferedImage<SeFloat>::create(bck_source),
+        BufferedImage<SeFloat>::create(var_source),
         sigFac, std::sqrt(medianVariance)
     );
   }
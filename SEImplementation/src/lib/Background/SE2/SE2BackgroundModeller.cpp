@@ -21,13 +21,15 @@
  * Revision: $Revision$
  * Author:   $Author$
  */
+#include <atomic>
 #include <iostream>
 #include  <cstdlib>
+#include <vector>
 
 #include "fitsio.h"
 
 #include "ElementsKernel/Exception.h"
-#include "SEFramework/Image/ImageAccessor.h"
+#include "SEFramework/Image/ImageChunk.h"
 #include "SEImplementation/Background/Utils.h"
 #include "SEImplementation/Background/SE2/BackgroundDefine.h"
 #include "SEImplementation/Background/SE2/SE2BackgroundUtils.h"
@@ -39,12 +41,25 @@ using namespace std;
 
 namespace SourceXtractor {
 
-SE2BackgroundModeller::SE2BackgroundModeller(std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map, std::shared_ptr<Image<unsigned char>> mask, const unsigned char mask_type_flag)
+// Reads the pixels of a cell sub-image in a single chunk, sampled with the given increments
+template <typename T>
+static void readCellData(const Image<T>& image, const long* fpixel, const long* lpixel, const long* increment, PIXTYPE* cellData)
+{
+  auto chunk = image.getChunk(int(fpixel[0]), int(fpixel[1]), int(lpixel[0]-fpixel[0]), int(lpixel[1]-fpixel[1]));
+  for (long y=0; y<lpixel[1]-fpixel[1]; y+=increment[1]){
+    const T* row = chunk->getRowSpan(int(y));
+    for (long x=0; x<lpixel[0]-fpixel[0]; x+=increment[0])
+      *cellData++ = (PIXTYPE)row[x];
+  }
+}
+
+SE2BackgroundModeller::SE2BackgroundModeller(std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage> variance_map, std::shared_ptr<Image<unsigned char>> mask, const unsigned char mask_type_flag, const std::shared_ptr<Euclid::ThreadPool>& thread_pool)
 {
   itsImage          = image;
   itsVariance       = variance_map;
   itsMask           = mask;
   itsMaskType       = mask_type_flag;
+  itsThreadPool     = thread_pool;
   //itsWeightTypeFlag = weight_type_flag;
 
   //check for variance
@@ -71,36 +86,15 @@ SE2BackgroundModeller::~SE2BackgroundModeller() {
 
 void SE2BackgroundModeller::createSE2Models(std::shared_ptr<TypedSplineModelWrapper<SeFloat>> &bckPtr, std::shared_ptr<TypedSplineModelWrapper<SeFloat>> &varPtr, PIXTYPE &sigFac, const size_t *bckCellSize, const WeightImage::PixelType varianceThreshold, const size_t *filterBoxSize, const float &filterThreshold)
 {
-  using DetectionAccessor = ImageAccessor<DetectionImage::PixelType>;
-  using MaskAccessor = ImageAccessor<unsigned char>;
-
-  DetectionAccessor detectionAccessor(itsImage);
-  MaskAccessor maskAccessor(itsMask);
-
   size_t gridSize[2] = {0,0};
   size_t nGridPoints=0;
 
-  long increment[2]={1,1};
-  long fpixel[2];
-  long lpixel[2];
-
-  size_t nElements=0;
-  size_t nData=0;
-  size_t subImgNaxes[2] = {0,0};
-
-  PIXTYPE* gridData=NULL;
-  PIXTYPE* weightData=NULL;
-
   //PIXTYPE  undefNumber=-BIG;
 
-  BackgroundCell* oneCell=NULL;
-
   PIXTYPE* bckMeanVals=NULL;
   PIXTYPE* bckSigVals=NULL;
   PIXTYPE* whtSigVals=NULL;
 
-  size_t gridIndex=0;
-
   ldiv_t divResult;
 
   PIXTYPE weightVarThreshold=(PIXTYPE)varianceThreshold;
@@ -139,82 +133,80 @@ void SE2BackgroundModeller::createSE2Models(std::shared_ptr<TypedSplineModelWrap
   bck_model_logger.debug() << "\tFilter box size=("<<filterBoxSize[0]<<"," << filterBoxSize[1]<< ")";
   bck_model_logger.debug() << "\tThe bad pixel threshold is: "<< weightVarThreshold;
 
-  // iterate over cells in y
-  gridIndex=0;
-  for (size_t yIndex=0; yIndex<gridSize[1]; yIndex++){
-
-    // set the boundaries in y
-    fpixel[1] = (long)yIndex*bckCellSize[1];
-    lpixel[1] = yIndex < gridSize[1]-1 ? (long)(yIndex+1)*bckCellSize[1] : (long)itsNaxes[1];
-
-    // iterate over cells in x
-    for (size_t xIndex=0; xIndex<gridSize[0]; xIndex++){
-
-      // set the boundaries in x
-      fpixel[0] = (long)xIndex*bckCellSize[0];
-      lpixel[0] = xIndex < gridSize[0]-1 ? (long)(xIndex+1)*bckCellSize[0] : (long)itsNaxes[0];
-
-      // compute the length of the cell sub-image
-      subImgNaxes[0] =(size_t)(lpixel[0]-fpixel[0]);
-      subImgNaxes[1] =(size_t)(lpixel[1]-fpixel[1]);
-
-      // some feedback on the corners of the image to be treated
-      bck_model_logger.debug() << "Background cell from fpixel=(" << fpixel[0] << "," << fpixel[1] << ") to lpixel=("<< lpixel[0] << "," << lpixel[1] << ")";
-
-      // compute the increments to perhaps limit the number
-      // of pixels read in, the total number of elements
-      // and the numbers read in x and y
-      getMinIncr(nElements, increment, subImgNaxes);
-
-      // define or re-define the buffers
-      if (nElements!=nData) {
-        delete [] gridData;
-        gridData = new PIXTYPE[nElements];
-        //if (itsInputWeight){
+  // the rows of cells are handed out to the workers through this counter;
+  // each cell writes only its own grid values, so the result does not
+  // depend on the number of threads
+  std::atomic<size_t> nextRow(0);
+  runOnThreadPool(itsThreadPool, int(gridSize[1]), [&](){
+    long increment[2]={1,1};
+    long fpixel[2];
+    long lpixel[2];
+    size_t nElements=0;
+    size_t subImgNaxes[2] = {0,0};
+
+    // the buffers for the cell data belong to each worker
+    std::vector<PIXTYPE> gridData;
+    std::vector<PIXTYPE> weightData;
+
+    // iterate over cells in y
+    for (size_t yIndex=nextRow++; yIndex<gridSize[1]; yIndex=nextRow++){
+
+      // set the boundaries in y
+      fpixel[1] = (long)yIndex*bckCellSize[1];
+      lpixel[1] = yIndex < gridSize[1]-1 ? (long)(yIndex+1)*bckCellSize[1] : (long)itsNaxes[1];
+
+      // iterate over cells in x
+      for (size_t xIndex=0; xIndex<gridSize[0]; xIndex++){
+
+        // set the boundaries in x
+        fpixel[0] = (long)xIndex*bckCellSize[0];
+        lpixel[0] = xIndex < gridSize[0]-1 ? (long)(xIndex+1)*bckCellSize[0] : (long)itsNaxes[0];
+
+        // compute the length of the cell sub-image
+        subImgNaxes[0] =(size_t)(lpixel[0]-fpixel[0]);
+        subImgNaxes[1] =(size_t)(lpixel[1]-fpixel[1]);
+
+        // some feedback on the corners of the image to be treated
+        bck_model_logger.debug() << "Background cell from fpixel=(" << fpixel[0] << "," << fpixel[1] << ") to lpixel=("<< lpixel[0] << "," << lpixel[1] << ")";
+
+        // compute the increments to perhaps limit the number
+        // of pixels read in, the total number of elements
+        // and the numbers read in x and y
+        getMinIncr(nElements, increment, subImgNaxes);
+
+        // load in the image data, each image with a single chunk
+        gridData.resize(nElements);
+        readCellData(*itsImage, fpixel, lpixel, increment, gridData.data());
         if (itsHasVariance){
-          delete [] weightData;
-          weightData = new PIXTYPE[nElements];
+          weightData.resize(nElements);
+          readCellData(*itsImage, fpixel, lpixel, increment, weightData.data());
         }
-        nData=nElements;
-      }
-
-      // load in the image data
-      long pixIndex=0;
-      for (auto yIndex=fpixel[1]; yIndex<lpixel[1]; yIndex+=increment[1])
-        for (auto xIndex=fpixel[0]; xIndex<lpixel[0]; xIndex+=increment[0]){
-        	gridData[pixIndex++] = (PIXTYPE)detectionAccessor.getValue(int(xIndex), int(yIndex));
-        }
-      if (itsHasVariance){
-        long pixIndex=0;
-        for (auto yIndex=fpixel[1]; yIndex<lpixel[1]; yIndex+=increment[1])
-          for (auto xIndex=fpixel[0]; xIndex<lpixel[0]; xIndex+=increment[0])
-            weightData[pixIndex++] = (PIXTYPE)detectionAccessor.getValue(int(xIndex), int(yIndex));
-      }
-      if (itsHasMask){
-        // load in the image data
-        long pixIndex=0;
-        for (auto yIndex=fpixel[1]; yIndex<lpixel[1]; yIndex+=increment[1])
-          for (auto xIndex=fpixel[0]; xIndex<lpixel[0]; xIndex+=increment[0], pixIndex++)
-            //if (!itsMask->getValue(int(xIndex), int(yIndex)))
-              if (maskAccessor.getValue(int(xIndex), int(yIndex)) & itsMaskType){
+        if (itsHasMask){
+          auto maskChunk = itsMask->getChunk(int(fpixel[0]), int(fpixel[1]), int(subImgNaxes[0]), int(subImgNaxes[1]));
+          long pixIndex=0;
+          size_t nMasked=0;
+          for (long y=0; y<(long)subImgNaxes[1]; y+=increment[1]){
+            const unsigned char* maskRow = maskChunk->getRowSpan(int(y));
+            for (long x=0; x<(long)subImgNaxes[0]; x+=increment[0], pixIndex++)
+              if (maskRow[x] & itsMaskType){
                 gridData[pixIndex] = -BIG;
-                bck_model_logger.debug() << "\tReplacing data value";
+                nMasked++;
               }
-      }
-
-      // create a background cell compute and store the values
-      // and then delete the cell again
-      oneCell = new BackgroundCell(gridData, nElements, weightData, weightVarThreshold);
-      if (itsHasVariance)
-        oneCell->getBackgroundValues(bckMeanVals[gridIndex], bckSigVals[gridIndex], itsWhtMeanVals[gridIndex], whtSigVals[gridIndex]);
-      else
-        oneCell->getBackgroundValues(bckMeanVals[gridIndex], bckSigVals[gridIndex]);
-      delete oneCell;
+          }
+          if (nMasked)
+            bck_model_logger.debug() << "\tReplaced " << nMasked << " masked data values";
+        }
 
-      // enhance the grid index
-      gridIndex++;
+        // create a background cell, compute and store the values
+        size_t gridIndex = yIndex*gridSize[0] + xIndex;
+        BackgroundCell oneCell(gridData.data(), nElements, itsHasVariance ? weightData.data() : NULL, weightVarThreshold);
+        if (itsHasVariance)
+          oneCell.getBackgroundValues(bckMeanVals[gridIndex], bckSigVals[gridIndex], itsWhtMeanVals[gridIndex], whtSigVals[gridIndex]);
+        else
+          oneCell.getBackgroundValues(bckMeanVals[gridIndex], bckSigVals[gridIndex]);
+      }
     }
-  }
+  });
 
   // do some filtering on the data
   filter(bckMeanVals, bckSigVals, gridSize, filterBoxSize, filterThreshold);
@@ -241,8 +233,6 @@ void SE2BackgroundModeller::createSE2Models(std::shared_ptr<TypedSplineModelWrap
 
    // release memory
   delete [] whtSigVals;
-  delete [] gridData;
-  delete [] weightData;
 }
 
 void SE2BackgroundModeller::getMinIncr(size_t &nElements, long* incr, const size_t * subImgNaxes)
@@ -24,6 +24,8 @@
  */
 
 #include <math.h>
+#include <algorithm>
+#include <vector>
 #include <boost/filesystem.hpp>             // for boost path type
 #include "fitsio.h"
 #include "ElementsKernel/Exception.h"       // for Elements Exception
@@ -52,6 +54,7 @@ SplineModel::SplineModel (const size_t* naxes, const size_t* gridCellSize, const
   itsDerivData = makeSplineDeriv(itsNGrid, gridData);
 
   itsBackLine = new PIXTYPE[itsNaxes[0]];
+  makeLineCoefficients();
 
   itsMedianValue = computeMedian(itsGridData, itsNGridPoints);
 }
@@ -59,6 +62,9 @@ SplineModel::SplineModel (const size_t* naxes, const size_t* gridCellSize, const
 SplineModel::SplineModel (const boost::filesystem::path modelFile) {
   itsGridData = loadModelFromFits(modelFile);
   itsDerivData = makeSplineDeriv(itsNGrid, itsGridData);
+
+  itsBackLine = new PIXTYPE[itsNaxes[0]];
+  makeLineCoefficients();
 }
 
 size_t* SplineModel::getGridCellSize () {
@@ -283,17 +289,22 @@ PIXTYPE  SplineModel::getValue(size_t x, size_t y){
   return rValue;
 }
 
-void SplineModel::splineLine (PIXTYPE *line, const size_t y, const size_t xStart, const size_t width) {
-  int i, j, x, yl, nbx, nbxm1, nby, nx, ystep, changepoint;
-  float dx, dx0, dy, dy3, cdx, cdy, cdy3, temp, xstep, *node, *nodep, *dnode, *blo, *bhi, *dblo, *dbhi, *u;
-  PIXTYPE *backline;
+void SplineModel::splineLine (PIXTYPE *line, const size_t y, const size_t xStart, const size_t width) const {
+  int nbx, nby, yl, ystep, first, nnodes, k;
+  float dy, dy3, cdy, cdy3, dx, cdx;
+  const PIXTYPE *node, *dnode, *blo, *bhi, *dblo, *dbhi, *xblo, *xbhi, *xdblo, *xdbhi;
+  std::vector<PIXTYPE> nodeBuffer;
 
-  backline = line;
+  if (width < 1)
+    return;
 
   nbx = itsNGrid[0];
-  nbxm1 = nbx - 1;
   nby = itsNGrid[1];
 
+  // nodes covered by the pixels to evaluate
+  first = nbx > 1 ? itsXNode[xStart] : 0;
+  nnodes = nbx > 1 ? itsXNode[xStart + width - 1] + 2 - first : 1;
+
   if (nby > 1) {
     dy = (float) y / itsGridCellSize[1] - 0.5;
     dy -= (yl = (int) dy);
@@ -305,103 +316,117 @@ void SplineModel::splineLine (PIXTYPE *line, const size_t y, const size_t xStart
       dy += 1.0;
     }
 
-    /*-- Interpolation along y for each node */
+    /*-- Interpolation along y for each node and its 2nd derivative along x */
     cdy = 1 - dy;
     dy3 = (dy * dy * dy - dy);
     cdy3 = (cdy * cdy * cdy - cdy);
-    ystep = nbx * yl;
+    ystep = nbx * yl + first;
     blo = itsGridData + ystep;
     bhi = blo + nbx;
     dblo = itsDerivData + ystep;
     dbhi = dblo + nbx;
-    //QMALLOC(node, float, nbx);  /* Interpolated background */
-    node = new float[nbx]; /* Interpolated background */
-    nodep = node;
-    for (x = nbx; x--;)
-      *(nodep++) = cdy * *(blo++) + dy * *(bhi++) + cdy3 * *(dblo++) + dy3 * *(dbhi++);
-
-    /*-- Computation of 2nd derivatives along x */
-    //QMALLOC(dnode, float, nbx); /* 2nd derivative along x */
-    dnode = new float[nbx]; /* 2nd derivative along x */
-    if (nbx > 1) {
-      //QMALLOC(u, float, nbxm1); /* temporary array */
-      u = new float[nbxm1]; /* temporary array */
-      *dnode = *u = 0.0; /* "natural" lower boundary condition */
-      nodep = node + 1;
-      for (x = nbxm1; --x; nodep++) {
-        temp = -1 / (*(dnode++) + 4);
-        *dnode = temp;
-        temp *= *(u++) - 6 * (*(nodep + 1) + *(nodep - 1) - 2 * *nodep);
-        *u = temp;
-      }
-      *(++dnode) = 0.0; /* "natural" upper boundary condition */
-      for (x = nbx - 2; x--;) {
-        temp = *(dnode--);
-        *dnode = (*dnode * temp + *(u--)) / 6.0;
-      }
-      delete[] u;
-      dnode--;
+    xblo = itsGridDerivX.data() + ystep;
+    xbhi = xblo + nbx;
+    xdblo = itsDerivDerivX.data() + ystep;
+    xdbhi = xdblo + nbx;
+
+    nodeBuffer.resize(2 * nnodes);
+    PIXTYPE *nodep = nodeBuffer.data();
+    PIXTYPE *dnodep = nodep + nnodes;
+    for (k = 0; k < nnodes; k++) {
+      nodep[k] = cdy * blo[k] + dy * bhi[k] + cdy3 * dblo[k] + dy3 * dbhi[k];
+      dnodep[k] = cdy * xblo[k] + dy * xbhi[k] + cdy3 * xdblo[k] + dy3 * xdbhi[k];
     }
+    node = nodep;
+    dnode = dnodep;
   } else {
     /*-- No interpolation and no new 2nd derivatives needed along y */
-    node = itsGridData;
-    dnode = itsDerivData;
+    node = itsGridData + first;
+    dnode = itsDerivData + first;
   }
 
   /*-- Interpolation along x */
+  if (nbx > 1) {
+    const int *xnode = itsXNode.data() + xStart;
+    const PIXTYPE *xdx = itsXDx.data() + xStart;
+    for (size_t j = 0; j < width; j++) {
+      k = xnode[j] - first;
+      dx = xdx[j];
+      cdx = 1 - dx;
+      line[j] = (PIXTYPE) (cdx * (node[k] + (cdx * cdx - 1) * dnode[k]) + dx * (node[k + 1] + (dx * dx - 1) * dnode[k + 1]));
+    }
+  } else
+    std::fill(line, line + width, *node);
+}
+
+void SplineModel::makeLineCoefficients () {
+  int i, j, x, nbx, nbxm1, nx, node, changepoint;
+  float dx, dx0, xstep;
+
+  nbx = itsNGrid[0];
+  nbxm1 = nbx - 1;
+
+  // position of every pixel of a row between its two nodes;
+  // the same stepping as the original SExtractor line interpolation
+  itsXNode.assign(itsNaxes[0], 0);
+  itsXDx.assign(itsNaxes[0], 0.0);
   if (nbx > 1) {
     nx = itsGridCellSize[0];
     xstep = 1.0 / nx;
     changepoint = nx / 2;
     dx = (xstep - 1) / 2; /* dx of the first pixel in the row */
     dx0 = ((nx + 1) % 2) * xstep / 2; /* dx of the 1st pixel right to a bkgnd node */
-    blo = node;
-    bhi = node + 1;
-    dblo = dnode;
-    dbhi = dnode + 1;
-    for (x = i = 0, j = xStart; j--; i++, dx += xstep) {
+    node = 0;
+    for (x = i = j = 0; j < (int) itsNaxes[0]; j++, i++, dx += xstep) {
       if (i == changepoint && x > 0 && x < nbxm1) {
-        blo++;
-        bhi++;
-        dblo++;
-        dbhi++;
+        node++;
         dx = dx0;
       }
-      cdx = 1 - dx;
+      itsXNode[j] = node;
+      itsXDx[j] = dx;
       if (i == nx) {
         x++;
         i = 0;
       }
     }
+  }
 
-    for (j = width; j--; i++, dx += xstep) {
-      if (i == changepoint && x > 0 && x < nbxm1) {
-        blo++;
-        bhi++;
-        dblo++;
-        dbhi++;
-        dx = dx0;
-      }
-      cdx = 1 - dx;
-
-      //*(line++) -= (*(backline++) = (PIXTYPE)(cdx*(*blo+(cdx*cdx-1)**dblo) + dx*(*bhi+(dx*dx-1)**dbhi)));
-      *(backline++) = (PIXTYPE) (cdx * (*blo + (cdx * cdx - 1) * *dblo) + dx * (*bhi + (dx * dx - 1) * *dbhi));
-      if (i == nx) {
-        x++;
-        i = 0;
-      }
+  // 2nd derivatives along x of every grid row
+  if (itsNGrid[1] > 1) {
+    itsGridDerivX.resize(itsNGridPoints);
+    itsDerivDerivX.resize(itsNGridPoints);
+    for (size_t y = 0; y < itsNGrid[1]; y++) {
+      makeSplineDerivX(itsGridData + y * nbx, itsGridDerivX.data() + y * nbx, nbx);
+      makeSplineDerivX(itsDerivData + y * nbx, itsDerivDerivX.data() + y * nbx, nbx);
     }
-  } else
-    for (j = width; j--;)
-      //*(line++) -= (*(backline++) = (PIXTYPE)*node);
-      *(backline++) = (PIXTYPE) *node;
+  }
+}
 
-  if (nby > 1) {
-    delete[] node;
-    delete[] dnode;
+void SplineModel::makeSplineDerivX (const PIXTYPE* node, PIXTYPE* dnode, const int nbx) {
+  int x;
+  float temp;
+  const PIXTYPE *nodep;
+
+  if (nbx < 2) {
+    *dnode = 0.0;
+    return;
   }
 
-  return;
+  std::vector<float> u(nbx - 1); /* temporary array */
+  float *up = u.data();
+  *dnode = *up = 0.0; /* "natural" lower boundary condition */
+  nodep = node + 1;
+  for (x = nbx - 1; --x; nodep++) {
+    temp = -1 / (*(dnode++) + 4);
+    *dnode = temp;
+    temp *= *(up++) - 6 * (*(nodep + 1) + *(nodep - 1) - 2 * *nodep);
+    *up = temp;
+  }
+  *(++dnode) = 0.0; /* "natural" upper boundary condition */
+  for (x = nbx - 2; x--;) {
+    temp = *(dnode--);
+    *dnode = (*dnode * temp + *(up--)) / 6.0;
+  }
 }
 
 PIXTYPE* SplineModel::makeSplineDeriv (const size_t* nGrid, PIXTYPE* gridData) {
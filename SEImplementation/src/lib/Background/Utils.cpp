@@ -0,0 +1,56 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * Utils.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <atomic>
+
+#include "SEFramework/FITS/TemporaryFitsImageSource.h"
+#include "SEImplementation/Background/Utils.h"
+
+namespace SourceXtractor {
+
+// Rows evaluated at once, for about 4 MB of single precision pixels
+static const int MATERIALIZE_BAND_PIXELS = 1 << 20;
+
+std::shared_ptr<ImageSource> materializeImageSource(const std::shared_ptr<ImageSource>& source,
+                                                    const std::shared_ptr<Euclid::ThreadPool>& thread_pool) {
+  int width = source->getWidth();
+  int height = source->getHeight();
+  auto target = std::make_shared<TemporaryFitsImageSource>("sourcextractor_background_%%%%%%.fits",
+                                                           width, height, source->getType());
+
+  int band_height = std::max(1, std::min(height, MATERIALIZE_BAND_PIXELS / std::max(width, 1)));
+  int nbands = (height + band_height - 1) / band_height;
+  std::atomic<int> next_row(0);
+
+  runOnThreadPool(thread_pool, nbands, [&]() {
+    int y;
+    while ((y = next_row.fetch_add(band_height)) < height) {
+      auto tile = source->getImageTile(0, y, width, std::min(band_height, height - y));
+      target->saveTile(*tile);
+    }
+  });
+
+  bck_model_logger.debug() << "\tBackground " << source->getRepr() << " written into " << target->getFullPath();
+  return target;
+}
+
+} // end of namespace SourceXtractor
@@ -0,0 +1,75 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * ConvolutionConfig.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "ElementsKernel/Logging.h"
+#include "SEFramework/Convolution/ConvolutionProfile.h"
+#include "SEImplementation/Configuration/FFTConfig.h"
+#include "SEImplementation/Configuration/ConvolutionConfig.h"
+
+using namespace Euclid::Configuration;
+namespace po = boost::program_options;
+
+namespace SourceXtractor {
+
+static Elements::Logging logger = Elements::Logging::getLogger("Config");
+
+static const std::string CONVOLUTION_AUTOTUNE {"convolution-autotune"};
+static const std::string CONVOLUTION_PROFILE {"convolution-profile"};
+
+ConvolutionConfig::ConvolutionConfig(long manager_id) : Configuration(manager_id), m_autotune(false) {
+  declareDependency<FFTConfig>();
+}
+
+auto ConvolutionConfig::getProgramOptions() -> std::map<std::string, OptionDescriptionList> {
+  return { {"Fourier transforms", {
+      {CONVOLUTION_AUTOTUNE.c_str(), po::bool_switch(),
+          "Time the direct and DFT convolutions over a range of sizes, and use the fastest for each PSF convolution"},
+      {CONVOLUTION_PROFILE.c_str(), po::value<std::string>()->default_value(""),
+          "File where the timings are kept between runs. They are measured again on a different CPU"},
+  }}};
+}
+
+void ConvolutionConfig::initialize(const UserValues& args) {
+  m_autotune = args.at(CONVOLUTION_AUTOTUNE).as<bool>();
+  m_profile_path = args.at(CONVOLUTION_PROFILE).as<std::string>();
+  if (!m_autotune) {
+    return;
+  }
+
+  std::shared_ptr<ConvolutionProfile> profile;
+  if (!m_profile_path.empty()) {
+    profile = ConvolutionProfile::load(m_profile_path);
+    if (profile) {
+      logger.info() << "Loaded the convolution profile from " << m_profile_path;
+    }
+  }
+  if (!profile) {
+    logger.info() << "Calibrating the convolutions";
+    profile = ConvolutionProfile::calibrate();
+    if (!m_profile_path.empty() && !profile->save(m_profile_path)) {
+      logger.warn() << "Could not save the convolution profile into " << m_profile_path;
+    }
+  }
+  ConvolutionProfile::setInstance(profile);
+}
+
+} // SourceXtractor namespace
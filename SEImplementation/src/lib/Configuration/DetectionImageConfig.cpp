@@ -24,6 +24,7 @@
 #include <SEFramework/Image/ProcessedImage.h>
 #include <SEFramework/Image/BufferedImage.h>
 #include "SEFramework/FITS/FitsImageSource.h"
+#include "SEFramework/FITS/MmapFitsImage.h"
 
 #include "SEFramework/CoordinateSystem/WCS.h"
 
@@ -73,7 +74,7 @@ void DetectionImageConfig::initialize(const UserValues& args) {
   m_detection_image_path = args.find(DETECTION_IMAGE)->second.as<std::string>();
   auto fits_image_source = std::make_shared<FitsImageSource>(m_detection_image_path, 0, ImageTile::FloatImage);
   m_image_source = fits_image_source;
-  m_detection_image = BufferedImage<DetectionImage::PixelType>::create(m_image_source);
+  m_detection_image = openFitsImage<DetectionImage::PixelType>(fits_image_source);
   m_coordinate_system = std::make_shared<WCS>(*fits_image_source);
 
   double detection_image_gain = 0, detection_image_saturate = 0;
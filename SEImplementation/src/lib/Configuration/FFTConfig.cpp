@@ -0,0 +1,136 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * FFTConfig.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/filesystem/operations.hpp>
+
+#include "AlexandriaKernel/StringUtils.h"
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+#include "SEUtils/Types.h"
+#include "SEFramework/FFT/FFT.h"
+#include "SEImplementation/Configuration/FFTConfig.h"
+
+using namespace Euclid::Configuration;
+namespace po = boost::program_options;
+
+namespace SourceXtractor {
+
+static Elements::Logging logger = Elements::Logging::getLogger("Config");
+
+static const std::string FFT_PLANNING {"fft-planning"};
+static const std::string FFT_WISDOM {"fft-wisdom"};
+static const std::string FFT_PREPLAN {"fft-preplan"};
+
+// The model fitting convolves up to 4 models of the same size at once (max_psf_batch in FrameModel),
+// and the background convolution 2 tiles, so every batch count up to this one is planned
+static const int PREPLAN_MAX_BATCH = 4;
+
+// Parses either "W" (a square W x W transform) or "WxH"
+static std::pair<int, int> parsePreplanSize(const std::string& value) {
+  auto sep = value.find('x');
+  int width = 0, height = 0;
+  try {
+    std::size_t end = 0;
+    width = std::stoi(value.substr(0, sep), &end);
+    if (end != value.substr(0, sep).size()) {
+      width = 0;
+    }
+    if (sep == std::string::npos) {
+      height = width;
+    }
+    else {
+      auto height_str = value.substr(sep + 1);
+      height = std::stoi(height_str, &end);
+      if (end != height_str.size()) {
+        height = 0;
+      }
+    }
+  } catch (const std::logic_error&) {
+    width = height = 0;
+  }
+  if (width <= 0 || height <= 0) {
+    throw Elements::Exception() << "Invalid " << FFT_PREPLAN << " value: " << value;
+  }
+  return {fftRoundDimension(width), fftRoundDimension(height)};
+}
+
+FFTConfig::FFTConfig(long manager_id) : Configuration(manager_id), m_planning_rigor(FFTW_ESTIMATE) {
+}
+
+auto FFTConfig::getProgramOptions() -> std::map<std::string, OptionDescriptionList> {
+  return { {"Fourier transforms", {
+      {FFT_PLANNING.c_str(), po::value<std::string>()->default_value("estimate"),
+          "Effort put into planning the transforms of each size: estimate, measure or patient. "
+          "The last two are slower to plan but faster to run, use them with fft-wisdom"},
+      {FFT_WISDOM.c_str(), po::value<std::string>()->default_value(""),
+          "File where the FFTW plans are kept between runs, imported at startup and updated at the end"},
+      {FFT_PREPLAN.c_str(), po::value<std::string>()->default_value(""),
+          "Comma separated list of sizes planned at startup, i.e. the padded model fitting stamps, "
+          "given as W for a square transform or WxH. Each is rounded up to a size convenient for FFTW, "
+          "and planned for the batches of up to 4 transforms used by the convolutions"},
+  }}};
+}
+
+void FFTConfig::initialize(const UserValues& args) {
+  auto planning = args.at(FFT_PLANNING).as<std::string>();
+  if (planning == "estimate") {
+    m_planning_rigor = FFTW_ESTIMATE;
+  }
+  else if (planning == "measure") {
+    m_planning_rigor = FFTW_MEASURE;
+  }
+  else if (planning == "patient") {
+    m_planning_rigor = FFTW_PATIENT;
+  }
+  else {
+    throw Elements::Exception() << "Invalid " << FFT_PLANNING << " value: " << planning;
+  }
+  fftSetPlanningRigor(m_planning_rigor);
+
+  m_wisdom_path = args.at(FFT_WISDOM).as<std::string>();
+  if (!m_wisdom_path.empty() && boost::filesystem::exists(m_wisdom_path)) {
+    if (fftImportWisdom(m_wisdom_path)) {
+      logger.info() << "Imported the FFTW wisdom from " << m_wisdom_path;
+    }
+    else {
+      logger.warn() << "Could not import the FFTW wisdom from " << m_wisdom_path << ", the plans will be made again";
+    }
+  }
+
+  auto preplan = args.at(FFT_PREPLAN).as<std::string>();
+  if (!preplan.empty()) {
+    for (const auto& size : Euclid::stringToVector<std::string>(preplan)) {
+      m_preplanned_sizes.emplace_back(parsePreplanSize(size));
+    }
+  }
+
+  // The plans are cached, so the convolutions of these sizes will reuse them
+  FFT<SeFloat>::work_area_t scratch;
+  for (const auto& size : m_preplanned_sizes) {
+    for (int batch = 1; batch <= PREPLAN_MAX_BATCH; ++batch) {
+      FFT<SeFloat>::createForwardPlan(size.first, size.second, batch, scratch);
+      FFT<SeFloat>::createInversePlan(size.first, size.second, batch, scratch);
+    }
+  }
+}
+
+} // SourceXtractor namespace
@@ -21,6 +21,7 @@
 #include "SEFramework/Image/ProcessedImage.h"
 
 #include "SEImplementation/Background/BackgroundAnalyzerFactory.h"
+#include "SEImplementation/Background/CachedBackgroundAnalyzer.h"
 #include "SEImplementation/Configuration/MeasurementImageConfig.h"
 
 #include "SEImplementation/Configuration/MeasurementFrameConfig.h"
@@ -48,7 +49,11 @@ void MeasurementFrameConfig::initialize(const UserValues&) {
         image_info.m_saturation_level,
         false);
 
-    auto background_analyzer = background_analyzer_factory.createBackgroundAnalyzer(image_info.m_weight_type);
+    auto background_pixels = CachedBackgroundAnalyzer::identifyPixels(
+        image_info.m_path, image_info.m_image_hdu, image_info.m_flux_scale,
+        image_info.m_weight_path, image_info.m_weight_hdu, image_info.m_weight_scaling, image_info.m_absolute_weight);
+    auto background_analyzer = background_analyzer_factory.createBackgroundAnalyzer(image_info.m_weight_type,
+                                                                                    background_pixels);
     auto background_model = background_analyzer->analyzeBackground(
         image_info.m_measurement_image,
         image_info.m_weight_image,
@@ -33,6 +33,7 @@
 #include <SEFramework/Image/BufferedImage.h>
 #include <SEFramework/Image/ProcessedImage.h>
 #include <SEFramework/FITS/FitsImageSource.h>
+#include <SEFramework/FITS/MmapFitsImage.h>
 
 #include <SEFramework/CoordinateSystem/WCS.h>
 #include <SEImplementation/Configuration/WeightImageConfig.h>
@@ -81,7 +82,7 @@ void validateImagePaths(const PyMeasurementImage& image) {
 
 std::shared_ptr<MeasurementImage> createMeasurementImage(
     std::shared_ptr<FitsImageSource> fits_image_source, double flux_scale) {
-  std::shared_ptr<MeasurementImage> image = BufferedImage<DetectionImage::PixelType>::create(fits_image_source);
+  std::shared_ptr<MeasurementImage> image = openFitsImage<MeasurementImage::PixelType>(fits_image_source);
   if (flux_scale != 1.) {
     image = MultiplyImage<MeasurementImage::PixelType>::create(image, flux_scale);
   }
@@ -118,7 +119,7 @@ std::shared_ptr<WeightImage> createWeightMap(const PyMeasurementImage& py_image)
 
   auto weight_image_source =
       std::make_shared<FitsImageSource>(py_image.weight_file, py_image.weight_hdu+1, ImageTile::FloatImage);
-  std::shared_ptr<WeightImage> weight_map = BufferedImage<WeightImage::PixelType>::create(weight_image_source);
+  std::shared_ptr<WeightImage> weight_map = openFitsImage<WeightImage::PixelType>(weight_image_source);
 
   logger.debug() << "w: " << weight_map->getWidth() << " h: " << weight_map->getHeight()
       << " t: " << py_image.weight_type << " s: " << py_image.weight_scaling;
@@ -218,6 +219,10 @@ void MeasurementImageConfig::initialize(const UserValues&) {
       info.m_psf_hdu = py_image.psf_hdu + 1;
       info.m_weight_hdu = py_image.weight_hdu + 1;
 
+      info.m_weight_path = py_image.weight_file;
+      info.m_flux_scale = flux_scale;
+      info.m_weight_scaling = py_image.weight_scaling;
+
       m_image_infos.emplace_back(std::move(info));
     }
   } else {
@@ -247,7 +252,11 @@ void MeasurementImageConfig::initialize(const UserValues&) {
 
       0, // id
 
-      1,1,1 // HDUs
+      1,1,1, // HDUs
+
+      weight_image.getWeightImagePath(),
+      detection_image.getOriginalFluxScale(),
+      weight_image.getWeightScaling()
     });
 
 
@@ -30,26 +30,60 @@ namespace SourceXtractor {
 
 static const std::string MAX_TILE_MEMORY {"tile-memory-limit"};
 static const std::string TILE_SIZE {"tile-size"};
+static const std::string TILE_READ_AHEAD {"tile-read-ahead"};
+static const std::string MAX_COMPRESSED_TILE_MEMORY {"tile-compressed-memory-limit"};
+static const std::string TILE_HUGE_PAGES {"tile-huge-pages"};
+static const std::string FITS_READ_HANDLES {"fits-read-handles"};
+static const std::string TILE_STREAMING {"tile-streaming"};
 
-MemoryConfig::MemoryConfig(long manager_id) : Configuration(manager_id), m_max_memory(512), m_tile_size(256) {
+MemoryConfig::MemoryConfig(long manager_id) : Configuration(manager_id), m_max_memory(512), m_tile_size(256),
+                                              m_read_ahead(2), m_max_compressed_memory(0),
+                                              m_huge_pages(false), m_fits_read_handles(32),
+                                              m_streaming(false) {
 }
 
 auto MemoryConfig::getProgramOptions() -> std::map<std::string, OptionDescriptionList> {
   return { {"Memory usage", {
       {MAX_TILE_MEMORY.c_str(), po::value<int>()->default_value(512), "Maximum memory used for image tiles cache in megabytes"},
       {TILE_SIZE.c_str(), po::value<int>()->default_value(256), "Image tiles size in pixels"},
+      {TILE_READ_AHEAD.c_str(), po::value<int>()->default_value(2),
+          "Number of tiles read ahead in the background during segmentation (0 to disable)"},
+      {MAX_COMPRESSED_TILE_MEMORY.c_str(), po::value<int>()->default_value(0),
+          "Maximum memory used for keeping evicted image tiles compressed in megabytes (0 to disable)"},
+      {TILE_HUGE_PAGES.c_str(), po::bool_switch(),
+          "Back the image tiles with transparent huge pages when possible"},
+      {FITS_READ_HANDLES.c_str(), po::value<int>()->default_value(32),
+          "Maximum number of extra read-only descriptors open on the FITS files, so tiles of uncompressed "
+          "images can be read concurrently (0 to disable)"},
+      {TILE_STREAMING.c_str(), po::bool_switch(),
+          "Read the detection image straight from its sources, and release it right away, while measuring the "
+          "background and while segmenting, instead of going through the tiles cache"},
   }}};
 }
 
 void MemoryConfig::initialize(const UserValues& args) {
   m_max_memory = args.at(MAX_TILE_MEMORY).as<int>();
   m_tile_size = args.at(TILE_SIZE).as<int>();
+  m_read_ahead = args.at(TILE_READ_AHEAD).as<int>();
+  m_max_compressed_memory = args.at(MAX_COMPRESSED_TILE_MEMORY).as<int>();
+  m_huge_pages = args.at(TILE_HUGE_PAGES).as<bool>();
+  m_fits_read_handles = args.at(FITS_READ_HANDLES).as<int>();
+  m_streaming = args.at(TILE_STREAMING).as<bool>();
   if (m_max_memory <= 0) {
     throw Elements::Exception() << "Invalid " << MAX_TILE_MEMORY << " value: " << m_max_memory;
   }
   if (m_tile_size <= 0) {
     throw Elements::Exception() << "Invalid " << TILE_SIZE << " value: " << m_tile_size;
   }
+  if (m_read_ahead < 0) {
+    throw Elements::Exception() << "Invalid " << TILE_READ_AHEAD << " value: " << m_read_ahead;
+  }
+  if (m_max_compressed_memory < 0) {
+    throw Elements::Exception() << "Invalid " << MAX_COMPRESSED_TILE_MEMORY << " value: " << m_max_compressed_memory;
+  }
+  if (m_fits_read_handles < 0) {
+    throw Elements::Exception() << "Invalid " << FITS_READ_HANDLES << " value: " << m_fits_read_handles;
+  }
 }
 
 } /* namespace SourceXtractor */
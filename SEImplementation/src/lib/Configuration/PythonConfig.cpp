@@ -20,6 +20,7 @@
  */
 
 #include <boost/filesystem.hpp>
+#include <SEFramework/FITS/FitsFile.h>
 #include <SEImplementation/Configuration/PythonConfig.h>
 
 using namespace Euclid::Configuration;
@@ -30,6 +31,7 @@ namespace {
 
 const std::string PYTHON_CONFIG_FILE { "python-config-file" };
 const std::string PYTHON_ARGV { "python-arg" };
+const std::string FITS_HEADER_CACHE { "fits-header-cache" };
 
 }
 
@@ -44,7 +46,9 @@ std::map<std::string, Configuration::OptionDescriptionList> PythonConfig::getPro
     {PYTHON_CONFIG_FILE.c_str(), po::value<std::string>()->default_value({}, ""),
         "Measurements python configuration file"},
     {PYTHON_ARGV.c_str(), po::value<std::vector<std::string>>()->multitoken(),
-         "Parameters to pass to Python via sys.argv"}
+         "Parameters to pass to Python via sys.argv"},
+    {FITS_HEADER_CACHE.c_str(), po::value<std::string>()->default_value({}, ""),
+        "Directory where to cache the headers of the FITS files, so they open faster on later runs"}
   }}};
 }
 
@@ -55,6 +59,9 @@ void PythonConfig::preInitialize(const UserValues& args) {
     throw Elements::Exception() << "Python configuration file " << filename
         << " does not exist";
   }
+
+  // Must be set before the configuration script opens any file
+  FitsFile::setHeaderCacheDirectory(args.find(FITS_HEADER_CACHE)->second.as<std::string>());
 }
 
 void PythonConfig::initialize(const UserValues& args) {
@@ -32,9 +32,12 @@ namespace SourceXtractor {
 static const std::string CELLSIZE_VALUE {"background-cell-size" };
 static const std::string SMOOTHINGBOX_VALUE {"smoothing-box-size" };
 static const std::string LEGACY_BACKGROUND {"background-legacy"};
+static const std::string MATERIALIZE_BACKGROUND {"background-materialize"};
+static const std::string BACKGROUND_CACHE {"background-cache"};
+static const std::string BACKGROUND_CACHE_SIZE {"background-cache-size"};
 
 SE2BackgroundConfig::SE2BackgroundConfig(long manager_id) :
-  Configuration(manager_id), m_cell_size(), m_smoothing_box(), m_legacy(false) {
+  Configuration(manager_id), m_cell_size(), m_smoothing_box(), m_legacy(false), m_materialize(false), m_cache_size(0) {
 }
 
 std::map<std::string, Configuration::OptionDescriptionList> SE2BackgroundConfig::getProgramOptions() {
@@ -44,7 +47,14 @@ std::map<std::string, Configuration::OptionDescriptionList> SE2BackgroundConfig:
       {SMOOTHINGBOX_VALUE.c_str(), po::value<std::string>()->default_value(std::string("3")),
           "Background median filter size"},
       {LEGACY_BACKGROUND.c_str(), po::bool_switch(),
-          "Use the legacy implementation"}
+          "Use the legacy implementation"},
+      {MATERIALIZE_BACKGROUND.c_str(), po::bool_switch(),
+          "Compute the full resolution background once, into a temporary file, instead of interpolating it on demand"},
+      {BACKGROUND_CACHE.c_str(), po::value<std::string>()->default_value(""),
+          "Directory where the background models are kept, and reused by later runs over the same images"},
+      {BACKGROUND_CACHE_SIZE.c_str(), po::value<int>()->default_value(10240),
+          "Maximum size in MB of the background cache, the models not used for the longest time are removed "
+          "beyond it (0 for no limit)"}
   }}};
 }
 
@@ -71,6 +81,19 @@ void SE2BackgroundConfig::initialize(const UserValues& args) {
   if (args.find(LEGACY_BACKGROUND) != args.end()) {
     m_legacy = args.at(LEGACY_BACKGROUND).as<bool>();
   }
+  if (args.find(MATERIALIZE_BACKGROUND) != args.end()) {
+    m_materialize = args.at(MATERIALIZE_BACKGROUND).as<bool>();
+  }
+  if (args.find(BACKGROUND_CACHE) != args.end()) {
+    m_cache_directory = args.at(BACKGROUND_CACHE).as<std::string>();
+  }
+  if (args.find(BACKGROUND_CACHE_SIZE) != args.end()) {
+    int cache_size = args.at(BACKGROUND_CACHE_SIZE).as<int>();
+    if (cache_size < 0) {
+      throw Elements::Exception() << "Invalid " << BACKGROUND_CACHE_SIZE << " value: " << cache_size;
+    }
+    m_cache_size = static_cast<std::uintmax_t>(cache_size) * 1024 * 1024;
+  }
 }
 
 } // SourceXtractor namespace
@@ -38,6 +38,7 @@ using boost::smatch;
 #include "SEFramework/FITS/FitsReader.h"
 
 #include "SEImplementation/Segmentation/BackgroundConvolution.h"
+#include "SEImplementation/Configuration/MultiThreadingConfig.h"
 #include "SEImplementation/Configuration/SegmentationConfig.h"
 
 using namespace Euclid::Configuration;
@@ -50,11 +51,14 @@ static Elements::Logging segConfigLogger = Elements::Logging::getLogger("Config"
 static const std::string SEGMENTATION_ALGORITHM {"segmentation-algorithm" };
 static const std::string SEGMENTATION_DISABLE_FILTERING {"segmentation-disable-filtering" };
 static const std::string SEGMENTATION_FILTER {"segmentation-filter" };
+static const std::string SEGMENTATION_FILTER_SEPARABLE_TOLERANCE {"segmentation-filter-separable-tolerance" };
 static const std::string SEGMENTATION_LUTZ_WINDOW_SIZE {"segmentation-lutz-window-size" };
 static const std::string SEGMENTATION_BFS_MAX_DELTA {"segmentation-bfs-max-delta" };
 
 SegmentationConfig::SegmentationConfig(long manager_id) : Configuration(manager_id),
-    m_selected_algorithm(Algorithm::UNKNOWN), m_lutz_window_size(0), m_bfs_max_delta(1000) {
+    m_selected_algorithm(Algorithm::UNKNOWN), m_lutz_window_size(0), m_bfs_max_delta(1000),
+    m_separable_tolerance(0) {
+  declareDependency<MultiThreadingConfig>();
 }
 
 std::map<std::string, Configuration::OptionDescriptionList> SegmentationConfig::getProgramOptions() {
@@ -65,6 +69,8 @@ std::map<std::string, Configuration::OptionDescriptionList> SegmentationConfig::
           "Disables filtering"},
       {SEGMENTATION_FILTER.c_str(), po::value<std::string>()->default_value(""),
           "Loads a filter"},
+      {SEGMENTATION_FILTER_SEPARABLE_TOLERANCE.c_str(), po::value<double>()->default_value(1e-4),
+          "Relative error allowed to apply the filter as 1D passes (0=disable)"},
       {SEGMENTATION_LUTZ_WINDOW_SIZE.c_str(), po::value<int>()->default_value(0),
           "Lutz sliding window size (0=disable)"},
       {SEGMENTATION_BFS_MAX_DELTA.c_str(), po::value<int>()->default_value(1000),
@@ -83,6 +89,12 @@ void SegmentationConfig::preInitialize(const UserValues& args) {
   }
 
 
+  m_separable_tolerance = args.at(SEGMENTATION_FILTER_SEPARABLE_TOLERANCE).as<double>();
+  if (m_separable_tolerance < 0) {
+    throw Elements::Exception() << "Invalid " << SEGMENTATION_FILTER_SEPARABLE_TOLERANCE << ": "
+                                << m_separable_tolerance;
+  }
+
   if (args.at(SEGMENTATION_DISABLE_FILTERING).as<bool>()) {
     m_filter = nullptr;
   } else {
@@ -101,6 +113,10 @@ void SegmentationConfig::preInitialize(const UserValues& args) {
 }
 
 void SegmentationConfig::initialize(const UserValues&) {
+  auto convolution = std::dynamic_pointer_cast<BackgroundConvolution>(m_filter);
+  if (convolution) {
+    convolution->setThreadPool(getDependency<MultiThreadingConfig>().getThreadPool());
+  }
 }
 
 std::shared_ptr<DetectionImageFrame::ImageFilter> SegmentationConfig::getDefaultFilter() const {
@@ -118,7 +134,7 @@ std::shared_ptr<DetectionImageFrame::ImageFilter> SegmentationConfig::getDefault
   convolution_kernel->setValue(2,1, 2);
   convolution_kernel->setValue(2,2, 1);
 
-  return std::make_shared<BackgroundConvolution>(convolution_kernel, true);
+  return std::make_shared<BackgroundConvolution>(convolution_kernel, true, m_separable_tolerance);
 }
 
 std::shared_ptr<DetectionImageFrame::ImageFilter> SegmentationConfig::loadFilter(const std::string& filename) const {
@@ -144,7 +160,7 @@ std::shared_ptr<DetectionImageFrame::ImageFilter> SegmentationConfig::loadFITSFi
   segConfigLogger.info() << "Loaded segmentation filter: " << filename << " height: " << convolution_kernel->getHeight() << " width: " << convolution_kernel->getWidth();
 
   // return the correct object
-  return std::make_shared<BackgroundConvolution>(convolution_kernel, true);
+  return std::make_shared<BackgroundConvolution>(convolution_kernel, true, m_separable_tolerance);
 }
 
 static bool getNormalization(std::istream& line_stream) {
@@ -227,7 +243,7 @@ std::shared_ptr<DetectionImageFrame::ImageFilter> SegmentationConfig::loadASCIIF
   segConfigLogger.info() << "Loaded segmentation filter: " << filename << " width: " << convolution_kernel->getWidth() << " height: " << convolution_kernel->getHeight();
 
   // return the correct object
-  return std::make_shared<BackgroundConvolution>(convolution_kernel, normalize);
+  return std::make_shared<BackgroundConvolution>(convolution_kernel, normalize, m_separable_tolerance);
 }
 
 } // SourceXtractor namespace
@@ -108,6 +108,7 @@ void WeightImageConfig::initialize(const UserValues& args) {
   if (weight_image_filename != "") {
     m_weight_image = FitsReader<WeightImage::PixelType>::readFile(weight_image_filename);
   }
+  m_weight_image_path = weight_image_filename;
 
   auto weight_type_name = boost::to_upper_copy(args.at(WEIGHT_TYPE).as<std::string>());
   auto weight_iter = WEIGHT_MAP.find(weight_type_name);
@@ -104,18 +104,27 @@ std::shared_ptr<VectorImage<SeFloat>> FlexibleModelFittingTask::createWeightImag
   auto rect = group.getProperty<MeasurementFrameGroupRectangle>(frame_index);
   auto weight = VectorImage<SeFloat>::create(rect.getWidth(), rect.getHeight());
 
+  auto image_chunk = frame_image->getChunk(rect.getTopLeft().m_x, rect.getTopLeft().m_y,
+                                           rect.getWidth(), rect.getHeight());
+  auto variance_chunk = variance_map->getChunk(rect.getTopLeft().m_x, rect.getTopLeft().m_y,
+                                               rect.getWidth(), rect.getHeight());
+
   for (int y = 0; y < rect.getHeight(); y++) {
+    const SeFloat* pixel_row = image_chunk->getRowSpan(y);
+    const SeFloat* back_var_row = variance_chunk->getRowSpan(y);
+    SeFloat* weight_row = &weight->at(0, y);
+
     for (int x = 0; x < rect.getWidth(); x++) {
-      auto back_var = variance_map->getValue(rect.getTopLeft().m_x + x, rect.getTopLeft().m_y + y);
-      auto pixel_val = frame_image->getValue(rect.getTopLeft().m_x + x, rect.getTopLeft().m_y + y);
+      auto back_var = back_var_row[x];
+      auto pixel_val = pixel_row[x];
       if (saturation > 0 && pixel_val > saturation) {
-        weight->at(x, y) = 0;
+        weight_row[x] = 0;
       }
       else if (gain > 0.0 && pixel_val > 0.0) {
-        weight->at(x, y) = sqrt(1.0 / (back_var + pixel_val / gain));
+        weight_row[x] = sqrt(1.0 / (back_var + pixel_val / gain));
       }
       else {
-        weight->at(x, y) = sqrt(1.0 / back_var); // infinite gain
+        weight_row[x] = sqrt(1.0 / back_var); // infinite gain
       }
     }
   }
@@ -34,30 +34,19 @@ using SExtractor::Mat22;
 static const SeFloat GROWTH_NSIG = 6.;
 static const size_t GROWTH_NSAMPLES = 64;
 
-static SeFloat getPixelValue(int x, int y, SeFloat centroid_x, SeFloat centroid_y,
-                             const std::shared_ptr<ImageAccessor<SeFloat>>& image,
-                             const std::shared_ptr<ImageAccessor<SeFloat>>& variance_map, SeFloat variance_threshold,
-                             bool use_symmetry) {
-  // Get the pixel value
-  DetectionImage::PixelType pixel_value = 0;
-  // Masked out
-  if (variance_map->getValue(x, y) > variance_threshold) {
-    if (use_symmetry) {
-      auto mirror_x = 2 * centroid_x - x + 0.49999;
-      auto mirror_y = 2 * centroid_y - y + 0.49999;
-      if (mirror_x >= 0 && mirror_y >= 0 && mirror_x < image->getWidth() && mirror_y < image->getHeight()) {
-        if (variance_map->getValue(mirror_x, mirror_y) < variance_threshold) {
-          // mirror pixel is OK: take the value
-          pixel_value = image->getValue(mirror_x, mirror_y);
-        }
-      }
+static SeFloat getMirrorPixelValue(int x, int y, SeFloat centroid_x, SeFloat centroid_y,
+                                   const std::shared_ptr<ImageAccessor<SeFloat>>& image,
+                                   const std::shared_ptr<ImageAccessor<SeFloat>>& variance_map,
+                                   SeFloat variance_threshold) {
+  auto mirror_x = 2 * centroid_x - x + 0.49999;
+  auto mirror_y = 2 * centroid_y - y + 0.49999;
+  if (mirror_x >= 0 && mirror_y >= 0 && mirror_x < image->getWidth() && mirror_y < image->getHeight()) {
+    if (variance_map->getValue(mirror_x, mirror_y) < variance_threshold) {
+      // mirror pixel is OK: take the value
+      return image->getValue(mirror_x, mirror_y);
     }
   }
-  // Not masked
-  else {
-    pixel_value = image->getValue(x, y);
-  }
-  return pixel_value;
+  return 0;
 }
 
 GrowthCurveTask::GrowthCurveTask(unsigned instance, bool use_symmetry)
@@ -104,19 +93,34 @@ void GrowthCurveTask::computeProperties(SourceInterface& source) const {
 
   // Boundaries for the computation
   // We know the last aperture is the widest, so we take the limits from it
+  // Only the pixels inside the image contribute
   auto min_coord = apertures.back().getMinPixel(centroid_x, centroid_y);
   auto max_coord = apertures.back().getMaxPixel(centroid_x, centroid_y);
+  int min_x = std::max(min_coord.m_x, 0);
+  int min_y = std::max(min_coord.m_y, 0);
+  int max_x = std::min(max_coord.m_x, image->getWidth() - 1);
+  int max_y = std::min(max_coord.m_y, image->getHeight() - 1);
+  if (min_x > max_x || min_y > max_y) {
+    source.setIndexedProperty<GrowthCurve>(m_instance, std::move(fluxes), rlim);
+    return;
+  }
+
+  auto image_chunk = image->getChunk(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+  auto variance_chunk = variance_map->getChunk(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
 
   // Compute fluxes for each ring
-  for (auto y = min_coord.m_y; y <= max_coord.m_y; ++y) {
-    for (auto x = min_coord.m_x; x <= max_coord.m_x; ++x) {
-      if (!image->isInside(x, y)) {
-        continue;
+  for (auto y = min_y; y <= max_y; ++y) {
+    const SeFloat* image_row = image_chunk->getRowSpan(y - min_y);
+    const SeFloat* variance_row = variance_chunk->getRowSpan(y - min_y);
+
+    for (auto x = min_x; x <= max_x; ++x) {
+      SeFloat pixel_value = 0;
+      if (variance_row[x - min_x] <= variance_threshold) {
+        pixel_value = image_row[x - min_x];
+      }
+      else if (m_use_symmetry) {
+        pixel_value = getMirrorPixelValue(x, y, centroid_x, centroid_y, image, variance_map, variance_threshold);
       }
-
-      auto pixel_value = getPixelValue(x, y, centroid_x, centroid_y, image,
-                                       variance_map, variance_threshold,
-                                       m_use_symmetry);
 
       // Assign the pixel value according to the affected area
       auto dx = x - centroid_x;
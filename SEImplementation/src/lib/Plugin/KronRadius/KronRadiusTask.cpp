@@ -21,6 +21,7 @@
  *      Author: mkuemmel@usm.lmu.de
  */
 
+#include <algorithm>
 #include <math.h>
 
 #include "SEFramework/Aperture/EllipticalAperture.h"
@@ -90,8 +91,25 @@ void KronRadiusTask::computeProperties(SourceInterface& source) const {
   SeFloat area_full = 0;
   long int flag = 0;
 
+  // get at once the part of the aperture inside the image
+  int inside_min_x = std::max(min_pixel.m_x, 0);
+  int inside_min_y = std::max(min_pixel.m_y, 0);
+  int inside_max_x = std::min(max_pixel.m_x, detection_image->getWidth() - 1);
+  int inside_max_y = std::min(max_pixel.m_y, detection_image->getHeight() - 1);
+  std::shared_ptr<ImageChunk<SeFloat>> image_chunk, variance_chunk;
+  if (inside_min_x <= inside_max_x && inside_min_y <= inside_max_y) {
+    int inside_width = inside_max_x - inside_min_x + 1;
+    int inside_height = inside_max_y - inside_min_y + 1;
+    image_chunk = detection_image->getChunk(inside_min_x, inside_min_y, inside_width, inside_height);
+    variance_chunk = detection_variance->getChunk(inside_min_x, inside_min_y, inside_width, inside_height);
+  }
+
   // iterate over the aperture pixels
   for (int pixel_y = min_pixel.m_y; pixel_y <= max_pixel.m_y; pixel_y++) {
+    bool row_inside = image_chunk && pixel_y >= inside_min_y && pixel_y <= inside_max_y;
+    const SeFloat* image_row = row_inside ? image_chunk->getRowSpan(pixel_y - inside_min_y) : nullptr;
+    const SeFloat* variance_row = row_inside ? variance_chunk->getRowSpan(pixel_y - inside_min_y) : nullptr;
+
     for (int pixel_x = min_pixel.m_x; pixel_x <= max_pixel.m_x; pixel_x++) {
 
       // check whether the current pixel is inside
@@ -101,18 +119,18 @@ void KronRadiusTask::computeProperties(SourceInterface& source) const {
       }
 
       // make sure the pixel is inside the image
-      if (detection_image->isInside(pixel_x, pixel_y)) {
+      if (row_inside && pixel_x >= inside_min_x && pixel_x <= inside_max_x) {
         SeFloat value = 0;
 
         // enhance the area
         area_sum += 1;
 
         // get the variance value
-        auto pixel_variance = detection_variance->getValue(pixel_x, pixel_y);
+        auto pixel_variance = variance_row[pixel_x - inside_min_x];
 
         // check whether the pixel is good
         bool is_good = pixel_variance < variance_threshold;
-        value = detection_image->getValue(pixel_x, pixel_y) * is_good;
+        value = image_row[pixel_x - inside_min_x] * is_good;
         area_bad += !is_good;
 
         // check whether the pixel is part of another object
@@ -19,6 +19,7 @@
 #include "SEImplementation/Plugin/Onnx/OnnxProperty.h"
 #include "SEImplementation/Plugin/DetectionFrameImages/DetectionFrameImages.h"
 #include "SEImplementation/Plugin/PixelCentroid/PixelCentroid.h"
+#include <algorithm>
 #include <NdArray/NdArray.h>
 #include <AlexandriaKernel/memory_tools.h>
 #include <onnxruntime_cxx_api.h>
@@ -35,16 +36,18 @@ static void fillCutout(const Image<T>& image, int center_x, int center_y, int wi
   int x_end = x_start + width;
   int y_end = y_start + height;
 
-  ImageAccessor<T> accessor(image);
-
-  int index = 0;
-  for (int iy = y_start; iy < y_end; iy++) {
-    for (int ix = x_start; ix < x_end; ix++, index++) {
-      if (ix >= 0 && iy >= 0 && ix < image.getWidth() && iy < image.getHeight()) {
-        out[index] = accessor.getValue(ix, iy);
-      }
-    }
+  // Pixels outside the image are left untouched
+  int inside_x_start = std::max(x_start, 0);
+  int inside_y_start = std::max(y_start, 0);
+  int inside_width = std::min(x_end, image.getWidth()) - inside_x_start;
+  int inside_height = std::min(y_end, image.getHeight()) - inside_y_start;
+  if (inside_width <= 0 || inside_height <= 0) {
+    return;
   }
+
+  image.forEachRow(inside_x_start, inside_y_start, inside_width, inside_height, [&](int iy, const T* row) {
+    std::copy(row, row + inside_width, out.begin() + (iy - y_start) * width + (inside_x_start - x_start));
+  });
 }
 
 OnnxSourceTask::OnnxSourceTask(const std::vector<OnnxModel>& models) : m_models(models) {}
@@ -68,28 +68,47 @@ void VignetSourceTask::computeProperties(SourceInterface& source) const {
 
   // create and fill the vignet vector using the measurement frame
   std::vector<SeFloat> vignet_vector(m_vignet_size[0] * m_vignet_size[1], m_vignet_default_pixval);
-  int index = 0;
-  for (int iy = y_start; iy < y_end; iy++) {
-    for (int ix = x_start; ix < x_end; ix++, index++) {
 
-      // skip pixels outside of the image
-      if (ix < 0 || iy < 0 || ix >= measurement_sub_image->getWidth() || iy >= measurement_sub_image->getHeight())
+  // pixels outside of the image are skipped
+  int inside_x_start = std::max(x_start, 0);
+  int inside_y_start = std::max(y_start, 0);
+  int inside_x_end = std::min(x_end, measurement_sub_image->getWidth());
+  int inside_y_end = std::min(y_end, measurement_sub_image->getHeight());
+  if (inside_x_start >= inside_x_end || inside_y_start >= inside_y_end) {
+    source.setIndexedProperty<Vignet>(m_instance,
+      VectorImage<DetectionImage::PixelType>::create(m_vignet_size[0], m_vignet_size[1], std::move(vignet_vector)));
+    return;
+  }
+
+  int inside_width = inside_x_end - inside_x_start;
+  int inside_height = inside_y_end - inside_y_start;
+  auto sub_chunk = measurement_sub_image->getChunk(inside_x_start, inside_y_start, inside_width, inside_height);
+  auto var_chunk = measurement_var_image->getChunk(inside_x_start, inside_y_start, inside_width, inside_height);
+
+  for (int iy = inside_y_start; iy < inside_y_end; iy++) {
+    const SeFloat* sub_row = sub_chunk->getRowSpan(iy - inside_y_start);
+    const SeFloat* var_row = var_chunk->getRowSpan(iy - inside_y_start);
+    int index = (iy - y_start) * m_vignet_size[0] + (inside_x_start - x_start);
+
+    for (int ix = inside_x_start; ix < inside_x_end; ix++, index++) {
+
+      // masked pixels are not copied, so there is no need to look at the detection frame
+      if (var_row[ix - inside_x_start] > measurement_var_threshold)
         continue;
 
       // translate pixel coordinates to the detection frame
       auto world_coord = measurement_coordinate_system->imageToWorld({static_cast<double>(ix), static_cast<double>(iy)});
       auto detection_coord = detection_coordinate_system->worldToImage(world_coord);
 
-      // copy the pixel value if it is not masked, and if it does not correspond to a detection pixel
+      // copy the pixel value if it does not correspond to a detection pixel
       // if it corresponds to a detection pixel, use it if it belongs to the source
       int detection_x = static_cast<int>(detection_coord.m_x + 0.5);
       int detection_y = static_cast<int>(detection_coord.m_y + 0.5);
 
-      bool is_masked = measurement_var_image->getValue(ix, iy) > measurement_var_threshold;
       bool is_detection_pixel = detection_thresh_image->getValue(detection_x, detection_y) > 0;
 
-      if (!is_masked && (!is_detection_pixel || pixel_coords.contains({detection_x, detection_y}))) {
-        vignet_vector[index] = measurement_sub_image->getValue(ix, iy);
+      if (!is_detection_pixel || pixel_coords.contains({detection_x, detection_y})) {
+        vignet_vector[index] = sub_row[ix - inside_x_start];
       }
     }
   }
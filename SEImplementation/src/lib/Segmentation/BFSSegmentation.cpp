@@ -43,7 +43,24 @@ void BFSSegmentation::labelImage(Segmentation::LabellingListener& listener,
 
   VisitedMap visited(detection_image->getWidth(), detection_image->getHeight());
 
-  for (auto& tile : tiles) {
+  // The tiles are visited following the Hilbert curve, so the next ones are known in advance
+  auto tile_manager = TileManager::getInstance();
+  auto read_ahead = static_cast<size_t>(tile_manager->getReadAhead());
+  auto prefetch = [&](size_t i) {
+    if (i < tiles.size()) {
+      const auto& next = tiles[i];
+      tile_manager->prefetch(detection_image, next.offset.m_x, next.offset.m_y, next.width, next.height);
+    }
+  };
+  for (size_t i = 1; i <= read_ahead; ++i) {
+    prefetch(i);
+  }
+
+  for (size_t tile_idx = 0; tile_idx < tiles.size(); ++tile_idx) {
+    auto& tile = tiles[tile_idx];
+    if (tile_idx > 0) {
+      prefetch(tile_idx + read_ahead);
+    }
     auto chunk = detection_image->getChunk(tile.offset.m_x, tile.offset.m_y, tile.width, tile.height);
     for (int y=0; y<tile.height; y++) {
       for (int x=0; x<tile.width; x++) {
@@ -25,6 +25,7 @@
 #include "SEImplementation/Segmentation/BgConvolutionImageSource.h"
 #include "SEImplementation/Segmentation/BgDFTConvolutionImageSource.h"
 #include "SEImplementation/Segmentation/BackgroundConvolution.h"
+#include "SEFramework/Convolution/ConvolutionProfile.h"
 #include <ElementsKernel/Logging.h>
 
 namespace SourceXtractor {
@@ -35,10 +36,25 @@ std::shared_ptr<DetectionImage>
 BackgroundConvolution::processImage(std::shared_ptr<DetectionImage> image, std::shared_ptr<DetectionImage> variance,
                                     SeFloat threshold) const {
 
-  if (m_convolution_filter->getWidth() > 5) {
+  // The 1D passes of a separable filter are cheaper than the DFT as long as they need fewer products
+  // than the smallest filter sent to the DFT (7x7)
+  if (m_separable && m_separable->getRank() * (m_separable->getWidth() + m_separable->getHeight()) < 7 * 7) {
+    logger.debug() << "Using separable direct algorithm for the image convolution (rank "
+                   << m_separable->getRank() << ", error " << m_separable->getError() << ")";
+    return BufferedImage<DetectionImage::PixelType>::create(
+      std::make_shared<BgConvolutionImageSource>(image, variance, threshold, m_convolution_filter,
+                                                 m_separable_tolerance)
+    );
+  }
+
+  // The calibrated profile times the plain convolutions, not these masked ones batched over the thread pool,
+  // so the filter keeps the fixed rule
+  auto engine = ConvolutionProfile::selectFixed(m_convolution_filter->getWidth(), m_convolution_filter->getHeight());
+  if (engine == ConvolutionProfile::Engine::DFT) {
     logger.debug() << "Using DFT algorithm for the image convolution";
     return BufferedImage<DetectionImage::PixelType>::create(
-      std::make_shared<BgDFTConvolutionImageSource>(image, variance, threshold, m_convolution_filter)
+      std::make_shared<BgDFTConvolutionImageSource>(image, variance, threshold, m_convolution_filter,
+                                                    m_thread_pool)
     );
   }
   logger.debug() << "Using direct algorithm for the image convolution";
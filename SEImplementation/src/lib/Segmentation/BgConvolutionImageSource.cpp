@@ -30,10 +30,12 @@ namespace SourceXtractor {
 
 BgConvolutionImageSource::BgConvolutionImageSource(std::shared_ptr<Image<DetectionImage::PixelType>> image,
                                                    std::shared_ptr<DetectionImage> variance, SeFloat threshold,
-                                                   std::shared_ptr<VectorImage<SeFloat>> kernel)
+                                                   std::shared_ptr<VectorImage<SeFloat>> kernel,
+                                                   double separable_tolerance)
   : ProcessingImageSource<DetectionImage::PixelType>(image),
     m_variance(variance), m_threshold(threshold) {
   m_kernel = VectorImage<SeFloat>::create(MirrorImage<SeFloat>::create(kernel));
+  m_separable = SeparableKernel<SeFloat>::decompose(*m_kernel, separable_tolerance);
 }
 
 std::string BgConvolutionImageSource::getRepr() const {
@@ -66,6 +68,11 @@ applyKernel(const VectorImage<SeFloat>& kernel, ImageChunk<SeFloat>& image_chunk
 void BgConvolutionImageSource::generateTile(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
                                             ImageTileWithType<DetectionImage::PixelType>& tile, int start_x,
                                             int start_y, int width, int height) const {
+  if (m_separable) {
+    generateSeparableTile(image, tile, start_x, start_y, width, height);
+    return;
+  }
+
   const int hx = m_kernel->getWidth() / 2;
   const int hy = m_kernel->getHeight() / 2;
   const int clip_x = std::max(start_x - hx, 0);
@@ -103,5 +110,57 @@ void BgConvolutionImageSource::generateTile(const std::shared_ptr<Image<Detectio
 }
 
 
+void BgConvolutionImageSource::generateSeparableTile(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
+                                                     ImageTileWithType<DetectionImage::PixelType>& tile, int start_x,
+                                                     int start_y, int width, int height) const {
+  const int hx = m_kernel->getWidth() / 2;
+  const int hy = m_kernel->getHeight() / 2;
+  const int clip_x = std::max(start_x - hx, 0);
+  const int clip_y = std::max(start_y - hy, 0);
+  const int clip_w = std::min(width + hx * 2, image->getWidth() - clip_x);
+  const int clip_h = std::min(height + hy * 2, image->getHeight() - clip_y);
+
+  auto image_chunk = image->getChunk(clip_x, clip_y, clip_w, clip_h);
+  auto variance_chunk = m_variance->getChunk(clip_x, clip_y, clip_w, clip_h);
+
+  // Masked image and mask, padded with 0 where the kernel goes out of the image, as applyKernel skips those
+  const int padded_w = width + m_kernel->getWidth() - 1;
+  const int padded_h = height + m_kernel->getHeight() - 1;
+  const int pad_x = clip_x - (start_x - hx);
+  const int pad_y = clip_y - (start_y - hy);
+  // The clip may cover more than needed when it is shifted by the left or top borders
+  const int copy_w = std::min(clip_w, padded_w - pad_x);
+  const int copy_h = std::min(clip_h, padded_h - pad_y);
+  std::vector<DetectionImage::PixelType> masked(padded_w * padded_h), mask(padded_w * padded_h);
+  for (int iy = 0; iy < copy_h; ++iy) {
+    for (int ix = 0; ix < copy_w; ++ix) {
+      if (variance_chunk->getValue(ix, iy) < m_threshold) {
+        auto offset = ix + pad_x + (iy + pad_y) * padded_w;
+        masked[offset] = image_chunk->getValue(ix, iy);
+        mask[offset] = 1.;
+      }
+    }
+  }
+
+  std::vector<DetectionImage::PixelType> total(width * height), conv_weight(width * height);
+  m_separable->correlate(masked.data(), padded_w, padded_h, total.data());
+  m_separable->correlate(mask.data(), padded_w, padded_h, conv_weight.data());
+
+  const int off_x = start_x - clip_x;
+  const int off_y = start_y - clip_y;
+  auto& tile_image = *tile.getImage();
+  for (int iy = 0; iy < height; ++iy) {
+    for (int ix = 0; ix < width; ++ix) {
+      if (variance_chunk->getValue(ix + off_x, iy + off_y) < m_threshold) {
+        tile_image.setValue(ix, iy, total[ix + iy * width] / conv_weight[ix + iy * width]);
+      }
+      else {
+        tile_image.setValue(ix, iy, 0.);
+      }
+    }
+  }
+}
+
+
 } // end namespace SourceXtractor
 
@@ -22,20 +22,27 @@
  *      Refactored out from: BackgroundConvolution.h
  */
 
+#include <atomic>
+
+#include "AlexandriaKernel/memory_tools.h"
+
 #include "SEImplementation/Segmentation/BgDFTConvolutionImageSource.h"
+#include "SEImplementation/Background/Utils.h"
 #include "SEFramework/Image/ImageAccessor.h"
 #include "SEFramework/Image/FunctionalImage.h"
 #include "SEFramework/Image/SubImage.h"
 #include "SEFramework/Image/MaskedImage.h"
+#include "SEFramework/Image/TileManager.h"
 
 namespace SourceXtractor {
 
 
 BgDFTConvolutionImageSource::BgDFTConvolutionImageSource(std::shared_ptr<Image<DetectionImage::PixelType>> image,
                                                          std::shared_ptr<DetectionImage> variance, SeFloat threshold,
-                                                         std::shared_ptr<VectorImage<SeFloat>> kernel)
+                                                         std::shared_ptr<VectorImage<SeFloat>> kernel,
+                                                         std::shared_ptr<Euclid::ThreadPool> thread_pool)
   : ProcessingImageSource<DetectionImage::PixelType>(image),
-    m_variance(variance), m_threshold(threshold), m_convolution(kernel) {
+    m_variance(variance), m_threshold(threshold), m_convolution(kernel), m_thread_pool(std::move(thread_pool)) {
 }
 
 std::string BgDFTConvolutionImageSource::getRepr() const {
@@ -45,6 +52,76 @@ std::string BgDFTConvolutionImageSource::getRepr() const {
 void BgDFTConvolutionImageSource::generateTile(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
                                                ImageTileWithType<DetectionImage::PixelType>& tile, int start_x,
                                                int start_y, int width, int height) const {
+  auto tile_manager = TileManager::getInstance();
+  int block_w = getBlockSize(width, tile_manager->getTileWidth());
+  int block_h = getBlockSize(height, tile_manager->getTileHeight());
+  int nblocks_x = (width + block_w - 1) / block_w;
+  int nblocks_y = (height + block_h - 1) / block_h;
+
+  if (nblocks_x * nblocks_y <= 1) {
+    convolveBlock(image, tile, start_x, start_y, width, height);
+    return;
+  }
+
+  // The helpers read the image the same way the caller does, bypassing the cache inside a sweep
+  bool sweeping = tile_manager->isSweeping();
+
+  // Each block writes its own pixels of the tile
+  std::atomic<int> next_block(0);
+  runOnThreadPool(m_thread_pool, nblocks_x * nblocks_y, [&]() {
+    std::unique_ptr<TileManager::Sweep> sweep;
+    if (sweeping) {
+      sweep = Euclid::make_unique<TileManager::Sweep>();
+    }
+    for (int i = next_block++; i < nblocks_x * nblocks_y; i = next_block++) {
+      int x = start_x + (i % nblocks_x) * block_w;
+      int y = start_y + (i / nblocks_x) * block_h;
+      convolveBlock(image, tile, x, y,
+                    std::min(block_w, start_x + width - x), std::min(block_h, start_y + height - y));
+    }
+  });
+}
+
+int BgDFTConvolutionImageSource::getBlockSize(int size, int tile_size) const {
+  // Regions larger than a tile (read during a sweep) are split into tiles
+  if (size > tile_size) {
+    return tile_size;
+  }
+  // A single tile is split in two, so it is convolved by several threads too. Smaller blocks would waste
+  // too much on the margins
+  if (m_thread_pool && size >= 2 * s_min_block_size) {
+    return (size + 1) / 2;
+  }
+  return size;
+}
+
+auto BgDFTConvolutionImageSource::acquireContext(int width, int height) const -> ContextPtr {
+  std::lock_guard<std::mutex> lock(m_contexts_mutex);
+  auto key = std::make_pair(width, height);
+
+  auto& idle = m_idle_contexts[key];
+  if (!idle.empty()) {
+    auto context = std::move(idle.back());
+    idle.pop_back();
+    return context;
+  }
+
+  auto& reference = m_reference_contexts[key];
+  if (!reference) {
+    // The masked image and the mask
+    reference = m_convolution.prepare(width, height, 2);
+  }
+  return m_convolution.prepareLike(*reference);
+}
+
+void BgDFTConvolutionImageSource::releaseContext(int width, int height, ContextPtr context) const {
+  std::lock_guard<std::mutex> lock(m_contexts_mutex);
+  m_idle_contexts[std::make_pair(width, height)].emplace_back(std::move(context));
+}
+
+void BgDFTConvolutionImageSource::convolveBlock(const std::shared_ptr<Image<DetectionImage::PixelType>>& image,
+                                                ImageTileWithType<DetectionImage::PixelType>& tile, int start_x,
+                                                int start_y, int width, int height) const {
   int hx = m_convolution.getWidth() / 2;
   int hy = m_convolution.getHeight() / 2;
   int clip_x = std::max(start_x - hx, 0);
@@ -80,14 +157,14 @@ void BgDFTConvolutionImageSource::generateTile(const std::shared_ptr<Image<Detec
     clipped_img, mask, 0., 0.);
 
   // Convolve the masked image, padding with 0
-  auto conv_masked = VectorImage<DetectionImage::PixelType>::create(masked_img);
-  m_convolution.convolve(conv_masked);
-
-  // Convolve the mask
+  // Convolve the mask too, in the same batch
   // This gives us in each cell the sum of the kernel values that have been used,
   // so we can divide the previous convolution.
+  auto conv_masked = VectorImage<DetectionImage::PixelType>::create(masked_img);
   auto conv_mask = VectorImage<DetectionImage::PixelType>::create(mask);
-  m_convolution.convolve(conv_mask);
+  auto context = acquireContext(clip_w, clip_h);
+  m_convolution.convolveBatch({conv_masked, conv_mask}, context);
+  releaseContext(clip_w, clip_h, std::move(context));
 
   // Copy out the value of the convolved image, divided by the negative mask, applying
   // again the mask to the convolved result
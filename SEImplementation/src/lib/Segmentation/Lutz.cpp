@@ -77,6 +77,9 @@ void Lutz::labelImage(LutzListener& listener, const DetectionImage& image, Pixel
     LutzStatus cs = LutzStatus::NONOBJECT;
 
     if (y % chunk_height == 0) {
+      // Each row of tiles is visited once: with the streaming enabled, it is not kept in the cache
+      TileManager::Sweep sweep;
+      chunk.reset();
       chunk = image.getChunk(0, y, image.getWidth(), std::min(chunk_height, lines - y));
     }
 
@@ -23,6 +23,7 @@
 
 #include "SEFramework/Image/Image.h"
 #include "SEFramework/Image/ProcessedImage.h"
+#include "SEFramework/Image/TileManager.h"
 #include "SEFramework/Source/SourceWithOnDemandProperties.h"
 
 #include "SEImplementation/Measurement/MultithreadedMeasurement.h"
@@ -40,10 +41,18 @@ namespace {
 class LutzLabellingListener : public Lutz::LutzListener {
 public:
   LutzLabellingListener(Segmentation::LabellingListener& listener, std::shared_ptr<SourceFactory> source_factory,
-      int window_size) :
+      int window_size, std::shared_ptr<DetectionImage> image) :
     m_listener(listener),
     m_source_factory(source_factory),
-    m_window_size(window_size) {}
+    m_window_size(window_size),
+    m_image(image),
+    m_tile_manager(TileManager::getInstance()),
+    m_tile_height(m_tile_manager->getTileHeight()) {
+    // Lutz reads the image one row of tiles at a time, starting with the first one
+    for (int i = 1; i <= m_tile_manager->getReadAhead(); ++i) {
+      readAhead(i * m_tile_height);
+    }
+  }
 
   virtual ~LutzLabellingListener() = default;
 
@@ -57,6 +66,11 @@ public:
   void notifyProgress(int line, int total) override {
     m_listener.notifyProgress(line, total);
 
+    // Lutz is about to start a new row of tiles, so hint the one read-ahead rows after
+    if (line % m_tile_height == 0) {
+      readAhead(line + m_tile_manager->getReadAhead() * m_tile_height);
+    }
+
     if (m_window_size > 0 && line > m_window_size) {
       m_listener.requestProcessing(
         ProcessSourcesEvent(std::make_shared<LineSelectionCriteria>(line - m_window_size))
@@ -68,6 +82,16 @@ private:
   Segmentation::LabellingListener& m_listener;
   std::shared_ptr<SourceFactory> m_source_factory;
   int m_window_size;
+  std::shared_ptr<DetectionImage> m_image;
+  std::shared_ptr<TileManager> m_tile_manager;
+  int m_tile_height;
+
+  void readAhead(int line) {
+    // The sweep reads the rows straight from the image, it would not find the prefetched tiles
+    if (line < m_image->getHeight() && !m_tile_manager->isStreaming()) {
+      m_tile_manager->prefetch(m_image, 0, line, m_image->getWidth(), m_tile_height);
+    }
+  }
 };
 
 }
@@ -78,8 +102,9 @@ private:
 
 void LutzSegmentation::labelImage(Segmentation::LabellingListener& listener, std::shared_ptr<const DetectionImageFrame> frame) {
   Lutz lutz;
-  LutzLabellingListener lutz_listener(listener, m_source_factory, m_window_size);
-  lutz.labelImage(lutz_listener, *frame->getThresholdedImage());
+  auto thresholded_image = frame->getThresholdedImage();
+  LutzLabellingListener lutz_listener(listener, m_source_factory, m_window_size, thresholded_image);
+  lutz.labelImage(lutz_listener, *thresholded_image);
 }
 
 } // Segmentation namespace
@@ -130,6 +130,33 @@ BOOST_FIXTURE_TEST_CASE(basic_test, Histogram_Cell_1) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_FIXTURE_TEST_CASE(addData_test, Histogram_Cell_1) {
+  // Longer than a block of addData, and with a weight above the threshold every few values
+  std::vector<PIXTYPE> data, weights;
+  for (int i = 0; i < 5; ++i) {
+    data.insert(data.end(), values.begin(), values.end());
+  }
+  for (size_t i = 0; i < data.size(); ++i) {
+    weights.push_back(i % 7 ? 1. : 10.);
+  }
+
+  BackgroundHistogram single{mean, sigma, data.size()}, block{mean, sigma, data.size()};
+  for (size_t i = 0; i < data.size(); ++i) {
+    if (weights[i] < 5.) {
+      single.addDatum(data[i]);
+    }
+  }
+  block.addData(data.data(), data.size(), weights.data(), 5.);
+
+  PIXTYPE single_back, single_sigma, block_back, block_sigma;
+  single.getBackGuess(single_back, single_sigma);
+  block.getBackGuess(block_back, block_sigma);
+  BOOST_CHECK_EQUAL(single_back, block_back);
+  BOOST_CHECK_EQUAL(single_sigma, block_sigma);
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_FIXTURE_TEST_CASE(histogramImage_test, Histogram_Cell_1) {
   ImageMode<float> histo(VectorImage<float>::create(10, 10, values), nullptr, 10, 10, std::numeric_limits<float>::max());
 
@@ -244,4 +271,29 @@ BOOST_FIXTURE_TEST_CASE(histogramImage_test4, Histogram_Cell_4) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_FIXTURE_TEST_CASE(histogramImageParallel_test, Histogram_Cell_1) {
+  // A grid of cells, each one scaled differently
+  auto image = VectorImage<float>::create(100, 80);
+  auto variance = VectorImage<float>::create(100, 80);
+  for (int y = 0; y < image->getHeight(); ++y) {
+    for (int x = 0; x < image->getWidth(); ++x) {
+      float scale = 1 + 0.1f * (x / 10 + y / 10 * 10);
+      image->setValue(x, y, values[x % 10 + (y % 10) * 10] * scale);
+      variance->setValue(x, y, values[(9 - x % 10) + (y % 10) * 10] / scale);
+    }
+  }
+
+  ImageMode<float> serial(image, variance, 10, 10, std::numeric_limits<float>::max());
+  ImageMode<float> parallel(image, variance, 10, 10, std::numeric_limits<float>::max(), 2, 5, 3, 1e-4, 100,
+                            std::make_shared<Euclid::ThreadPool>(4));
+
+  BOOST_CHECK(serial.getModeImage()->getData() == parallel.getModeImage()->getData());
+  BOOST_CHECK(serial.getSigmaImage()->getData() == parallel.getSigmaImage()->getData());
+  BOOST_CHECK(serial.getVarianceModeImage()->getData() == parallel.getVarianceModeImage()->getData());
+  BOOST_CHECK(serial.getVarianceSigmaImage()->getData() == parallel.getVarianceSigmaImage()->getData());
+  BOOST_CHECK(checkIsClose(14544.8, parallel.getModeImage()->getValue(0, 0)));
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
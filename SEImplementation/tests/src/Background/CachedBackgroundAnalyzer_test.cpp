@@ -0,0 +1,152 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * CachedBackgroundAnalyzer_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <ctime>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "ElementsKernel/Temporary.h"
+
+#include "SEFramework/Image/ConstantImage.h"
+#include "SEFramework/Image/VectorImage.h"
+#include "SEImplementation/Background/CachedBackgroundAnalyzer.h"
+
+using namespace SourceXtractor;
+
+class CountingBackgroundAnalyzer : public BackgroundAnalyzer {
+public:
+  BackgroundModel analyzeBackground(
+      std::shared_ptr<DetectionImage> image, std::shared_ptr<WeightImage>,
+      std::shared_ptr<Image<unsigned char>>, WeightImage::PixelType) const override {
+    ++m_calls;
+    auto level = VectorImage<SeFloat>::create(image->getWidth(), image->getHeight());
+    for (int y = 0; y < image->getHeight(); ++y) {
+      for (int x = 0; x < image->getWidth(); ++x) {
+        level->setValue(x, y, x + 0.5 * y);
+      }
+    }
+    return BackgroundModel(level, ConstantImage<SeFloat>::create(image->getWidth(), image->getHeight(), -4.),
+                           2., 3.);
+  }
+
+  mutable int m_calls = 0;
+};
+
+struct CachedBackgroundAnalyzerFixture {
+  Elements::TempDir temp_dir;
+  std::shared_ptr<CountingBackgroundAnalyzer> counting = std::make_shared<CountingBackgroundAnalyzer>();
+  std::shared_ptr<DetectionImage> image = VectorImage<SeFloat>::create(40, 30);
+
+  BackgroundModel analyze(const std::string& key, WeightImage::PixelType threshold = 1., std::uintmax_t max_size = 0) {
+    CachedBackgroundAnalyzer analyzer(counting, temp_dir.path() / "cache", key, max_size);
+    return analyzer.analyzeBackground(image, nullptr, nullptr, threshold);
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(CachedBackgroundAnalyzer_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(reuse_test, CachedBackgroundAnalyzerFixture) {
+  auto computed = analyze("image");
+  BOOST_CHECK_EQUAL(counting->m_calls, 1);
+
+  auto cached = analyze("image");
+  BOOST_CHECK_EQUAL(counting->m_calls, 1);
+
+  BOOST_CHECK_EQUAL(cached.getScalingFactor(), 2.);
+  BOOST_CHECK_EQUAL(cached.getMedianRms(), 3.);
+  auto level = cached.getLevelMap()->getChunk(0, 0, image->getWidth(), image->getHeight());
+  auto variance = cached.getVarianceMap()->getChunk(0, 0, image->getWidth(), image->getHeight());
+  auto computed_level = computed.getLevelMap()->getChunk(0, 0, image->getWidth(), image->getHeight());
+  for (int y = 0; y < image->getHeight(); ++y) {
+    for (int x = 0; x < image->getWidth(); ++x) {
+      BOOST_CHECK_EQUAL(level->getValue(x, y), x + 0.5 * y);
+      BOOST_CHECK_EQUAL(variance->getValue(x, y), 4.);
+      BOOST_CHECK_EQUAL(computed_level->getValue(x, y), x + 0.5 * y);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(key_test, CachedBackgroundAnalyzerFixture) {
+  analyze("image");
+  analyze("other image");
+  BOOST_CHECK_EQUAL(counting->m_calls, 2);
+  analyze("image", 2.);
+  BOOST_CHECK_EQUAL(counting->m_calls, 3);
+  analyze("other image");
+  BOOST_CHECK_EQUAL(counting->m_calls, 3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(identifyPixels_test, CachedBackgroundAnalyzerFixture) {
+  auto path = (temp_dir.path() / "image.fits").native();
+  std::ofstream(path) << "pixels";
+
+  auto id = CachedBackgroundAnalyzer::identifyPixels(path, 1, 1., "", 0, 1., false);
+  BOOST_CHECK(!id.empty());
+  BOOST_CHECK_EQUAL(id, CachedBackgroundAnalyzer::identifyPixels(path, 1, 1., "", 0, 1., false));
+  BOOST_CHECK_NE(id, CachedBackgroundAnalyzer::identifyPixels(path, 2, 1., "", 0, 1., false));
+  BOOST_CHECK_NE(id, CachedBackgroundAnalyzer::identifyPixels(path, 1, 2., "", 0, 1., false));
+  BOOST_CHECK_NE(id, CachedBackgroundAnalyzer::identifyPixels(path, 1, 1., path, 1, 1., false));
+
+  // Not a plain file, so the pixels can not be told apart
+  BOOST_CHECK(CachedBackgroundAnalyzer::identifyPixels(path + "[1]", 1, 1., "", 0, 1., false).empty());
+  BOOST_CHECK(CachedBackgroundAnalyzer::identifyPixels(path, 1, 1., path + "[1]", 1, 1., false).empty());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_FIXTURE_TEST_CASE(eviction_test, CachedBackgroundAnalyzerFixture) {
+  // A model left by an older run, not used for a while
+  auto cache_dir = temp_dir.path() / "cache";
+  boost::filesystem::create_directories(cache_dir);
+  auto stale = cache_dir / "0000000000000000.fits";
+  std::ofstream(stale.native()) << std::string(4096, 'x');
+  boost::filesystem::last_write_time(stale, std::time(nullptr) - 3600);
+  auto other = cache_dir / "notes.txt";
+  std::ofstream(other.native()) << std::string(4096, 'x');
+
+  // Without a limit nothing is removed
+  analyze("image");
+  BOOST_CHECK(boost::filesystem::exists(stale));
+
+  // The new model alone is over the limit, but it is kept, as well as the files that are not models
+  analyze("other image", 1., 1);
+  BOOST_CHECK_EQUAL(counting->m_calls, 2);
+  BOOST_CHECK(!boost::filesystem::exists(stale));
+  BOOST_CHECK(boost::filesystem::exists(other));
+  analyze("other image", 1., 1);
+  BOOST_CHECK_EQUAL(counting->m_calls, 2);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
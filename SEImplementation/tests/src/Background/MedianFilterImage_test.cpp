@@ -15,6 +15,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+#include <random>
 #include <boost/test/unit_test.hpp>
 #include "SEImplementation/Background/SE/MedianFilter.h"
 #include "SEFramework/Image/VectorImage.h"
@@ -22,6 +24,20 @@
 
 using namespace SourceXtractor;
 
+/// Median of the box around (x, y), clipped as MedianFilter does, by sorting its values
+static SeFloat sortedBoxMedian(const VectorImage<SeFloat>& img, int x, int y, int box_w, int box_h) {
+  int hw = std::min({box_w / 2, x, img.getWidth() - x - 1});
+  int hh = std::min({box_h / 2, y, img.getHeight() - y - 1});
+  std::vector<SeFloat> values;
+  for (int iy = y - hh; iy <= y + hh; ++iy) {
+    for (int ix = x - hw; ix <= x + hw; ++ix) {
+      values.emplace_back(img.getValue(ix, iy));
+    }
+  }
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
 struct MedianFilterImageFixture {
   std::shared_ptr<VectorImage<SeFloat>> image = VectorImage<SeFloat>::create(
     5, 5, std::vector<SeFloat>{
@@ -134,6 +150,52 @@ BOOST_FIXTURE_TEST_CASE(median1x3, MedianFilterImageFixture) {
   BOOST_CHECK(compareImages(expected_var, filtered.second));
 }
 
+//-----------------------------------------------------------------------------
+// The sliding histogram must give the same medians as sorting each box, with repeated values,
+// boxes larger than the image on one axis, and rows filtered concurrently
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(medianSliding) {
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distribution(0, 20);
+  auto image = VectorImage<SeFloat>::create(37, 6);
+  auto variance = VectorImage<SeFloat>::create(37, 6);
+  for (auto& v : image->getData()) {
+    v = distribution(generator) * 0.5f;
+  }
+  for (auto& v : variance->getData()) {
+    v = distribution(generator) * 0.1f;
+  }
+
+  auto serial = MedianFilter<SeFloat>(5, 9)(*image, *variance, 1.f);
+  auto parallel = MedianFilter<SeFloat>(5, 9, std::make_shared<Euclid::ThreadPool>(4))(*image, *variance, 1.f);
+  BOOST_CHECK(serial.first->getData() == parallel.first->getData());
+  BOOST_CHECK(serial.second->getData() == parallel.second->getData());
+
+  for (int y = 0; y < image->getHeight(); ++y) {
+    for (int x = 0; x < image->getWidth(); ++x) {
+      auto median = sortedBoxMedian(*image, x, y, 5, 9);
+      if (std::abs(median - image->getValue(x, y)) >= 1.f) {
+        BOOST_CHECK_EQUAL(serial.first->getValue(x, y), median);
+        BOOST_CHECK_EQUAL(serial.second->getValue(x, y), sortedBoxMedian(*variance, x, y, 5, 9));
+      }
+      else {
+        BOOST_CHECK_EQUAL(serial.first->getValue(x, y), image->getValue(x, y));
+        BOOST_CHECK_EQUAL(serial.second->getValue(x, y), variance->getValue(x, y));
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(selectMedianEven) {
+  std::vector<SeFloat> odd{5, 1, 4, 2, 3};
+  BOOST_CHECK_EQUAL(selectMedian(odd), 3);
+  std::vector<SeFloat> even{6, 1, 5, 2, 4, 3};
+  BOOST_CHECK_EQUAL(selectMedian(even), 3.5);
+}
+
 //-----------------------------------------------------------------------------
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "SEImplementation/Background/SE2/TypedSplineModelWrapper.h"
+
+using namespace SourceXtractor;
+
+//-----------------------------------------------------------------------------
+
+// The grid is owned by the model afterwards
+static PIXTYPE* makeGrid(size_t nx, size_t ny) {
+  PIXTYPE* grid = new PIXTYPE[nx * ny];
+  for (size_t i = 0; i < nx * ny; ++i) {
+    grid[i] = 100 + (i * 7919 % 13) - 0.5 * (i % nx);
+  }
+  return grid;
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(SplineModel_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(splineLinePart_test) {
+  size_t naxes[2] = {300, 200}, cell_size[2] = {32, 50}, ngrid[2] = {10, 4};
+  SplineModel model(naxes, cell_size, ngrid, makeGrid(ngrid[0], ngrid[1]));
+
+  std::vector<PIXTYPE> full(naxes[0]), part(naxes[0]);
+  for (size_t y = 0; y < naxes[1]; y += 13) {
+    model.splineLine(full.data(), y, 0, naxes[0]);
+    // Any range of the row gives the same values as the whole row
+    for (size_t x = 0; x < naxes[0]; x += 37) {
+      size_t width = std::min<size_t>(41, naxes[0] - x);
+      model.splineLine(part.data() + x, y, x, width);
+      for (size_t i = x; i < x + width; ++i) {
+        BOOST_CHECK_EQUAL(part[i], full[i]);
+        BOOST_CHECK_EQUAL(model.getValue(i, y), full[i]);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(constant_test) {
+  size_t naxes[2] = {100, 70}, cell_size[2] = {16, 16}, ngrid[2] = {7, 5};
+  PIXTYPE* grid = new PIXTYPE[ngrid[0] * ngrid[1]];
+  std::fill(grid, grid + ngrid[0] * ngrid[1], 42.);
+  SplineModel model(naxes, cell_size, ngrid, grid);
+
+  std::vector<PIXTYPE> line(naxes[0]);
+  for (size_t y = 0; y < naxes[1]; ++y) {
+    model.splineLine(line.data(), y, 0, naxes[0]);
+    for (auto v : line) {
+      BOOST_CHECK_CLOSE(v, 42., 1e-4);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(imageTile_test) {
+  size_t naxes[2] = {150, 120}, cell_size[2] = {20, 24}, ngrid[2] = {8, 5};
+  auto model = TypedSplineModelWrapper<SeFloat>::create(naxes, cell_size, ngrid, makeGrid(ngrid[0], ngrid[1]));
+
+  auto tile = model->getImageTile(33, 17, 64, 50);
+  for (int y = 17; y < 17 + 50; ++y) {
+    for (int x = 33; x < 33 + 64; ++x) {
+      BOOST_CHECK_EQUAL(tile->getValue<SeFloat>(x, y), model->getValue(x, y));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
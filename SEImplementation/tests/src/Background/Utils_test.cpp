@@ -0,0 +1,93 @@
+/** Copyright © 2019 Université de Genève, LMU Munich - Faculty of Physics, IAP-CNRS/Sorbonne Université
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+/*
+ * Utils_test.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+#include "SEImplementation/Background/Utils.h"
+
+using namespace SourceXtractor;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(Utils_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(runOnThreadPool_test) {
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(2);
+
+  std::atomic<int> next(0), done(0), active(0), max_active(0);
+  runOnThreadPool(thread_pool, 100, [&]() {
+    int a = ++active;
+    int m = max_active;
+    while (a > m && !max_active.compare_exchange_weak(m, a));
+    while (next++ < 100) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      ++done;
+    }
+    --active;
+  });
+
+  BOOST_CHECK_EQUAL(done, 100);
+  // The calling thread, plus one helper per thread of the pool
+  BOOST_CHECK_LE(max_active, 3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(busyThreadPool_test) {
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(1);
+
+  // Keep the only thread of the pool busy until the call below is over
+  std::atomic<bool> release(false);
+  thread_pool->submit([&release]() {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  // The calling thread must do all the work, without waiting for the queued helper
+  std::atomic<int> calls(0);
+  runOnThreadPool(thread_pool, 4, [&calls]() { ++calls; });
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  // Once dequeued, the helper does nothing
+  release = true;
+  thread_pool->block();
+  BOOST_CHECK_EQUAL(calls, 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE(exception_test) {
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(2);
+  BOOST_CHECK_THROW(runOnThreadPool(thread_pool, 4, []() { throw std::runtime_error("failed"); }),
+                    std::runtime_error);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -22,7 +22,9 @@
  */
 
 #include <boost/test/unit_test.hpp>
+#include <fstream>
 
+#include "ElementsKernel/Temporary.h"
 #include "SEImplementation/Image/ImagePsf.h"
 
 using namespace SourceXtractor;
@@ -69,4 +71,105 @@ BOOST_AUTO_TEST_CASE (convolution) {
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_SUITE_END ()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE (convolution_direct) {
+  // A profile where the direct convolution is always faster
+  Elements::TempFile profile_file;
+  {
+    std::ofstream output(profile_file.path().native());
+    output << "# Convolution profile\n" << "cpu " << ConvolutionProfile::getCpuIdentifier() << "\n" << "5 3 0 1\n";
+  }
+  auto profile = ConvolutionProfile::load(profile_file.path().native());
+  BOOST_REQUIRE(profile);
+  ConvolutionProfile::setInstance(profile);
+
+  ImagePsf kernel(1, VectorImage<SeFloat>::create(3, 3, std::vector<SeFloat>{
+    0.0, 0.5, 0.0,
+    0.5, 1.0, 0.5,
+    0.0, 0.5, 0.0
+  }));
+  auto image = VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+    0.5, 0.6, 0.5, 0.4, 0.2,
+    0.7, 0.6, 0.6, 0.1, 0.4,
+    0.3, 0.1, 0.3, 0.2, 1.0,
+    0.5, 0.1, 0.8, 0.5, 1.0,
+    0.2, 0.3, 0.4, 0.4, 0.6
+  });
+
+  auto context = kernel.prepare(image);
+  BOOST_CHECK(!context);
+  kernel.convolve(image, context);
+  ConvolutionProfile::setInstance(std::make_shared<ConvolutionProfile>());
+
+  auto expected = VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+    1.80, 1.70, 1.60, 0.85, 1.00,
+    1.70, 1.60, 1.35, 0.90, 1.10,
+    1.00, 0.75, 1.15, 1.15, 1.90,
+    0.85, 0.95, 1.45, 1.70, 2.30,
+    1.00, 0.70, 1.55, 1.40, 2.00
+  });
+
+  for (auto x = 0; x < expected->getWidth(); ++x) {
+    for (auto y = 0; y < expected->getHeight(); ++y) {
+      BOOST_CHECK_CLOSE(expected->getValue(x, y), image->getValue(x, y), 1e-4);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (convolution_batch) {
+  ImagePsf kernel(1, VectorImage<SeFloat>::create(3, 3, std::vector<SeFloat>{
+    0.0, 0.5, 0.0,
+    0.5, 1.0, 0.5,
+    0.0, 0.5, 0.0
+  }));
+  std::vector<std::shared_ptr<VectorImage<SeFloat>>> images{
+    VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+      0.5, 0.6, 0.5, 0.4, 0.2,
+      0.7, 0.6, 0.6, 0.1, 0.4,
+      0.3, 0.1, 0.3, 0.2, 1.0,
+      0.5, 0.1, 0.8, 0.5, 1.0,
+      0.2, 0.3, 0.4, 0.4, 0.6
+    }),
+    VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+      0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0, 1.0, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0
+    })
+  };
+
+  auto context = kernel.prepare(images.front(), images.size());
+  BOOST_REQUIRE(context);
+  kernel.convolveBatch(images, context);
+
+  std::vector<std::shared_ptr<VectorImage<SeFloat>>> expected{
+    VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+      1.80, 1.70, 1.60, 0.85, 1.00,
+      1.70, 1.60, 1.35, 0.90, 1.10,
+      1.00, 0.75, 1.15, 1.15, 1.90,
+      0.85, 0.95, 1.45, 1.70, 2.30,
+      1.00, 0.70, 1.55, 1.40, 2.00
+    }),
+    VectorImage<SeFloat>::create(5, 5, std::vector<SeFloat>{
+      0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0, 0.5, 0.0, 0.0,
+      0.0, 0.5, 1.0, 0.5, 0.0,
+      0.0, 0.0, 0.5, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0, 0.0
+    })
+  };
+
+  for (size_t i = 0; i < images.size(); ++i) {
+    for (auto x = 0; x < expected[i]->getWidth(); ++x) {
+      for (auto y = 0; y < expected[i]->getHeight(); ++y) {
+        BOOST_CHECK_SMALL(expected[i]->getValue(x, y) - images[i]->getValue(x, y), 1e-5f);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -18,14 +18,66 @@
 #include "SEImplementation/Segmentation/BgDFTConvolutionImageSource.h"
 #include <boost/test/unit_test.hpp>
 #include <boost/mpl/list.hpp>
+#include <atomic>
 #include <random>
 
+#include "SEFramework/Image/BufferedImage.h"
 #include "SEFramework/Image/ImageTile.h"
+#include "SEFramework/Image/TileManager.h"
 
 #include "SEUtils/TestUtils.h"
 
 using namespace SourceXtractor;
 
+/**
+ * Source over an image in memory, counting the tiles read outside of a sweep
+ */
+class SweepCountingImageSource : public ImageSource {
+public:
+  explicit SweepCountingImageSource(std::shared_ptr<VectorImage<SeFloat>> image)
+    : m_image(std::move(image)), m_outside_sweep(0) {}
+
+  std::string getRepr() const override {
+    return "SweepCountingImageSource";
+  }
+
+  void saveTile(ImageTile&) override {
+    assert(false);
+  }
+
+  int getWidth() const override {
+    return m_image->getWidth();
+  }
+
+  int getHeight() const override {
+    return m_image->getHeight();
+  }
+
+  std::shared_ptr<ImageTile> getImageTile(int x, int y, int width, int height) const override {
+    if (!TileManager::getInstance()->isSweeping()) {
+      ++m_outside_sweep;
+    }
+    auto tile = ImageTile::create(ImageTile::FloatImage, x, y, width, height);
+    for (int iy = y; iy < y + height; ++iy) {
+      for (int ix = x; ix < x + width; ++ix) {
+        tile->setValue(ix, iy, m_image->getValue(ix, iy));
+      }
+    }
+    return tile;
+  }
+
+  ImageTile::ImageType getType() const override {
+    return ImageTile::FloatImage;
+  }
+
+  bool isReentrant() const override {
+    return true;
+  }
+
+  std::shared_ptr<VectorImage<SeFloat>> m_image;
+  mutable std::atomic<int> m_outside_sweep;
+};
+
 BOOST_AUTO_TEST_SUITE (BackgroundConvolution_test)
 
 //-----------------------------------------------------------------------------
@@ -173,4 +225,110 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (kerneln_background, T, kernel_sizes) {
 
 //-----------------------------------------------------------------------------
 
+BOOST_AUTO_TEST_CASE (sweep_split_background) {
+  // During a sweep, a region bigger than a tile is convolved by blocks of the size of a tile,
+  // on the thread pool. The result must be the same
+  auto tile_manager = TileManager::getInstance();
+  tile_manager->setOptions(16, 16, 1);
+  tile_manager->setStreaming(true);
+
+  auto image = generateImage(40);
+  auto variance = generateImage(40);
+  auto kernel = generateImage(7);
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(2);
+
+  auto direct_source = std::make_shared<BgConvolutionImageSource>(image, variance, 0.5, kernel);
+  auto dft_source = std::make_shared<BgDFTConvolutionImageSource>(image, variance, 0.5, kernel, thread_pool);
+
+  std::shared_ptr<ImageTile> direct_tile = direct_source->getImageTile(0, 0, 40, 40);
+  auto direct_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(direct_tile)->getImage();
+
+  std::shared_ptr<ImageTile> dft_tile;
+  {
+    TileManager::Sweep sweep;
+    dft_tile = dft_source->getImageTile(0, 0, 40, 40);
+  }
+  auto dft_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(dft_tile)->getImage();
+
+  tile_manager->setStreaming(false);
+  tile_manager->setOptions(256, 256, 100);
+
+  BOOST_CHECK(compareImages(direct_result, dft_result, 1e-8, 1e-4));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (tile_split_background) {
+  // Without streaming, a single tile is split in halves convolved on the thread pool. The result must be the same
+  auto image = generateImage(160);
+  auto variance = generateImage(160);
+  auto kernel = generateImage(9);
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(2);
+
+  auto direct_source = std::make_shared<BgConvolutionImageSource>(image, variance, 0.5, kernel);
+  auto dft_source = std::make_shared<BgDFTConvolutionImageSource>(image, variance, 0.5, kernel, thread_pool);
+
+  std::shared_ptr<ImageTile> direct_tile = direct_source->getImageTile(0, 0, 160, 160);
+  auto direct_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(direct_tile)->getImage();
+
+  std::shared_ptr<ImageTile> dft_tile = dft_source->getImageTile(0, 0, 160, 160);
+  auto dft_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(dft_tile)->getImage();
+
+  BOOST_CHECK(compareImages(direct_result, dft_result, 1e-8, 1e-4));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (sweep_helpers_background) {
+  // The blocks convolved by the thread pool during a sweep must read the image inside the sweep too
+  auto tile_manager = TileManager::getInstance();
+  tile_manager->setOptions(16, 16, 1);
+  tile_manager->setStreaming(true);
+
+  auto source = std::make_shared<SweepCountingImageSource>(generateImage(40));
+  auto image = BufferedImage<SeFloat>::create(source);
+  auto variance = generateImage(40);
+  auto kernel = generateImage(7);
+  auto thread_pool = std::make_shared<Euclid::ThreadPool>(2);
+
+  auto dft_source = std::make_shared<BgDFTConvolutionImageSource>(image, variance, 0.5, kernel, thread_pool);
+  {
+    TileManager::Sweep sweep;
+    dft_source->getImageTile(0, 0, 40, 40);
+  }
+
+  tile_manager->setStreaming(false);
+  tile_manager->setOptions(256, 256, 100);
+
+  BOOST_CHECK_EQUAL(source->m_outside_sweep, 0);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE (separable_background) {
+  // The 1D passes of a separable kernel must match the full kernel, including the masked pixels
+  auto image = generateImage(64);
+  auto variance = generateImage(64);
+  auto kernel = VectorImage<SeFloat>::create(7, 5);
+  std::vector<SeFloat> row{1, 6, 15, 20, 15, 6, 1}, column{1, 4, 6, 4, 1};
+  for (int y = 0; y < 5; ++y) {
+    for (int x = 0; x < 7; ++x) {
+      kernel->setValue(x, y, row[x] * column[y]);
+    }
+  }
+
+  auto direct_source = std::make_shared<BgConvolutionImageSource>(image, variance, 0.5, kernel);
+  auto separable_source = std::make_shared<BgConvolutionImageSource>(image, variance, 0.5, kernel, 1e-4);
+
+  std::shared_ptr<ImageTile> direct_tile = direct_source->getImageTile(1, 0, 50, 61);
+  auto direct_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(direct_tile)->getImage();
+
+  std::shared_ptr<ImageTile> separable_tile = separable_source->getImageTile(1, 0, 50, 61);
+  auto separable_result = std::dynamic_pointer_cast<ImageTileWithType<SeFloat>>(separable_tile)->getImage();
+
+  BOOST_CHECK(compareImages(direct_result, separable_result, 1e-6, 1e-4));
+}
+
+//-----------------------------------------------------------------------------
+
 BOOST_AUTO_TEST_SUITE_END ()
@@ -28,6 +28,8 @@
 #include "SEFramework/Pipeline/Segmentation.h"
 #include "SEUtils/Observable.h"
 #include <atomic>
+#include <chrono>
+#include <list>
 #include <mutex>
 
 namespace SourceXtractor {
@@ -103,6 +105,10 @@ private:
   // being called from multiple threads
   std::mutex m_mutex;
 
+  // Rows for the sources with the most tile cache misses, refreshed periodically
+  std::list<ProgressInfo> m_tile_sources;
+  std::chrono::steady_clock::time_point m_tile_sources_updated;
+
   // This is a set of internal classes that implement the Observer pattern for different stages.
   class ProgressCounter;
   class SourceCounter;
@@ -21,10 +21,48 @@
  *      Author: Alejandro Alvarez Ayllon
  */
 
+#include <climits>
+#include <iomanip>
+#include <sstream>
+#include "SEFramework/Image/TileManager.h"
 #include "SEMain/ProgressMediator.h"
 
 namespace SourceXtractor {
 
+// Sources reported with the progress, those with the most tile cache misses
+static const size_t TILE_WORST_SOURCES = 3;
+// Their representation is cut to its end, where the file name usually is
+static const size_t TILE_LABEL_LENGTH = 32;
+// The statistics per source are gathered under a lock, so they are not refreshed on every notification
+static const std::chrono::seconds TILE_SOURCES_INTERVAL{1};
+
+// Scaled down if needed to fit
+static ProgressInfo tileProgress(const std::string& label, long done, long total) {
+  while (total > INT_MAX) {
+    done /= 2;
+    total /= 2;
+  }
+  return ProgressInfo{label, static_cast<int>(done), static_cast<int>(total)};
+}
+
+static std::list<ProgressInfo> worstTileSources() {
+  std::list<ProgressInfo> info;
+  // Already sorted by decreasing number of misses
+  for (auto& stats : TileManager::getInstance()->getSourceStatistics()) {
+    if (info.size() == TILE_WORST_SOURCES || stats.m_misses == 0) {
+      break;
+    }
+    std::string repr = stats.m_repr;
+    if (repr.size() > TILE_LABEL_LENGTH) {
+      repr = "..." + repr.substr(repr.size() - TILE_LABEL_LENGTH + 3);
+    }
+    std::ostringstream label;
+    label << "Tile misses " << repr << " (" << std::fixed << std::setprecision(1) << stats.m_read_time << " s)";
+    info.emplace_back(tileProgress(label.str(), stats.m_misses, stats.m_hits + stats.m_misses));
+  }
+  return info;
+}
+
 class ProgressMediator::ProgressCounter : public Observer<SegmentationProgress> {
 public:
   ProgressCounter(ProgressMediator& progress_listener, SegmentationProgress& segmentation_progress,
@@ -102,13 +140,28 @@ std::shared_ptr<ProgressMediator::group_observer_t>& ProgressMediator::getMeasur
 }
 
 void ProgressMediator::update(void) {
+  // Reported as the fraction of the tile requests served from memory
+  auto tile_stats = TileManager::getInstance()->getStatistics();
+  long tile_hits = tile_stats.m_memory_hits + tile_stats.m_compressed_hits;
+
   std::lock_guard<std::mutex> guard(m_mutex);
-  this->ProgressObservable::notifyObservers(std::list<ProgressInfo>{
-    {"Segmentation", m_segmentation_progress.position, m_segmentation_progress.total},
-    {"Detected",     m_detected,                       -1},
-    {"Deblended",    m_deblended,                      -1},
-    {"Measured",     m_measured,                       m_deblended},
-  });
+  std::list<ProgressInfo> info{
+    {"Segmentation",    m_segmentation_progress.position,  m_segmentation_progress.total},
+    {"Detected",        m_detected,                        -1},
+    {"Deblended",       m_deblended,                       -1},
+    {"Measured",        m_measured,                        m_deblended},
+    tileProgress("Tile cache hits", tile_hits, tile_hits + tile_stats.m_source_reads),
+  };
+
+  // Followed by the sources missing the cache the most, with the time spent reading their tiles
+  auto now = std::chrono::steady_clock::now();
+  if (now - m_tile_sources_updated >= TILE_SOURCES_INTERVAL) {
+    m_tile_sources = worstTileSources();
+    m_tile_sources_updated = now;
+  }
+  info.insert(info.end(), m_tile_sources.begin(), m_tile_sources.end());
+
+  this->ProgressObservable::notifyObservers(info);
 }
 
 void ProgressMediator::done() {
@@ -42,6 +42,9 @@
 #include "SEFramework/Task/TaskProvider.h"
 #include "SEFramework/Image/ProcessedImage.h"
 #include "SEFramework/Image/BufferedImage.h"
+#include "SEFramework/Image/TileBufferPool.h"
+#include "SEFramework/FITS/FitsHandlePool.h"
+#include "SEFramework/FFT/FFT.h"
 #include "SEFramework/Pipeline/SourceGrouping.h"
 #include "SEFramework/Pipeline/Deblending.h"
 #include "SEFramework/Pipeline/Partition.h"
@@ -57,6 +60,7 @@
 #include "SEImplementation/CheckImages/GroupIdCheckImage.h"
 #include "SEImplementation/CheckImages/MoffatCheckImage.h"
 #include "SEImplementation/Background/BackgroundAnalyzerFactory.h"
+#include "SEImplementation/Background/CachedBackgroundAnalyzer.h"
 #include "SEImplementation/Configuration/MultiThreadingConfig.h"
 #include "SEImplementation/Segmentation/SegmentationFactory.h"
 #include "SEImplementation/Output/OutputFactory.h"
@@ -70,6 +74,8 @@
 #include "SEImplementation/Configuration/SE2BackgroundConfig.h"
 #include "SEImplementation/Configuration/WeightImageConfig.h"
 #include "SEImplementation/Configuration/MemoryConfig.h"
+#include "SEImplementation/Configuration/FFTConfig.h"
+#include "SEImplementation/Configuration/ConvolutionConfig.h"
 #include "SEImplementation/Configuration/OutputConfig.h"
 #include "SEImplementation/Configuration/SamplingConfig.h"
 #include "SEImplementation/CheckImages/CheckImages.h"
@@ -186,6 +192,8 @@ public:
       config_manager.registerConfiguration<BackgroundConfig>();
       config_manager.registerConfiguration<SE2BackgroundConfig>();
       config_manager.registerConfiguration<MemoryConfig>();
+      config_manager.registerConfiguration<FFTConfig>();
+      config_manager.registerConfiguration<ConvolutionConfig>();
       config_manager.registerConfiguration<BackgroundAnalyzerFactory>();
       config_manager.registerConfiguration<SamplingConfig>();
 
@@ -328,7 +336,11 @@ public:
     // Configure TileManager
     auto memory_config = config_manager.getConfiguration<MemoryConfig>();
     TileManager::getInstance()->setOptions(memory_config.getTileSize(),
-        memory_config.getTileSize(), memory_config.getTileMaxMemory());
+        memory_config.getTileSize(), memory_config.getTileMaxMemory(), memory_config.getTileReadAhead(),
+        memory_config.getTileMaxCompressedMemory());
+    TileManager::getInstance()->setStreaming(memory_config.getTileStreaming());
+    TileBufferPool::setHugePages(memory_config.getTileHugePages());
+    FitsHandlePool::getInstance()->setMaxHandles(memory_config.getFitsReadHandles());
 
     CheckImages::getInstance().configure(config_manager);
 
@@ -438,7 +450,12 @@ public:
         detection_image_saturation, interpolation_gap);
     detection_frame->setLabel(boost::filesystem::basename(detection_image_path));
 
-    auto background_analyzer = config_manager.getConfiguration<BackgroundAnalyzerFactory>().createBackgroundAnalyzer();
+    const auto& weight_image_config = config_manager.getConfiguration<WeightImageConfig>();
+    auto background_pixels = CachedBackgroundAnalyzer::identifyPixels(
+        detection_image_path, 0, config_manager.getConfiguration<DetectionImageConfig>().getOriginalFluxScale(),
+        weight_image_config.getWeightImagePath(), 0, weight_image_config.getWeightScaling(), is_weight_absolute);
+    auto background_analyzer = config_manager.getConfiguration<BackgroundAnalyzerFactory>().createBackgroundAnalyzer(
+        weight_image_config.getWeightType(), background_pixels);
     auto background_model = background_analyzer->analyzeBackground(detection_frame->getOriginalImage(), weight_image,
         ConstantImage<unsigned char>::create(detection_image->getWidth(), detection_image->getHeight(), false), detection_frame->getVarianceThreshold());
 
@@ -503,6 +520,12 @@ public:
     CheckImages::getInstance().saveImages();
     TileManager::getInstance()->flush();
 
+    // Keep the plans made during this run for the next ones
+    const auto& wisdom_path = config_manager.getConfiguration<FFTConfig>().getWisdomPath();
+    if (!wisdom_path.empty() && !fftExportWisdom(wisdom_path)) {
+      logger.warn() << "Could not export the FFTW wisdom to " << wisdom_path;
+    }
+
     size_t n_writen_rows = output->flush();
 
     progress_mediator->done();